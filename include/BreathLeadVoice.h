@@ -29,6 +29,10 @@ using u64 = uint64_t;
 struct NoiseGenerator {
     u64 seed = 12345;
 
+    // Pink filter state (per instance; never shared between voices)
+    float b[8] = {};
+    int idx = 0;
+
     float white() noexcept {
         seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
         return float((seed >> 32) & 0xFFFFFF) / 16777216.f * 2.f - 1.f;
@@ -36,9 +40,6 @@ struct NoiseGenerator {
 
     // Pink noise approximation (multiple octaves)
     float pink() noexcept {
-        static float b[8] = {0};
-        static int idx = 0;
-
         const float w = white();
         b[idx] = 0.99886f * b[idx] + w;
         b[idx] = 0.99332f * b[(idx + 3) & 7] + w;
@@ -174,6 +175,7 @@ struct BreathLeadVoice {
     // Internal state
     float vibratoPhase = 0.f;
     float driftPhase = 0.f;
+    float tiltState = 0.f;
     u64 tickCount = 0;
 
     void prepare(double sr) noexcept {
@@ -181,6 +183,7 @@ struct BreathLeadVoice {
         tickCount = 0;
         vibratoPhase = 0.f;
         driftPhase = 0.f;
+        tiltState = 0.f;
         envelope.level = 0.f;
         envelope.target = 0.f;
     }
@@ -225,7 +228,6 @@ struct BreathLeadVoice {
         // 6. Tone shaping (spectral tilt)
         // Dark: low-pass, Bright: more high-end
         // Simple tilt filter using leaky integrator
-        static float tiltState = 0.f;
         const float tiltCoef = 0.95f + tone * 0.049f; // 0.95 to 0.999
         tiltState += (resonated - tiltState) * (1.f - tiltCoef);
         const float tilted = tiltState + resonated * (1.f - tiltCoef);
@@ -0,0 +1,322 @@
+/*
+  AudioBreathFollower.h - Drive air (and optionally pitch) from audio input
+
+  Lets a player "play" the voice by blowing or humming into a microphone.
+
+  - EnvelopeFollower: RMS over 16-sample sub-blocks (SIMD sum of squares),
+    attack/release smoothing in dB, mapped to 0..1 air pressure. Works on
+    the current block, so it adds no latency.
+  - PitchTracker: YIN on a sliding window, with the difference function
+    computed from an FFT autocorrelation (PureDSP::FFT) and prefix energy
+    sums. Runs once per hop; the hop is the follower's fixed look-ahead
+    and is what the plugin reports as latency.
+
+  The tracker's buffers are carved from the owner's DspArena (arenaBytes())
+  in prepare(); only the FFT object (with its own scratch) lives outside
+  it, is freed when the follower is prepared against a released arena, and
+  is reported by getHeapBytes(). process() does not allocate.
+*/
+
+#pragma once
+
+#include "DspArena.h"
+#include "PureDSPFFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64)
+ #include <emmintrin.h>
+ #define BREATH_FOLLOWER_SSE2 1
+#elif defined(__ARM_NEON)
+ #include <arm_neon.h>
+ #define BREATH_FOLLOWER_NEON 1
+#endif
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Sum of squares (vectorised, 4 lanes)
+// -----------------------------------------------------------------------------
+inline float sum_of_squares(const float* x, int n) noexcept {
+    int i = 0;
+    float sum = 0.f;
+
+#if defined(BREATH_FOLLOWER_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(BREATH_FOLLOWER_NEON)
+    float32x4_t acc = vdupq_n_f32(0.f);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(x + i);
+        acc = vmlaq_f32(acc, v, v);
+    }
+    sum = (vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1))
+        + (vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3));
+#endif
+
+    for (; i < n; ++i)
+        sum += x[i] * x[i];
+    return sum;
+}
+
+// -----------------------------------------------------------------------------
+// Envelope follower (input level → air pressure)
+// -----------------------------------------------------------------------------
+struct EnvelopeFollower {
+    static constexpr int kSubBlock = 16;
+
+    float attackCoef = 0.f;
+    float releaseCoef = 0.f;
+    float levelDb = -120.f;
+    float floorDb = -50.f;      // Silence below this
+    float rangeDb = 40.f;       // floor → full pressure
+    float air = 0.f;            // Last sub-block output
+
+    void prepare(double sampleRate) noexcept {
+        const float subRate = float(sampleRate) / kSubBlock;
+        attackCoef = 1.f - std::exp(-1.f / (0.005f * subRate));    // 5 ms
+        releaseCoef = 1.f - std::exp(-1.f / (0.080f * subRate));   // 80 ms
+        levelDb = -120.f;
+        air = 0.f;
+    }
+
+    // sensitivity 0..1 → noise floor -30..-70 dBFS
+    void setSensitivity(float sensitivity) noexcept {
+        floorDb = -30.f - std::clamp(sensitivity, 0.f, 1.f) * 40.f;
+    }
+
+    // Writes a per-sample air signal, interpolated across each sub-block
+    void process(const float* in, float* airOut, int numSamples) noexcept {
+        for (int pos = 0; pos < numSamples; pos += kSubBlock) {
+            const int n = std::min(kSubBlock, numSamples - pos);
+            const float meanSquare = sum_of_squares(in + pos, n) / float(n);
+            const float db = 10.f * std::log10(meanSquare + 1.0e-12f);
+
+            levelDb += (db - levelDb) * (db > levelDb ? attackCoef : releaseCoef);
+
+            const float target = std::clamp((levelDb - floorDb) / rangeDb, 0.f, 1.f);
+            const float step = (target - air) / float(n);
+            for (int i = 0; i < n; ++i) {
+                air += step;
+                airOut[pos + i] = air;
+            }
+            air = target;
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Pitch tracker (YIN with FFT autocorrelation)
+// -----------------------------------------------------------------------------
+class PitchTracker {
+public:
+    using Complex = PureDSP::FFT::Complex;
+
+    static size_t arenaBytes(double sampleRate) noexcept {
+        const size_t window = size_t(windowFor(sampleRate));
+        return DspArena::bytesFor<float>(window)                // ring
+             + 2 * DspArena::bytesFor<float>(window * 2)        // frame, acf
+             + DspArena::bytesFor<Complex>(window + 1)          // spectrum
+             + DspArena::bytesFor<float>(window + 1)            // energy
+             + DspArena::bytesFor<float>(window / 2);           // cmnd
+    }
+
+    // Carves the buffers from the arena (arenaBytes() of it) and builds the
+    // FFT; off the audio thread. Against a released arena the buffers come
+    // back null, the FFT is freed and process() does nothing.
+    void prepare(double sampleRate, DspArena& arena) {
+        sampleRate_ = float(sampleRate);
+
+        // ~21 ms window at any rate (1024 @ 48 kHz); lag range = window / 2
+        window_ = windowFor(sampleRate);
+        hop_ = window_ / 4;
+        maxLag_ = window_ / 2;
+
+        const int fftSize = window_ * 2;
+        ring_ = arena.allocate<float>(size_t(window_));
+        frame_ = arena.allocate<float>(size_t(fftSize));
+        acf_ = arena.allocate<float>(size_t(fftSize));
+        spectrum_ = arena.allocate<Complex>(size_t(window_ + 1));
+        energy_ = arena.allocate<float>(size_t(window_ + 1));
+        cmnd_ = arena.allocate<float>(size_t(maxLag_));
+
+        if (cmnd_ == nullptr) {
+            ring_ = nullptr;
+            fft_.reset();
+        } else if (fft_ == nullptr || fft_->getSize() != fftSize) {
+            fft_ = std::make_unique<PureDSP::FFT>(fftSize);
+        }
+
+        writePos_ = 0;
+        samplesToHop_ = hop_;
+        pitchHz_ = 0.f;
+        confidence_ = 0.f;
+    }
+
+    // Bytes held outside the arena: the FFT and its scratch (its twiddle
+    // tables are shared between instances and not counted)
+    size_t getHeapBytes() const noexcept { return fft_ != nullptr ? fft_->getMemoryFootprint() : 0; }
+
+    void process(const float* in, int numSamples) noexcept {
+        if (ring_ == nullptr)
+            return;
+
+        for (int i = 0; i < numSamples; ++i) {
+            ring_[size_t(writePos_)] = in[i];
+            writePos_ = (writePos_ + 1) & (window_ - 1);
+
+            if (--samplesToHop_ == 0) {
+                samplesToHop_ = hop_;
+                analyse();
+            }
+        }
+    }
+
+    int getLatencySamples() const noexcept { return hop_; }
+    float getPitchHz() const noexcept { return pitchHz_; }
+    float getConfidence() const noexcept { return confidence_; }
+
+private:
+    static int windowFor(double sampleRate) noexcept {
+        int window = 256;
+        while (window < int(sampleRate * 0.021)) window <<= 1;
+        return window;
+    }
+
+    void analyse() noexcept {
+        // Unroll ring (oldest first), zero-pad to 2W for linear correlation
+        for (int i = 0; i < window_; ++i)
+            frame_[size_t(i)] = ring_[size_t((writePos_ + i) & (window_ - 1))];
+        std::fill(frame_ + window_, frame_ + 2 * window_, 0.f);
+
+        // Autocorrelation r(τ) = IFFT(|X|²)
+        fft_->realForward(frame_, spectrum_);
+        for (int k = 0; k <= window_; ++k)
+            spectrum_[k] = std::norm(spectrum_[k]);
+        fft_->realInverse(spectrum_, acf_);
+
+        // Prefix energy e[k] = Σ_{j<k} x_j²
+        energy_[0] = 0.f;
+        for (int i = 0; i < window_; ++i)
+            energy_[size_t(i + 1)] = energy_[size_t(i)] + frame_[size_t(i)] * frame_[size_t(i)];
+
+        if (energy_[size_t(window_)] < 1.0e-6f) {
+            confidence_ = 0.f;
+            return;
+        }
+
+        // YIN difference + cumulative mean normalisation
+        //   d(τ) = Σ_{j<W-τ} x_j² + Σ_{τ≤j<W} x_j² - 2 r(τ)
+        float runningSum = 0.f;
+        cmnd_[0] = 1.f;
+        for (int tau = 1; tau < maxLag_; ++tau) {
+            const float d = energy_[size_t(window_ - tau)]
+                          + (energy_[size_t(window_)] - energy_[size_t(tau)])
+                          - 2.f * acf_[size_t(tau)];
+            runningSum += d;
+            cmnd_[size_t(tau)] = runningSum > 0.f ? d * float(tau) / runningSum : 1.f;
+        }
+
+        // First dip under the threshold, then walk to its local minimum
+        constexpr float kThreshold = 0.15f;
+        const int minLag = std::max(2, int(sampleRate_ / 2000.f));
+        int best = -1;
+        for (int tau = minLag; tau < maxLag_ - 1; ++tau) {
+            if (cmnd_[size_t(tau)] < kThreshold) {
+                while (tau + 1 < maxLag_ - 1 && cmnd_[size_t(tau + 1)] < cmnd_[size_t(tau)])
+                    ++tau;
+                best = tau;
+                break;
+            }
+        }
+
+        if (best < 0) {
+            confidence_ = 0.f;
+            return;
+        }
+
+        // Parabolic interpolation around the minimum
+        const float a = cmnd_[size_t(best - 1)];
+        const float b = cmnd_[size_t(best)];
+        const float c = cmnd_[size_t(best + 1)];
+        const float denom = a - 2.f * b + c;
+        const float shift = std::abs(denom) > 1.0e-9f ? 0.5f * (a - c) / denom : 0.f;
+
+        pitchHz_ = sampleRate_ / (float(best) + std::clamp(shift, -0.5f, 0.5f));
+        confidence_ = 1.f - b;
+    }
+
+    std::unique_ptr<PureDSP::FFT> fft_;
+    float* ring_ = nullptr;         // window_      (arena)
+    float* frame_ = nullptr;        // 2 * window_
+    float* acf_ = nullptr;          // 2 * window_
+    Complex* spectrum_ = nullptr;   // window_ + 1 bins
+    float* energy_ = nullptr;       // window_ + 1
+    float* cmnd_ = nullptr;         // maxLag_
+
+    float sampleRate_ = 48000.f;
+    int window_ = 1024;
+    int hop_ = 256;
+    int maxLag_ = 512;
+    int writePos_ = 0;
+    int samplesToHop_ = 256;
+
+    float pitchHz_ = 0.f;
+    float confidence_ = 0.f;
+};
+
+// -----------------------------------------------------------------------------
+// Audio breath follower (envelope + optional pitch)
+// -----------------------------------------------------------------------------
+class AudioBreathFollower {
+public:
+    static constexpr int kMaxChunk = 64;
+
+    static size_t arenaBytes(double sampleRate) noexcept { return PitchTracker::arenaBytes(sampleRate); }
+
+    // Carves the pitch tracker from the arena (arenaBytes() of it); off the
+    // audio thread
+    void prepare(double sampleRate, DspArena& arena) {
+        envelope_.prepare(sampleRate);
+        pitch_.prepare(sampleRate, arena);
+        freq_ = 0.f;
+    }
+
+    void setSensitivity(float sensitivity) noexcept { envelope_.setSensitivity(sensitivity); }
+
+    // in: mono input; airOut: per-sample air (0..1). numSamples <= kMaxChunk
+    void process(const float* in, float* airOut, int numSamples, bool trackPitch) noexcept {
+        envelope_.process(in, airOut, numSamples);
+
+        if (trackPitch) {
+            pitch_.process(in, numSamples);
+
+            // Only follow confident, audible estimates; glide in log space
+            if (pitch_.getConfidence() > 0.8f && envelope_.air > 0.f) {
+                const float target = std::clamp(pitch_.getPitchHz(), 50.f, 2000.f);
+                freq_ = freq_ > 0.f ? freq_ * std::pow(target / freq_, 0.3f) : target;
+            }
+        }
+    }
+
+    int getLatencySamples() const noexcept { return pitch_.getLatencySamples(); }
+    size_t getHeapBytes() const noexcept { return pitch_.getHeapBytes(); }
+
+    // Last stable pitch estimate (0 until the first confident frame)
+    float getFrequency() const noexcept { return freq_; }
+
+private:
+    EnvelopeFollower envelope_;
+    PitchTracker pitch_;
+    float freq_ = 0.f;
+};
+
+} // namespace breath
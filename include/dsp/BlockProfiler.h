@@ -0,0 +1,190 @@
+/*
+  BlockProfiler.h - Audio-thread block timing and xrun detection
+
+  Measures every processBlock with the CPU cycle counter and relates it to
+  the block deadline (numSamples / sampleRate). Keeps lock-free counters
+  and a histogram of block load that any thread can read while audio runs.
+
+  Compiled in only when BREATHLEAD_PROFILING is non-zero; call sites are
+  wrapped in #if BREATHLEAD_PROFILING so release builds carry no cost.
+
+  Load buckets: 1/16 of the deadline each, last bucket collects >= 2x.
+  A block above 100% of its deadline is counted as an xrun.
+*/
+
+#pragma once
+
+#ifndef BREATHLEAD_PROFILING
+ #define BREATHLEAD_PROFILING 0
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+#endif
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Cycle counter (TSC / virtual counter; steady_clock elsewhere)
+// -----------------------------------------------------------------------------
+inline uint64_t read_cycle_counter() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline int64_t steady_nanos() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// -----------------------------------------------------------------------------
+// Block profiler
+// -----------------------------------------------------------------------------
+class BlockProfiler {
+public:
+    static constexpr int kNumBuckets = 32;
+
+    struct Report {
+        uint64_t blocks = 0;
+        uint64_t xruns = 0;
+        uint64_t events = 0;
+        int maxVoices = 0;
+        float lastLoad = 0.f;       // Fraction of deadline
+        float peakLoad = 0.f;
+        float meanLoad = 0.f;
+        uint64_t histogram[kNumBuckets] = {};
+    };
+
+    // Non-audio thread
+    void prepare(double sampleRate) noexcept {
+        sampleRate_ = sampleRate;
+        calibTicks_ = read_cycle_counter();
+        calibNanos_ = steady_nanos();
+        ticksPerSecond_ = 0.0;
+        reset();
+    }
+
+    void reset() noexcept {
+        blocks_.store(0, std::memory_order_relaxed);
+        xruns_.store(0, std::memory_order_relaxed);
+        events_.store(0, std::memory_order_relaxed);
+        maxVoices_.store(0, std::memory_order_relaxed);
+        lastLoad_.store(0.f, std::memory_order_relaxed);
+        peakLoad_.store(0.f, std::memory_order_relaxed);
+        loadSum_.store(0.0, std::memory_order_relaxed);
+        for (auto& bucket : histogram_)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    // Audio thread
+    uint64_t beginBlock() const noexcept { return read_cycle_counter(); }
+
+    void endBlock(uint64_t startTicks, int numSamples, int numEvents, int activeVoices) noexcept {
+        const uint64_t endTicks = read_cycle_counter();
+        updateCalibration(endTicks);
+
+        if (ticksPerSecond_ <= 0.0 || numSamples <= 0)
+            return;
+
+        const double seconds = double(endTicks - startTicks) / ticksPerSecond_;
+        const double deadline = double(numSamples) / sampleRate_;
+        const float load = float(seconds / deadline);
+
+        int bucket = int(load * 16.f);
+        bucket = bucket < 0 ? 0 : (bucket >= kNumBuckets ? kNumBuckets - 1 : bucket);
+        histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        blocks_.fetch_add(1, std::memory_order_relaxed);
+        events_.fetch_add(uint64_t(numEvents), std::memory_order_relaxed);
+        if (load > 1.f)
+            xruns_.fetch_add(1, std::memory_order_relaxed);
+
+        // Single writer: plain load/store is enough for max/sum
+        if (activeVoices > maxVoices_.load(std::memory_order_relaxed))
+            maxVoices_.store(activeVoices, std::memory_order_relaxed);
+        if (load > peakLoad_.load(std::memory_order_relaxed))
+            peakLoad_.store(load, std::memory_order_relaxed);
+        lastLoad_.store(load, std::memory_order_relaxed);
+        loadSum_.store(loadSum_.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    Report getReport() const noexcept {
+        Report r;
+        r.blocks = blocks_.load(std::memory_order_relaxed);
+        r.xruns = xruns_.load(std::memory_order_relaxed);
+        r.events = events_.load(std::memory_order_relaxed);
+        r.maxVoices = maxVoices_.load(std::memory_order_relaxed);
+        r.lastLoad = lastLoad_.load(std::memory_order_relaxed);
+        r.peakLoad = peakLoad_.load(std::memory_order_relaxed);
+        r.meanLoad = r.blocks > 0 ? float(loadSum_.load(std::memory_order_relaxed) / double(r.blocks)) : 0.f;
+        for (int i = 0; i < kNumBuckets; ++i)
+            r.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+        return r;
+    }
+
+    // Plain-text report; returns characters written (excluding terminator)
+    static int formatReport(const Report& r, char* out, int size) noexcept {
+        int n = std::snprintf(out, size_t(size),
+                              "blocks %llu  xruns %llu  events %llu  max voices %d\n"
+                              "load last %.1f%%  mean %.1f%%  peak %.1f%%\n"
+                              "load histogram (%% of deadline: blocks)\n",
+                              (unsigned long long) r.blocks, (unsigned long long) r.xruns,
+                              (unsigned long long) r.events, r.maxVoices,
+                              r.lastLoad * 100.f, r.meanLoad * 100.f, r.peakLoad * 100.f);
+
+        for (int i = 0; i < kNumBuckets && n > 0 && n < size; ++i) {
+            if (r.histogram[i] == 0)
+                continue;
+            const char* suffix = (i == kNumBuckets - 1) ? "+" : "";
+            n += std::snprintf(out + n, size_t(size - n), "  %5.1f%s: %llu\n",
+                               i * 100.f / 16.f, suffix, (unsigned long long) r.histogram[i]);
+        }
+        return n < size ? n : size - 1;
+    }
+
+private:
+    // Ticks/second from the counter vs steady_clock since prepare()
+    void updateCalibration(uint64_t nowTicks) noexcept {
+        if (++blocksSinceCalib_ < 64 && ticksPerSecond_ > 0.0)
+            return;
+        blocksSinceCalib_ = 0;
+
+        const int64_t elapsedNanos = steady_nanos() - calibNanos_;
+        if (elapsedNanos > 20'000'000) // 20 ms minimum baseline
+            ticksPerSecond_ = double(nowTicks - calibTicks_) * 1.0e9 / double(elapsedNanos);
+    }
+
+    double sampleRate_ = 48000.0;
+    uint64_t calibTicks_ = 0;
+    int64_t calibNanos_ = 0;
+    double ticksPerSecond_ = 0.0;
+    int blocksSinceCalib_ = 0;
+
+    std::atomic<uint64_t> blocks_ { 0 };
+    std::atomic<uint64_t> xruns_ { 0 };
+    std::atomic<uint64_t> events_ { 0 };
+    std::atomic<int> maxVoices_ { 0 };
+    std::atomic<float> lastLoad_ { 0.f };
+    std::atomic<float> peakLoad_ { 0.f };
+    std::atomic<double> loadSum_ { 0.0 };
+    std::atomic<uint64_t> histogram_[kNumBuckets] {};
+};
+
+} // namespace breath
@@ -0,0 +1,230 @@
+/*
+  BreathControllerInput.h - High-resolution breath controller stream
+
+  Accepts 14-bit controller pairs (MSB + LSB):
+    CC2  / CC34  Breath
+    CC11 / CC43  Expression  (setSources(), off by default)
+    CC1  / CC33  Mod wheel   (setSources(), off by default)
+  Enabled sources write one shared stream; the latest message wins. A
+  controller that has sent no LSB is read as 7-bit, so MSB 127 is full
+  pressure.
+  From the sample of its first message the stream owns air pressure until
+  reset() or setSources() changes the selection.
+
+  Messages are queued with their sample offset inside the current block and
+  rendered into a per-sample pressure signal.
+
+  Reconstruction: each new value starts a linear ramp whose length is the
+  measured gap since the previous message (clamped 0.5-5 ms), followed by a
+  light one-pole. Output starts moving on the message's own sample, so the
+  stream is interpolated without look-ahead.
+
+  The queue is fixed-capacity; when full, the newest value overwrites the
+  last queued entry so dense streams degrade to lower time resolution
+  instead of allocating or dropping the latest pressure.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+namespace breath {
+
+class BreathControllerInput {
+public:
+    static constexpr int kQueueSize = 256;
+
+    // Source bits for setSources()
+    enum Source {
+        kBreath     = 1 << 0,   // CC2 / CC34
+        kExpression = 1 << 1,   // CC11 / CC43
+        kModWheel   = 1 << 2    // CC1 / CC33
+    };
+
+    // Which controllers drive the stream; a change releases it
+    void setSources(int sources) noexcept {
+        sources &= kBreath | kExpression | kModWheel;
+        if (sources != sources_) {
+            sources_ = sources;
+            reset();
+        }
+    }
+
+    int getSources() const noexcept { return sources_; }
+
+    // True for the controllers of the enabled sources
+    bool accepts(int cc) const noexcept {
+        const int pair = pairOf(cc);
+        return pair >= 0 && (sources_ & (1 << pair)) != 0;
+    }
+
+    void prepare(double sampleRate) noexcept {
+        minRamp_ = std::max(1, int(sampleRate * 0.0005));
+        maxRamp_ = std::max(minRamp_, int(sampleRate * 0.005));
+        smoothCoef_ = 1.f - std::exp(-1.f / float(sampleRate * 0.001)); // 1 ms
+        reset();
+    }
+
+    void reset() noexcept {
+        count_ = head_ = 0;
+        position_ = 0;
+        current_ = smoothed_ = step_ = 0.f;
+        rampRemaining_ = 0;
+        samplesSinceLast_ = maxRamp_;
+        active_ = false;
+        for (auto& msb : msb_) msb = 0;
+        for (auto& seen : hasLsb_) seen = false;
+    }
+
+    // Start of a host block: event offsets are relative to this point
+    void beginBlock() noexcept {
+        // Anything not consumed last block is applied immediately
+        if (head_ < count_) {
+            startRamp(queue_[count_ - 1].value);
+            active_ = true;
+        }
+        count_ = head_ = 0;
+        position_ = 0;
+    }
+
+    // Offsets must be non-decreasing within a block (MIDI buffer order)
+    // Controllers of disabled sources are ignored
+    void pushController(int sampleOffset, int cc, int value) noexcept {
+        if (!accepts(cc))
+            return;
+
+        const int pair = pairOf(cc);
+        const bool isMsb = cc < 32;
+
+        int raw;
+        if (isMsb) {
+            msb_[pair] = value & 0x7F;
+            if (!hasLsb_[pair]) {
+                push(sampleOffset, float(msb_[pair]) / 127.f);
+                return;
+            }
+            raw = msb_[pair] << 7;      // LSB resets with every new MSB
+        } else {
+            hasLsb_[pair] = true;
+            raw = (msb_[pair] << 7) | (value & 0x7F);
+        }
+
+        push(sampleOffset, float(raw) / 16383.f);
+    }
+
+    // An already normalised 0..1 value for controller `cc` (e.g. a host
+    // event), at full float resolution; same sources and stream
+    void pushPressure(int sampleOffset, int cc, float value) noexcept {
+        if (!accepts(cc))
+            return;
+        push(sampleOffset, value > 0.f ? std::min(value, 1.f) : 0.f);    // NaN → 0
+    }
+
+    // Render pressure for the next numSamples of the block.
+    // Returns false (and writes nothing) until the first message arrives.
+    bool render(float* out, int numSamples) noexcept {
+        if (samplesBeforeActive(numSamples) == numSamples) {
+            position_ += numSamples;
+            return false;
+        }
+        active_ = true;
+
+        for (int i = 0; i < numSamples; ++i) {
+            while (head_ < count_ && queue_[head_].offset <= position_)
+                startRamp(queue_[head_++].value);
+
+            if (rampRemaining_ > 0) {
+                current_ += step_;
+                if (--rampRemaining_ == 0)
+                    current_ = target_;
+            }
+
+            smoothed_ += (current_ - smoothed_) * smoothCoef_;
+            out[i] = smoothed_;
+
+            ++position_;
+            ++samplesSinceLast_;
+        }
+        return true;
+    }
+
+    // How many of the next numSamples come before the stream turns on (0
+    // once it is on). Split render() there, so the stream starts on the
+    // sample of its first message however the block is cut.
+    int samplesBeforeActive(int numSamples) const noexcept {
+        if (active_)
+            return 0;
+        if (head_ == count_)
+            return numSamples;
+        return std::clamp(queue_[head_].offset - position_, 0, numSamples);
+    }
+
+    bool isActive() const noexcept { return active_; }
+    int getPosition() const noexcept { return position_; }
+    float getPressure() const noexcept { return smoothed_; }
+    uint32_t getOverflowCount() const noexcept { return overflowCount_; }
+
+private:
+    struct Event {
+        int offset;
+        float value;
+    };
+
+    // Index into msb_ (and source bit) of a controller, or -1
+    static int pairOf(int cc) noexcept {
+        switch (cc) {
+            case 2:  case 34: return 0;
+            case 11: case 43: return 1;
+            case 1:  case 33: return 2;
+            default: return -1;
+        }
+    }
+
+    void push(int offset, float value) noexcept {
+        // Same timestamp (e.g. MSB then LSB) or full queue: keep the latest
+        if (count_ > head_ && queue_[count_ - 1].offset >= offset) {
+            queue_[count_ - 1].value = value;
+            return;
+        }
+        if (count_ == kQueueSize) {
+            queue_[count_ - 1].value = value;
+            ++overflowCount_;
+            return;
+        }
+
+        queue_[count_++] = { offset, value };
+    }
+
+    void startRamp(float value) noexcept {
+        rampRemaining_ = std::clamp(samplesSinceLast_, minRamp_, maxRamp_);
+        step_ = (value - current_) / float(rampRemaining_);
+        target_ = value;
+        samplesSinceLast_ = 0;
+    }
+
+    Event queue_[kQueueSize];
+    int count_ = 0;
+    int head_ = 0;
+    int position_ = 0;
+
+    int msb_[3] = {};
+    bool hasLsb_[3] = {};       // 14-bit once a pair's LSB has been seen
+
+    float current_ = 0.f;
+    float target_ = 0.f;
+    float step_ = 0.f;
+    float smoothed_ = 0.f;
+    float smoothCoef_ = 0.1f;
+    int rampRemaining_ = 0;
+    int samplesSinceLast_ = 0;
+    int minRamp_ = 24;
+    int maxRamp_ = 240;
+
+    uint32_t overflowCount_ = 0;
+    int sources_ = kBreath;
+    bool active_ = false;
+};
+
+} // namespace breath
@@ -0,0 +1,547 @@
+/*
+  BreathLeadDSP.h - Breath Lead as an embeddable DSP::InstrumentDSP
+
+  Host-free engine (synth + room stage) for embedding without JUCE.
+
+  Threading:
+  - handleEvent(), getParameter() and panic(): any thread, wait-free.
+    Events go through a bounded MPSC queue (EventQueue.h).
+  - setParameter() and loadPreset(): any thread. Each publishes the whole
+    parameter set through a SnapshotMailbox, so process() picks up a
+    preset all at once, never half of it. The mailbox takes one producer
+    at a time: writers take turns on a spin lock held for the 64-byte copy.
+    process() never takes it.
+  - process(): the audio thread. At block start the queue is drained,
+    events are ordered by sampleOffset (ties keep arrival order) and the
+    block is rendered between them, so each lands on its own sample.
+    Breath controllers are timestamped into the synth's breath stream
+    instead of splitting the block, with their float value (no 7-bit
+    step). Offsets past the block carry over.
+  - prepare() / reset() / releaseResources() / setBlockLatency(): not
+    while process() runs.
+
+  Whatever the host block size, the engine renders fixed kProcessBlock
+  sample blocks on its own grid (FixedBlockRenderer.h). By default a host
+  block ending mid-block renders the partial block directly (no latency);
+  setBlockLatency(BlockLatency::Buffered) renders whole blocks only and
+  delays the output by getLatencySamples().
+
+  Every delay line (voices and room) is carved from one aligned DspArena
+  sized in prepare(); getMemoryFootprint() reports the total.
+
+  setVoiceTaskRunner() lets the host's thread pool render voices in
+  parallel (VoiceTaskRunner.h); the output does not change.
+
+  Events that do not fit (queue full, or the carry-over buffer full) are
+  dropped and counted: getDroppedEventCount().
+
+  Presets are JSON in caller-owned buffers (JsonStream.h, no allocation):
+
+    { "schema": "breathlead.preset", "version": 1,
+      "parameters": { "air": 0.5, "tone": 0.6, ... } }
+
+  Members may come in any order and unknown keys are skipped. Missing
+  parameters take their defaults. Documents from a newer schema version
+  are rejected; a failed load changes nothing.
+*/
+
+#pragma once
+
+#include "InstrumentDSP.h"
+#include "EventQueue.h"
+#include "BreathLeadSynth.h"
+#include "FdnAmbience.h"
+#include "FixedBlockRenderer.h"
+#include "JsonStream.h"
+#include "PresetSnapshot.h"
+#include "RealtimeGuard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace breath {
+
+class BreathLeadDSP final : public DSP::InstrumentDSP {
+public:
+    static constexpr int kEventQueueSize = 1024;
+
+    static constexpr const char* kPresetSchema = "breathlead.preset";
+    static constexpr int kPresetVersion = 1;
+
+    struct ParameterInfo {
+        const char* id;
+        float minValue;
+        float maxValue;
+        float defaultValue;
+    };
+
+    enum ParameterIndex {
+        kAir = 0, kTone, kFormant, kResistance, kVibrato,
+        kEngine, kRoom, kRoomSize, kMpe,
+        kAttack, kSwell, kSustain, kRelease,
+        kAttackCurve, kSwellCurve, kReleaseCurve,
+        kNumParameters
+    };
+
+    // Same ids and ranges as the plugin parameters
+    static constexpr ParameterInfo kParameters[kNumParameters] = {
+        { "air",        0.f, 1.f, 0.5f },
+        { "tone",       0.f, 1.f, 0.6f },
+        { "formant",    0.f, 1.f, 0.5f },
+        { "resistance", 0.f, 1.f, 0.4f },
+        { "vibrato",    0.f, 1.f, 0.f  },
+        { "engine",     0.f, 2.f, 0.f  },   // ResonanceEngine index
+        { "room",       0.f, 1.f, 0.f  },
+        { "roomSize",   0.f, 1.f, 0.4f },
+        { "mpe",        0.f, 1.f, 0.f  },   // >= 0.5: MPE on
+        { "attack",       1.f, 1000.f, 90.f  },    // ms
+        { "swell",        0.f, 2000.f, 200.f },    // ms
+        { "sustain",      0.25f, 1.5f, 1.f   },    // x note pressure
+        { "release",      10.f, 3000.f, 360.f },   // ms
+        { "attackCurve",  -1.f, 1.f, 0.6f },
+        { "swellCurve",   -1.f, 1.f, 0.f  },
+        { "releaseCurve", -1.f, 1.f, 0.6f },
+    };
+
+    BreathLeadDSP() {
+        for (int i = 0; i < kNumParameters; ++i) {
+            values_[i].store(kParameters[i].defaultValue, std::memory_order_relaxed);
+            applied_.values[i] = kParameters[i].defaultValue;
+        }
+    }
+
+    static int findParameter(const char* paramId) noexcept {
+        if (paramId == nullptr)
+            return -1;
+        for (int i = 0; i < kNumParameters; ++i)
+            if (std::strcmp(kParameters[i].id, paramId) == 0)
+                return i;
+        return -1;
+    }
+
+    // -------------------------------------------------------------------------
+    // Lifecycle
+    // -------------------------------------------------------------------------
+    bool prepare(double sampleRate, int blockSize) override {
+        if (sampleRate <= 0.0 || blockSize <= 0)
+            return false;
+
+        sampleRate_ = sampleRate;
+        if (!arena_.reserve(BreathLeadSynth::arenaBytes(sampleRate) + FdnAmbience::arenaBytes(sampleRate))) {
+            prepared_ = false;
+            return false;
+        }
+        synth_.prepare(sampleRate, arena_);
+        ambience_.prepare(sampleRate, arena_);
+        blocks_.reset();
+        mpeSwitch_ = false;
+        numPending_ = 0;
+        prepared_ = true;
+        return true;
+    }
+
+    void reset() override {
+        if (!prepared_)
+            return;
+
+        // Rewind and carve the synth again: it lands on the same memory, and
+        // the room (carved after it) keeps its lines
+        arena_.reserve(arena_.capacity());
+        synth_.prepare(sampleRate_, arena_);
+        ambience_.reset();
+        blocks_.reset();
+        mpeSwitch_ = false;
+
+        // Queued and carried events belong to the old timeline
+        events_.drain([](const DSP::ScheduledEvent&) {});
+        numPending_ = 0;
+    }
+
+    void process(float** outputs, int numChannels, int numSamples) override {
+        const ScopedRealtimeSection realtimeSection;
+        if (outputs == nullptr || numChannels <= 0 || numSamples <= 0)
+            return;
+
+        float* outL = outputs[0];
+        float* outR = numChannels > 1 ? outputs[1] : outL;
+
+        if (!prepared_) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::fill(outputs[ch], outputs[ch] + numSamples, 0.f);
+            return;
+        }
+
+        updateParameters();
+        collectEvents();
+
+        // Fixed blocks on the engine's grid; each takes the events due in it
+        int next = 0;
+        blocks_.process(outL, outR, numSamples, [&](int start, float* left, float* right, int n) {
+            next = renderBlock(next, start, left, right, n);
+        });
+
+        // Carry the rest into the next block (Buffered: the events the
+        // engine has not reached yet end up at negative offsets)
+        const int carried = numPending_ - next;
+        for (int i = 0; i < carried; ++i) {
+            pending_[i] = pending_[next + i];
+            pending_[i].sampleOffset -= numSamples;
+        }
+        numPending_ = carried;
+
+        for (int ch = 2; ch < numChannels; ++ch)
+            std::fill(outputs[ch], outputs[ch] + numSamples, 0.f);
+    }
+
+    // -------------------------------------------------------------------------
+    // Events (any thread)
+    // -------------------------------------------------------------------------
+    void handleEvent(const DSP::ScheduledEvent& event) override {
+        events_.push(event);
+    }
+
+    // Not while process() runs; Buffered restarts with one block of silence
+    void setBlockLatency(BlockLatency latency) noexcept { blocks_.setLatency(latency); }
+    BlockLatency getBlockLatency() const noexcept { return blocks_.getLatency(); }
+
+    // Output delay in samples (report it to the host)
+    int getLatencySamples() const noexcept { return blocks_.getLatencySamples(); }
+
+    // Not while process() runs; BreathControllerInput::Source bits
+    // (CC2 only by default)
+    void setBreathSources(int sources) noexcept { synth_.setBreathSources(sources); }
+
+    // Not while process() runs; nullptr renders serially
+    void setVoiceTaskRunner(VoiceTaskRunner* runner) noexcept { synth_.setTaskRunner(runner); }
+
+    void releaseResources() override {
+        // Carve again from the empty arena so no delay line keeps pointing
+        // into the freed block
+        arena_.release();
+        synth_.prepare(sampleRate_, arena_);
+        ambience_.prepare(sampleRate_, arena_);
+        prepared_ = false;
+    }
+
+    size_t getMemoryFootprint() const override { return sizeof(*this) + arena_.capacity(); }
+
+    void panic() override {
+        DSP::ScheduledEvent event;
+        event.type = DSP::ScheduledEvent::AllNotesOff;
+        events_.push(event);
+    }
+
+    // Queue overflow plus carry-over overflow, since construction
+    uint64_t getDroppedEventCount() const noexcept {
+        return events_.getDroppedCount() + carryDropped_.load(std::memory_order_relaxed);
+    }
+
+    // -------------------------------------------------------------------------
+    // Parameters (any thread)
+    // -------------------------------------------------------------------------
+    float getParameter(const char* paramId) const override {
+        const int index = findParameter(paramId);
+        return index >= 0 ? values_[index].load(std::memory_order_relaxed) : 0.f;
+    }
+
+    void setParameter(const char* paramId, float value) override {
+        const int index = findParameter(paramId);
+        if (index < 0 || !std::isfinite(value))
+            return;
+        const auto& info = kParameters[index];
+
+        const PublishLock lock(publishing_);
+        values_[index].store(std::clamp(value, info.minValue, info.maxValue), std::memory_order_relaxed);
+        publishParameters();
+    }
+
+    // -------------------------------------------------------------------------
+    // Presets (any thread; no allocation)
+    // -------------------------------------------------------------------------
+    // False (and an empty string) if the buffer is too small
+    bool savePreset(char* jsonBuffer, int jsonBufferSize) const override {
+        // One consistent set, even while another thread loads a preset
+        ParameterSet set;
+        {
+            const PublishLock lock(publishing_);
+            set = currentParameters();
+        }
+
+        JsonWriter writer(jsonBuffer, jsonBufferSize);
+        writer.beginObject();
+        writer.key("schema");
+        writer.value(kPresetSchema);
+        writer.key("version");
+        writer.value(kPresetVersion);
+
+        writer.key("parameters");
+        writer.beginObject();
+        for (int i = 0; i < kNumParameters; ++i) {
+            writer.key(kParameters[i].id);
+            writer.value(set.values[i]);
+        }
+        writer.endObject();
+        writer.endObject();
+
+        if (!writer.ok()) {
+            if (jsonBuffer != nullptr && jsonBufferSize > 0)
+                jsonBuffer[0] = '\0';
+            return false;
+        }
+        return true;
+    }
+
+    bool loadPreset(const char* jsonData) override {
+        float values[kNumParameters];
+        for (int i = 0; i < kNumParameters; ++i)
+            values[i] = kParameters[i].defaultValue;
+
+        int version = 0;
+        bool hasParameters = false;
+        char key[32];
+
+        JsonReader reader(jsonData);
+        if (!reader.beginObject())
+            return false;
+
+        while (reader.nextKey(key, sizeof(key))) {
+            if (std::strcmp(key, "schema") == 0) {
+                char schema[32];
+                if (!reader.readString(schema, sizeof(schema)) || std::strcmp(schema, kPresetSchema) != 0)
+                    return false;
+            } else if (std::strcmp(key, "version") == 0) {
+                double v = 0.0;
+                if (!reader.readNumber(v) || v != std::floor(v) || v < 1.0 || v > double(kPresetVersion))
+                    return false;
+                version = int(v);
+            } else if (std::strcmp(key, "parameters") == 0) {
+                if (!readPresetParameters(reader, values))
+                    return false;
+                hasParameters = true;
+            } else if (!reader.skipValue()) {
+                return false;
+            }
+        }
+
+        if (reader.failed() || !reader.atEnd() || version == 0 || !hasParameters)
+            return false;
+
+        // Migrations from older schema versions go here (none yet)
+
+        const PublishLock lock(publishing_);
+        for (int i = 0; i < kNumParameters; ++i)
+            values_[i].store(std::clamp(values[i], kParameters[i].minValue, kParameters[i].maxValue),
+                             std::memory_order_relaxed);
+        publishParameters();
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // Voices / metadata
+    // -------------------------------------------------------------------------
+    int getActiveVoiceCount() const override { return synth_.getActiveVoiceCount(); }
+    int getMaxPolyphony() const override { return synth_.getMaxPolyphony(); }
+
+    const char* getInstrumentName() const override { return "Breath Lead"; }
+    const char* getInstrumentVersion() const override { return "1.0.0"; }
+
+private:
+    struct ParameterSet {
+        float values[kNumParameters];
+    };
+
+    // Spin lock over std::atomic_flag for the mailbox's writers
+    class PublishLock {
+    public:
+        explicit PublishLock(std::atomic_flag& flag) noexcept : flag_(flag) {
+            while (flag_.test_and_set(std::memory_order_acquire)) {}
+        }
+        ~PublishLock() { flag_.clear(std::memory_order_release); }
+
+    private:
+        std::atomic_flag& flag_;
+    };
+
+    // Under the publish lock
+    ParameterSet currentParameters() const noexcept {
+        ParameterSet set;
+        for (int i = 0; i < kNumParameters; ++i)
+            set.values[i] = values_[i].load(std::memory_order_relaxed);
+        return set;
+    }
+
+    void publishParameters() noexcept { parameterSets_.publish(currentParameters()); }
+
+    void updateParameters() noexcept {
+        // The newest complete set, if one was published since the last block
+        parameterSets_.consume(applied_);
+        const float* v = applied_.values;
+
+        SynthParameters params;
+        params.air = v[kAir];
+        params.tone = v[kTone];
+        params.formant = v[kFormant];
+        params.resistance = v[kResistance];
+        params.vibrato = v[kVibrato];
+        params.engine = static_cast<ResonanceEngine>(int(std::lround(v[kEngine])));
+        params.envelope.attackMs = v[kAttack];
+        params.envelope.swellMs = v[kSwell];
+        params.envelope.sustain = v[kSustain];
+        params.envelope.releaseMs = v[kRelease];
+        params.envelope.attackCurve = v[kAttackCurve];
+        params.envelope.swellCurve = v[kSwellCurve];
+        params.envelope.releaseCurve = v[kReleaseCurve];
+        synth_.setParameters(params);
+
+        ambience_.setMix(v[kRoom]);
+        ambience_.setSize(v[kRoomSize]);
+
+        // Follow the switch only when it moves (see BreathLeadProcessor)
+        const bool mpe = v[kMpe] >= 0.5f;
+        if (mpe != mpeSwitch_) {
+            mpeSwitch_ = mpe;
+            synth_.setMpeEnabled(mpe);
+        }
+    }
+
+    static bool readPresetParameters(JsonReader& reader, float* values) noexcept {
+        if (!reader.beginObject())
+            return false;
+
+        char key[32];
+        while (reader.nextKey(key, sizeof(key))) {
+            const int index = findParameter(key);
+            if (index < 0) {
+                if (!reader.skipValue())
+                    return false;
+                continue;
+            }
+
+            double v = 0.0;
+            if (!reader.readNumber(v))
+                return false;
+            values[index] = float(std::clamp(v, -1.0e6, 1.0e6));   // Clamped to range on commit
+        }
+        return !reader.failed();
+    }
+
+    bool isBreathEvent(const DSP::ScheduledEvent& event) const noexcept {
+        return event.type == DSP::ScheduledEvent::CC
+            && synth_.getBreathInput().accepts(event.controllerNumber);
+    }
+
+    static int toMidi7(float value) noexcept {
+        return std::clamp(int(std::lround(value * 127.f)), 0, 127);
+    }
+
+    // Drain the queue behind the carried events and sort by offset
+    void collectEvents() noexcept {
+        events_.drain([this](const DSP::ScheduledEvent& event) {
+            if (numPending_ == kEventQueueSize) {
+                carryDropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Insertion sort: arrivals are mostly in order already
+            DSP::ScheduledEvent e = event;
+            e.sampleOffset = std::max(0, e.sampleOffset);
+            int i = numPending_++;
+            while (i > 0 && pending_[i - 1].sampleOffset > e.sampleOffset) {
+                pending_[i] = pending_[i - 1];
+                --i;
+            }
+            pending_[i] = e;
+        });
+    }
+
+    // One piece of a grid block starting at host offset `start`: events
+    // due before its end land on their sample, breath controllers go into
+    // the synth's breath stream. Returns the first event left for later.
+    int renderBlock(int next, int start, float* left, float* right, int n) noexcept {
+        synth_.beginBlock();
+
+        int rendered = 0;
+        for (; next < numPending_ && pending_[next].sampleOffset < start + n; ++next) {
+            const auto& event = pending_[next];
+            const int position = std::max(0, event.sampleOffset - start);
+
+            if (isBreathEvent(event)) {
+                synth_.queueBreathPressure(position, event.controllerNumber, event.value);
+                continue;
+            }
+
+            if (position > rendered) {
+                synth_.render(left + rendered, right + rendered, position - rendered);
+                rendered = position;
+            }
+            applyEvent(event);
+        }
+
+        if (rendered < n)
+            synth_.render(left + rendered, right + rendered, n - rendered);
+
+        ambience_.process(left, right, n);
+        return next;
+    }
+
+    void applyEvent(const DSP::ScheduledEvent& event) noexcept {
+        const uint8_t channel = uint8_t(event.channel & 0x0F);
+        uint8_t midi[3] = {};
+
+        switch (event.type) {
+            case DSP::ScheduledEvent::NoteOn:
+                midi[0] = uint8_t(0x90 | channel);
+                midi[1] = uint8_t(event.noteNumber & 0x7F);
+                midi[2] = uint8_t(std::max(1, toMidi7(event.velocity)));
+                break;
+            case DSP::ScheduledEvent::NoteOff:
+                midi[0] = uint8_t(0x80 | channel);
+                midi[1] = uint8_t(event.noteNumber & 0x7F);
+                break;
+            case DSP::ScheduledEvent::PitchBend: {
+                const int bend = std::clamp(int(std::lround((event.value + 1.f) * 8192.f)), 0, 16383);
+                midi[0] = uint8_t(0xE0 | channel);
+                midi[1] = uint8_t(bend & 0x7F);
+                midi[2] = uint8_t(bend >> 7);
+                break;
+            }
+            case DSP::ScheduledEvent::CC:
+                midi[0] = uint8_t(0xB0 | channel);
+                midi[1] = uint8_t(event.controllerNumber & 0x7F);
+                midi[2] = uint8_t(toMidi7(event.value));
+                break;
+            case DSP::ScheduledEvent::AllNotesOff:
+                synth_.allNotesOff();
+                return;
+        }
+
+        synth_.handleMidi(midi, 3);
+    }
+
+    DspArena arena_;
+    BreathLeadSynth synth_;
+    FdnAmbience ambience_;
+    FixedBlockRenderer<float> blocks_;
+    double sampleRate_ = 48000.0;
+    bool prepared_ = false;
+    bool mpeSwitch_ = false;
+
+    // Parameter values as set (any thread), and as the audio thread last
+    // took them from the mailbox
+    std::atomic<float> values_[kNumParameters];
+    SnapshotMailbox<ParameterSet> parameterSets_;
+    mutable std::atomic_flag publishing_;
+    ParameterSet applied_;
+
+    DSP::EventQueue<DSP::ScheduledEvent, kEventQueueSize> events_;
+
+    // Audio thread: drained events not yet applied, sorted by offset
+    // (relative to the current host block)
+    DSP::ScheduledEvent pending_[kEventQueueSize];
+    int numPending_ = 0;
+    std::atomic<uint64_t> carryDropped_ { 0 };
+};
+
+} // namespace breath
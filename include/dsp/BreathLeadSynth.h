@@ -0,0 +1,756 @@
+/*
+  BreathLeadSynth.h - Preallocated voice pool with MPE routing
+
+  Owns a fixed set of voices (BreathLeadVoice, or BreathLeadVoiceDouble for
+  double-precision hosts and bounces). Without an MPE zone it behaves like
+  the original monophonic instrument: every note lands on voice 0 and
+  pitch bend / pressure are global. With an MPE zone active,
+  each member channel owns a voice, and that channel's pitch bend, channel
+  pressure and CC74 are routed to its voice only.
+
+  Expression never touches the per-sample path: MIDI only moves smoother
+  targets, and the smoothed values are written into each voice's control
+  buffer once per control tick (kControlInterval samples by default;
+  setControlInterval() coarsens it under CPU pressure).
+
+  Breath pressure (CC2/CC11/CC1, 14-bit) is the exception: it is queued with
+  its in-block timestamp and rendered as a per-sample pressure signal that
+  drives the pressure envelope of every held voice. An external pressure
+  (audio input) does the same, and with no note held it plays voice 0 on
+  its own, as the single-voice instrument did.
+
+  Rendering is voice-major, in chunks of up to kRenderChunk samples: the
+  shared controls (breath pressure, master bend, tick positions) are laid
+  out for the chunk first, then each sounding voice renders the whole
+  chunk on its own, and the voices are summed in slot order. With a
+  VoiceTaskRunner (host thread pool) the voices run as parallel tasks;
+  the output is the same bit for bit either way.
+*/
+
+#pragma once
+
+#include "BreathLeadVoice.h"
+#include "BreathControllerInput.h"
+#include "ControlSmoother.h"
+#include "DspCheckpoint.h"
+#include "MpeZone.h"
+#include "RealtimeGuard.h"
+#include "VoiceTaskRunner.h"
+
+namespace breath {
+
+// Bump whenever a change alters the rendered sound (invalidates cached previews)
+constexpr uint32_t kEngineVersion = 3;
+
+constexpr int kMaxVoices = 8;
+constexpr int kMaxControlInterval = kControlInterval * 4;
+
+// Samples per voice-major pass (per-voice buffers are this long)
+constexpr int kRenderChunk = 512;
+static_assert(kRenderChunk >= kMaxControlInterval, "A chunk holds at least one tick");
+
+// Per-voice expression streams
+enum ExpressionStream {
+    kExprBend = 0,      // Semitones
+    kExprPressure,      // 0..1
+    kExprTimbre,        // 0..1 (CC74)
+    kNumExprStreams
+};
+
+// Front-panel parameters shared by all voices
+struct SynthParameters {
+    float air = 0.5f;
+    float tone = 0.6f;
+    float formant = 0.5f;
+    float resistance = 0.4f;
+    float vibrato = 0.f;
+    ResonanceEngine engine = ResonanceEngine::Formant;
+    EnvelopeShape envelope;
+};
+
+// -----------------------------------------------------------------------------
+// Voice slot (voice + its expression streams)
+// -----------------------------------------------------------------------------
+template <typename Voice>
+struct VoiceSlot {
+    Voice voice;
+    ControlSmoother expression[kNumExprStreams];
+    float control[kNumExprStreams] = {};   // Smoothed values for this control tick
+
+    float baseFreq = 440.f;
+    int note = -1;              // -1 once released
+    int channel = -1;
+    bool hasPressure = false;
+    bool hasTimbre = false;
+    u64 startedAt = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Breath Lead Synth (over any BasicBreathLeadVoice; renders in its sample type)
+// -----------------------------------------------------------------------------
+template <typename Voice>
+class BasicBreathLeadSynth {
+public:
+    using Sample = typename Voice::Sample;
+
+    static_assert(Voice::kMaxEnvelopeRun >= kMaxControlInterval, "A run renders its envelope at once");
+
+    BasicBreathLeadSynth() noexcept {
+        for (int i = 0; i < kMaxVoices; ++i)
+            slots_[i].voice.setNoiseSeed(NoiseGenerator::seedFor(i));
+    }
+
+    static size_t arenaBytes(double sr) noexcept { return kMaxVoices * Voice::arenaBytes(sr); }
+
+    // Carves every voice's delay lines from the arena (arenaBytes(sr) of
+    // it); call off the audio thread
+    void prepare(double sr, DspArena& arena) noexcept {
+        sampleRate_ = float(sr);
+        controlInterval_ = pendingInterval_;
+        setSmoothingTimes();
+
+        for (auto& slot : slots_) {
+            slot.voice.prepare(sr, arena);
+            for (auto& stream : slot.expression)
+                stream.reset(0.f);
+            slot.note = -1;
+            slot.channel = -1;
+            slot.hasPressure = false;
+            slot.hasTimbre = false;
+        }
+
+        breath_.prepare(sr);
+
+        masterBend_.reset(0.f);
+
+        for (int ch = 0; ch < 16; ++ch) {
+            channelVoice_[ch] = -1;
+            channelBend_[ch] = 0.f;
+            channelTimbre_[ch] = -1.f;
+        }
+
+        samplesUntilTick_ = 0;
+        numActive_ = 0;
+    }
+
+    // Slow voice stages at ~48 kHz on high-rate hosts; applied at prepare()
+    void setMultirate(bool shouldEnable) noexcept {
+        for (auto& slot : slots_)
+            slot.voice.multirate = shouldEnable;
+    }
+
+    // Samples per control tick (kControlInterval..kMaxControlInterval);
+    // takes effect at the next tick, smoothing times are kept
+    void setControlInterval(int samples) noexcept {
+        pendingInterval_ = std::clamp(samples, kControlInterval, kMaxControlInterval);
+    }
+
+    int getControlInterval() const noexcept { return controlInterval_; }
+
+    // Renders voices as tasks on this runner when two or more are sounding
+    // (nullptr: always serial). Not while render() runs.
+    void setTaskRunner(VoiceTaskRunner* runner) noexcept { runner_ = runner; }
+
+    // Voices new notes may take (1..kMaxVoices). Voices above the limit are
+    // not cut; they finish their note and release tail.
+    void setVoiceLimit(int voices) noexcept { voiceLimit_ = std::clamp(voices, 1, kMaxVoices); }
+    int getVoiceLimit() const noexcept { return voiceLimit_; }
+
+    void setParameters(const SynthParameters& p) noexcept { params_ = p; }
+    const SynthParameters& getParameters() const noexcept { return params_; }
+
+    void setMpeEnabled(bool shouldEnable) noexcept {
+        if (shouldEnable == zone_.enabled)
+            return;
+        allNotesOff();
+        zone_.setEnabled(shouldEnable);
+    }
+
+    bool isMpeEnabled() const noexcept { return zone_.enabled; }
+    const MpeZone& getZone() const noexcept { return zone_; }
+
+    // -------------------------------------------------------------------------
+    // Breath controller stream
+    // -------------------------------------------------------------------------
+    // Call once per host block, before queueing controllers or rendering
+    void beginBlock() noexcept { breath_.beginBlock(); }
+
+    // Queue a breath controller at its offset in the current block. Unlike
+    // handleMidi(), this does not require the caller to split rendering.
+    void queueBreathController(int sampleOffset, int cc, int value) noexcept {
+        breath_.pushController(sampleOffset, cc, value);
+    }
+
+    // Same, for a normalised 0..1 breath value (no 7- or 14-bit step)
+    void queueBreathPressure(int sampleOffset, int cc, float pressure) noexcept {
+        breath_.pushPressure(sampleOffset, cc, pressure);
+    }
+
+    // BreathControllerInput::Source bits; CC2 only by default. A change
+    // releases the stream, and held voices go back to their note pressure.
+    void setBreathSources(int sources) noexcept {
+        const int previous = breath_.getSources();
+        breath_.setSources(sources);
+        if (breath_.getSources() == previous)
+            return;
+        for (auto& slot : slots_)
+            if (slot.note >= 0)
+                slot.voice.endFollow();
+    }
+
+    const BreathControllerInput& getBreathInput() const noexcept { return breath_; }
+
+    // -------------------------------------------------------------------------
+    // Raw MIDI input (1-3 bytes, running status not supported)
+    // -------------------------------------------------------------------------
+    void handleMidi(const uint8_t* data, int numBytes) noexcept {
+        if (numBytes < 1)
+            return;
+
+        const int status = data[0] & 0xF0;
+        const int channel = data[0] & 0x0F;
+        const int d1 = numBytes > 1 ? (data[1] & 0x7F) : 0;
+        const int d2 = numBytes > 2 ? (data[2] & 0x7F) : 0;
+
+        switch (status) {
+            case 0x90:
+                if (d2 > 0) noteOn(channel, d1, d2 / 127.f);
+                else        noteOff(channel, d1);
+                break;
+            case 0x80: noteOff(channel, d1); break;
+            case 0xE0: pitchBend(channel, float((d2 << 7) | d1) / 8192.f - 1.f); break;
+            case 0xD0: channelPressure(channel, d1 / 127.f); break;
+            case 0xA0: polyPressure(channel, d1, d2 / 127.f); break;
+            case 0xB0: controller(channel, d1, d2); break;
+            default: break;
+        }
+    }
+
+    void allNotesOff() noexcept {
+        for (auto& slot : slots_) {
+            slot.voice.noteOff();
+            slot.note = -1;
+        }
+    }
+
+    // Voices play at `hz` instead of their note (audio input pitch), from
+    // the next control tick; 0 goes back to the notes
+    void setPitchOverride(float hz) noexcept { pitchOverride_ = std::max(hz, 0.f); }
+
+    // -------------------------------------------------------------------------
+    // Render (overwrites outL / outR; they may alias for mono output). With
+    // `pressure` (numSamples values, 0..1, e.g. from an AudioBreathFollower)
+    // held voices follow it instead of the breath controller stream, and
+    // with no note held voice 0 plays on it alone.
+    // -------------------------------------------------------------------------
+    void render(Sample* outL, Sample* outR, int numSamples, const float* pressure = nullptr) noexcept {
+        for (int pos = 0; pos < numSamples;) {
+            pressureInput_ = pressure != nullptr ? pressure + pos : nullptr;
+            const int beforeOnset = updateBreathVoice(std::min(numSamples - pos, kRenderChunk));
+            pos += renderChunk(outL + pos, outR + pos, beforeOnset > 0 ? beforeOnset : numSamples - pos);
+        }
+        pressureInput_ = nullptr;
+    }
+
+    int getActiveVoiceCount() const noexcept {
+        int count = 0;
+        for (const auto& slot : slots_)
+            if (slot.voice.isActive()) ++count;
+        return count;
+    }
+
+    int getMaxPolyphony() const noexcept { return zone_.enabled ? kMaxVoices : 1; }
+
+    // Voice `index` (0..kMaxVoices-1), its note, channel and the controls
+    // applied at the last tick; read it between render() calls
+    const VoiceSlot<Voice>& getVoiceSlot(int index) const noexcept { return slots_[index]; }
+
+    // -------------------------------------------------------------------------
+    // Checkpoint (between blocks; restore into a synth prepared at the same
+    // rate, then rendering continues bit-identically)
+    // -------------------------------------------------------------------------
+    void saveState(CheckpointWriter& w) const noexcept {
+        for (const auto& slot : slots_) {
+            w.put(slot.expression); w.put(slot.control);
+            w.put(slot.baseFreq); w.put(slot.note); w.put(slot.channel);
+            w.put(slot.hasPressure); w.put(slot.hasTimbre); w.put(slot.startedAt);
+            slot.voice.saveState(w);
+        }
+
+        w.put(active_); w.put(numActive_);
+        w.put(zone_); w.put(breath_); w.put(params_); w.put(masterBend_);
+        w.put(channelVoice_); w.put(channelBend_); w.put(channelTimbre_);
+        w.put(samplesUntilTick_); w.put(noteCounter_);
+        w.put(controlInterval_); w.put(pendingInterval_); w.put(voiceLimit_);
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        for (auto& slot : slots_) {
+            r.get(slot.expression); r.get(slot.control);
+            r.get(slot.baseFreq); r.get(slot.note); r.get(slot.channel);
+            r.get(slot.hasPressure); r.get(slot.hasTimbre); r.get(slot.startedAt);
+            if (!slot.voice.restoreState(r))
+                return false;
+        }
+
+        r.get(active_); r.get(numActive_);
+        r.get(zone_); r.get(breath_); r.get(params_); r.get(masterBend_);
+        r.get(channelVoice_); r.get(channelBend_); r.get(channelTimbre_);
+        r.get(samplesUntilTick_); r.get(noteCounter_);
+        r.get(controlInterval_); r.get(pendingInterval_); r.get(voiceLimit_);
+
+        if (numActive_ < 0 || numActive_ > kMaxVoices
+            || controlInterval_ < kControlInterval || controlInterval_ > kMaxControlInterval
+            || pendingInterval_ < kControlInterval || pendingInterval_ > kMaxControlInterval
+            || samplesUntilTick_ < 0 || samplesUntilTick_ > controlInterval_
+            || voiceLimit_ < 1 || voiceLimit_ > kMaxVoices)
+            r.fail();
+        return r.ok();
+    }
+
+private:
+    // Run of samples between control ticks (or chunk edges)
+    struct Segment {
+        int start = 0;
+        int length = 0;
+        float masterBend = 0.f;     // Smoothed master bend for this tick
+        bool tick = false;          // Control tick at the start
+        bool retime = false;        // ...which applies a new control interval
+        bool breathing = false;     // pressure_ holds breath for this run
+    };
+
+    static constexpr int kMaxSegments = kRenderChunk / kControlInterval + 3;  // + breath start
+    static constexpr int kMinParallelVoices = 2;
+    static constexpr float kBreathThreshold = 1.0e-4f;  // -80 dB, as PressureEnvelope::isActive()
+
+    static float noteToFreq(int note) noexcept {
+        return 440.f * std::exp2((note - 69) / 12.f);
+    }
+
+    // -------------------------------------------------------------------------
+    // Voice-major rendering
+    // -------------------------------------------------------------------------
+    // Renders up to kRenderChunk of the remaining samples; returns how many
+    int renderChunk(Sample* outL, Sample* outR, int remaining) noexcept {
+        // 1. Shared controls, tick by tick
+        bool retimed = false;
+        const int numSamples = planChunk(remaining, retimed);
+
+        // 2. Every voice in the active list renders the chunk on its own
+        int numTasks = 0;
+        for (auto& listed : listed_)
+            listed = false;
+        for (int a = 0; a < numActive_; ++a) {
+            tasks_[numTasks++] = active_[a];
+            listed_[active_[a]] = true;
+        }
+
+        fpState_ = capture_fp_state();
+        if (numTasks < kMinParallelVoices || runner_ == nullptr
+            || !runner_->run(&renderVoiceTask, this, numTasks)) {
+            for (int t = 0; t < numTasks; ++t)
+                renderVoice(tasks_[t]);
+        }
+
+        // 3. Mix in slot order (deterministic whoever rendered what)
+        std::fill(outL, outL + numSamples, Sample(0));
+        for (int t = 0; t < numTasks; ++t) {
+            const Sample* voiceOut = voiceOut_[tasks_[t]];
+            for (int i = 0; i < numSamples; ++i)
+                outL[i] += voiceOut[i];
+        }
+        if (outR != outL)
+            std::copy(outL, outL + numSamples, outR);    // Voices are mono
+
+        // Idle slots follow an interval change too
+        if (retimed)
+            for (int i = 0; i < kMaxVoices; ++i)
+                if (!isTask(i, numTasks))
+                    setSlotSmoothing(slots_[i]);
+
+        // Active list as of the last tick
+        numActive_ = 0;
+        for (int i = 0; i < kMaxVoices; ++i)
+            if (listed_[i])
+                active_[numActive_++] = i;
+
+        return numSamples;
+    }
+
+    // Lays out the next chunk: runs split at control ticks (never at the
+    // chunk edge, so each run saturates exactly as a tick-by-tick render
+    // would), breath pressure, shared controls. Returns the chunk length.
+    int planChunk(int remaining, bool& retimed) noexcept {
+        numSegments_ = 0;
+
+        int pos = 0;
+        while (pos < remaining) {
+            const int untilTick = samplesUntilTick_ == 0 ? pendingInterval_ : samplesUntilTick_;
+            if (pos + std::min(remaining - pos, untilTick) > kRenderChunk)
+                break;
+
+            auto& segment = segments_[numSegments_++];
+            segment.tick = samplesUntilTick_ == 0;
+            segment.retime = false;
+
+            if (segment.tick) {
+                if (pendingInterval_ != controlInterval_) {
+                    controlInterval_ = pendingInterval_;
+                    masterBend_.setTime(5.f, sampleRate_, controlInterval_);
+                    segment.retime = retimed = true;
+                }
+                masterBend_.tick();
+                samplesUntilTick_ = controlInterval_;
+            }
+
+            segment.start = pos;
+            segment.length = std::min(remaining - pos, samplesUntilTick_);
+
+            // The breath stream starts on its first message's sample
+            const int beforeBreath = breath_.samplesBeforeActive(segment.length);
+            if (beforeBreath > 0)
+                segment.length = beforeBreath;
+
+            segment.masterBend = masterBend_.current;
+            segment.breathing = breath_.render(pressure_ + pos, segment.length);
+            if (pressureInput_ != nullptr) {
+                std::copy(pressureInput_ + pos, pressureInput_ + pos + segment.length, pressure_ + pos);
+                segment.breathing = true;
+            }
+
+            pos += segment.length;
+            samplesUntilTick_ -= segment.length;
+        }
+        return pos;
+    }
+
+    // Breath only: an external pressure with no note held drives voice 0
+    // (at the pitch override, or its last note's pitch). It starts on the
+    // first audible sample, and releases when the pressure goes away.
+    // Returns how many samples to render before that sample (0: none).
+    int updateBreathVoice(int numSamples) noexcept {
+        bool noteHeld = false;
+        for (const auto& slot : slots_)
+            noteHeld = noteHeld || slot.note >= 0;
+        breathOnly_ = pressureInput_ != nullptr && !noteHeld;
+
+        auto& slot = slots_[0];
+        if (!breathOnly_) {
+            if (slot.note < 0 && slot.voice.envelope.stage == PressureEnvelope::Stage::Follow)
+                slot.voice.noteOff();
+            return 0;
+        }
+        if (slot.voice.isActive())
+            return 0;
+
+        const float* onset = std::find_if(pressureInput_, pressureInput_ + numSamples,
+                                          [this](float p) { return p * params_.air > kBreathThreshold; });
+        if (onset != pressureInput_)
+            return onset == pressureInput_ + numSamples ? 0 : int(onset - pressureInput_);
+
+        slot.voice.startFollow(*onset * params_.air);
+        applyControls(slot, masterBend_.current);
+        refreshActiveList();
+        return 0;
+    }
+
+    static void renderVoiceTask(void* context, int index) noexcept {
+        auto& synth = *static_cast<BasicBreathLeadSynth*>(context);
+        const ScopedFpState fpState(synth.fpState_);
+        const ScopedRealtimeSection realtimeSection;
+        synth.renderVoice(synth.tasks_[index]);
+    }
+
+    // One voice through the planned chunk into voiceOut_[v]. Touches only
+    // slot v (and reads shared state), so voices can run concurrently.
+    void renderVoice(int v) noexcept {
+        auto& slot = slots_[v];
+        Sample* out = voiceOut_[v];
+        bool listed = listed_[v];
+
+        for (int s = 0; s < numSegments_; ++s) {
+            const auto& segment = segments_[s];
+            Sample* shaped = out + segment.start;
+
+            if (segment.tick) {
+                // pendingInterval_ only moves between blocks, so the new
+                // interval is the current one
+                if (segment.retime)
+                    setSlotSmoothing(slot);
+                if (slot.voice.isActive()) {
+                    for (int e = 0; e < kNumExprStreams; ++e)
+                        slot.control[e] = slot.expression[e].tick();
+                    applyControls(slot, segment.masterBend);
+                }
+                listed = slot.voice.isActive();
+            }
+
+            if (!listed) {
+                std::fill(shaped, shaped + segment.length, Sample(0));
+                continue;
+            }
+
+            // Envelope for the run (breath pressure drives every held
+            // voice, and voice 0 when breath plays alone), then the output
+            // stages as one run (the dispatched saturation kernel for the
+            // default float voice)
+            const bool held = segment.breathing && (slot.note >= 0 || (breathOnly_ && v == 0));
+            slot.voice.renderEnvelope(segment.length, held ? pressure_ + segment.start : nullptr, params_.air);
+            for (int i = 0; i < segment.length; ++i)
+                shaped[i] = slot.voice.processShaped();
+            slot.voice.processOutput(shaped, segment.length);
+        }
+
+        listed_[v] = listed;
+    }
+
+    bool isTask(int v, int numTasks) const noexcept {
+        for (int t = 0; t < numTasks; ++t)
+            if (tasks_[t] == v)
+                return true;
+        return false;
+    }
+
+    // Same smoothing times whatever the control interval
+    void setSmoothingTimes() noexcept {
+        for (auto& slot : slots_)
+            setSlotSmoothing(slot);
+        masterBend_.setTime(5.f, sampleRate_, controlInterval_);
+    }
+
+    void setSlotSmoothing(VoiceSlot<Voice>& slot) const noexcept {
+        slot.expression[kExprBend].setTime(5.f, sampleRate_, controlInterval_);
+        slot.expression[kExprPressure].setTime(10.f, sampleRate_, controlInterval_);
+        slot.expression[kExprTimbre].setTime(10.f, sampleRate_, controlInterval_);
+    }
+
+    // Voice that owns this channel's expression (or -1)
+    int voiceForChannel(int channel) const noexcept {
+        if (!zone_.enabled)
+            return 0;
+        const int v = channelVoice_[channel];
+        return (v >= 0 && slots_[v].channel == channel) ? v : -1;
+    }
+
+    int allocateVoice() const noexcept {
+        // Free voice first, then the oldest released, then the oldest held
+        int oldestReleased = -1, oldestHeld = 0;
+        for (int i = 0; i < voiceLimit_; ++i) {
+            const auto& slot = slots_[i];
+            if (!slot.voice.isActive())
+                return i;
+            if (slot.note < 0) {
+                if (oldestReleased < 0 || slot.startedAt < slots_[oldestReleased].startedAt)
+                    oldestReleased = i;
+            } else if (slot.startedAt < slots_[oldestHeld].startedAt) {
+                oldestHeld = i;
+            }
+        }
+        return oldestReleased >= 0 ? oldestReleased : oldestHeld;
+    }
+
+    void noteOn(int channel, int note, float velocity) noexcept {
+        // MPE: member-channel notes own their channel's expression; notes on
+        // the master channel are zone-wide (master bend, pressure, timbre)
+        const bool perNote = zone_.enabled && zone_.roleOf(channel) != MpeZone::Role::Master;
+        const int v = zone_.enabled ? allocateVoice() : 0;
+        auto& slot = slots_[v];
+
+        slot.baseFreq = noteToFreq(note);
+        slot.note = note;
+        slot.channel = channel;
+        slot.startedAt = ++noteCounter_;
+
+        if (zone_.enabled) {
+            // Per-note bend / timbre may arrive before the note-on (MPE spec)
+            if (perNote)
+                channelVoice_[channel] = v;
+            slot.expression[kExprBend].reset(perNote ? channelBend_[channel] : 0.f);
+            slot.expression[kExprPressure].reset(0.f);
+            slot.hasPressure = false;
+            slot.hasTimbre = perNote && channelTimbre_[channel] >= 0.f;
+            slot.expression[kExprTimbre].reset(slot.hasTimbre ? channelTimbre_[channel] : 0.f);
+            for (int s = 0; s < kNumExprStreams; ++s)
+                slot.control[s] = slot.expression[s].current;
+        }
+
+        slot.voice.air = params_.air;
+        slot.voice.setEnvelopeShape(params_.envelope);
+        slot.voice.noteOn(pitchOf(slot) * bendRatio(slot, masterBend_.current), velocity);
+        applyControls(slot, masterBend_.current);
+        refreshActiveList();
+    }
+
+    void noteOff(int channel, int note) noexcept {
+        if (!zone_.enabled) {
+            // Monophonic: any note-off releases (original behaviour)
+            slots_[0].voice.noteOff();
+            slots_[0].note = -1;
+            return;
+        }
+
+        for (auto& slot : slots_) {
+            if (slot.channel == channel && slot.note == note) {
+                slot.voice.noteOff();
+                slot.note = -1;
+            }
+        }
+    }
+
+    void pitchBend(int channel, float bend) noexcept {
+        if (!zone_.enabled || zone_.roleOf(channel) == MpeZone::Role::Master) {
+            masterBend_.setTarget(bend * zone_.masterBendRange);
+            return;
+        }
+
+        const float semitones = bend * zone_.memberBendRange;
+        channelBend_[channel] = semitones;
+        const int v = voiceForChannel(channel);
+        if (v >= 0)
+            slots_[v].expression[kExprBend].setTarget(semitones);
+    }
+
+    void channelPressure(int channel, float pressure) noexcept {
+        if (zone_.enabled && zone_.roleOf(channel) == MpeZone::Role::Master) {
+            for (auto& slot : slots_)
+                setPressure(slot, pressure);
+            return;
+        }
+
+        const int v = voiceForChannel(channel);
+        if (v >= 0)
+            setPressure(slots_[v], pressure);
+    }
+
+    void polyPressure(int channel, int note, float pressure) noexcept {
+        for (auto& slot : slots_)
+            if (slot.note == note && (!zone_.enabled || slot.channel == channel))
+                setPressure(slot, pressure);
+    }
+
+    void controller(int channel, int cc, int value) noexcept {
+        if (zone_.handleController(channel, cc, value))
+            return;
+
+        if (breath_.accepts(cc)) {
+            // Enabled breath controllers → air pressure, from now
+            breath_.pushController(breath_.getPosition(), cc, value);
+            return;
+        }
+
+        const float v = value / 127.f;
+        switch (cc) {
+            case 74: // Timbre → formant
+                if (zone_.enabled && zone_.roleOf(channel) == MpeZone::Role::Master) {
+                    for (auto& slot : slots_)
+                        setTimbre(slot, v);
+                } else {
+                    channelTimbre_[channel] = v;
+                    const int target = voiceForChannel(channel);
+                    if (target >= 0)
+                        setTimbre(slots_[target], v);
+                }
+                break;
+
+            case 120: // All sound off
+            case 123: // All notes off
+                allNotesOff();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    static void setPressure(VoiceSlot<Voice>& slot, float pressure) noexcept {
+        if (!slot.hasPressure) {
+            slot.expression[kExprPressure].reset(pressure);
+            slot.hasPressure = true;
+        }
+        slot.expression[kExprPressure].setTarget(pressure);
+    }
+
+    static void setTimbre(VoiceSlot<Voice>& slot, float timbre) noexcept {
+        if (!slot.hasTimbre) {
+            slot.expression[kExprTimbre].reset(timbre);
+            slot.hasTimbre = true;
+        }
+        slot.expression[kExprTimbre].setTarget(timbre);
+    }
+
+    float pitchOf(const VoiceSlot<Voice>& slot) const noexcept {
+        return pitchOverride_ > 0.f ? pitchOverride_ : slot.baseFreq;
+    }
+
+    static float bendRatio(const VoiceSlot<Voice>& slot, float masterBend) noexcept {
+        return std::exp2((slot.control[kExprBend] + masterBend) / 12.f);
+    }
+
+    // Write smoothed expression + shared parameters into the voice
+    void applyControls(VoiceSlot<Voice>& slot, float masterBend) const noexcept {
+        auto& voice = slot.voice;
+        voice.air = params_.air;
+        voice.vibratoDepth = params_.vibrato;
+        voice.engine = params_.engine;
+        voice.setEnvelopeShape(params_.envelope);
+        voice.freq = pitchOf(slot) * bendRatio(slot, masterBend);
+
+        if (slot.hasPressure) {
+            // Pressure → resistance / brightness
+            const float p = slot.control[kExprPressure];
+            voice.resistance = 0.3f + p * 0.5f; // 0.3 to 0.8
+            voice.tone = 0.3f + p * 0.4f;       // 0.3 to 0.7
+        } else {
+            voice.resistance = params_.resistance;
+            voice.tone = params_.tone;
+        }
+
+        voice.formantParam = slot.hasTimbre ? slot.control[kExprTimbre] : params_.formant;
+    }
+
+    void refreshActiveList() noexcept {
+        numActive_ = 0;
+        for (int i = 0; i < kMaxVoices; ++i)
+            if (slots_[i].voice.isActive())
+                active_[numActive_++] = i;
+    }
+
+    VoiceSlot<Voice> slots_[kMaxVoices];
+    int active_[kMaxVoices] = {};
+    int numActive_ = 0;
+
+    MpeZone zone_;
+    BreathControllerInput breath_;
+    SynthParameters params_;
+    ControlSmoother masterBend_;
+
+    // Last per-channel expression, seeds voices started on that channel
+    int channelVoice_[16] = {};
+    float channelBend_[16] = {};
+    float channelTimbre_[16] = {};
+
+    float sampleRate_ = 48000.f;
+    int controlInterval_ = kControlInterval;
+    int pendingInterval_ = kControlInterval;
+    int voiceLimit_ = kMaxVoices;
+    int samplesUntilTick_ = 0;
+    u64 noteCounter_ = 0;
+    float pitchOverride_ = 0.f;             // Set per block by the host side
+    const float* pressureInput_ = nullptr;  // Current chunk's, in render()
+    bool breathOnly_ = false;               // Current chunk's, in render()
+
+    // Voice-major chunk (transient: rebuilt by every renderChunk())
+    Segment segments_[kMaxSegments];
+    int numSegments_ = 0;
+    alignas(64) float pressure_[kRenderChunk] = {};
+    alignas(64) Sample voiceOut_[kMaxVoices][kRenderChunk] = {};
+    bool listed_[kMaxVoices] = {};      // In the active list (per voice)
+    int tasks_[kMaxVoices] = {};        // Slot per task, ascending
+    FpState fpState_;
+    VoiceTaskRunner* runner_ = nullptr;
+};
+
+using BreathLeadSynth = BasicBreathLeadSynth<BreathLeadVoice>;
+using BreathLeadSynthDouble = BasicBreathLeadSynth<BreathLeadVoiceDouble>;
+
+} // namespace breath
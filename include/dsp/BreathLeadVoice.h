@@ -17,6 +17,14 @@
 #include <algorithm>
 #include <random>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "DspCheckpoint.h"
+#include "WaveguideBore.h"
+#include "PolyphaseResampler.h"
+#include "SimdDispatch.h"
+#include "VoicePipeline.h"
 
 namespace breath {
 
@@ -27,18 +35,43 @@ using u64 = uint64_t;
 // Noise generator (white → pink blend)
 // -----------------------------------------------------------------------------
 struct NoiseGenerator {
-    u64 seed = 12345;
+    static constexpr int kAhead = 32;
+    static constexpr u64 kDefaultSeed = 12345;
+
+    // Start for voice `index` of a synth (voice 0 keeps the default)
+    static constexpr u64 seedFor(int index) noexcept {
+        return kDefaultSeed + u64(index) * 0x9E3779B97F4A7C15ull;
+    }
+
+    u64 seed = kDefaultSeed;
+
+    // Pink filter state (per instance; never shared between voices)
+    float b[8] = {};
+    int idx = 0;
+
+    // White samples generated kAhead at a time by the dispatched kernel
+    // (same sequence as one LCG step per call)
+    float ahead[kAhead] = {};
+    int aheadPos = kAhead;
 
     float white() noexcept {
-        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
-        return float((seed >> 32) & 0xFFFFFF) / 16777216.f * 2.f - 1.f;
+        if (aheadPos == kAhead) {
+            simd::kernels().noiseFill(seed, ahead, kAhead);
+            aheadPos = 0;
+        }
+        return ahead[aheadPos++];
+    }
+
+    // Restart the sequence at `start`, pink filter cleared
+    void reset(u64 start) noexcept {
+        seed = start;
+        std::fill(std::begin(b), std::end(b), 0.f);
+        idx = 0;
+        aheadPos = kAhead;
     }
 
     // Pink noise approximation (multiple octaves)
     float pink() noexcept {
-        static float b[8] = {0};
-        static int idx = 0;
-
         const float w = white();
         b[idx] = 0.99886f * b[idx] + w;
         b[idx] = 0.99332f * b[(idx + 3) & 7] + w;
@@ -62,49 +95,82 @@ struct NoiseGenerator {
 
 // -----------------------------------------------------------------------------
 // Bandpass filter (formant core)
+//
+// Trapezoidal (TPT / zero-delay-feedback) state-variable filter, g =
+// tan(pi f / fs). Stable for any Q and cutoff below Nyquist, so the
+// resonance sounds the same at every sample rate. Coefficients are cached:
+// setFrequency() / setQ() only recompute when the value moves (pitch by more
+// than kPitchTolerance, ~0.2 cent).
 // -----------------------------------------------------------------------------
-struct BandpassFilter {
-    float s1 = 0.f, s2 = 0.f;
-    float f = 0.1f;
-    float q = 0.5f;
-
-    void setFrequency(float freq, float sampleRate) noexcept {
-        // Exponential mapping for musical response
-        f = freq / sampleRate;
-        f = std::clamp(f, 0.001f, 0.4f);
+template <typename T>
+struct BasicBandpassFilter {
+    static constexpr float kPitchTolerance = 1.0e-4f;   // Relative
+
+    T ic1 = 0, ic2 = 0;             // Integrator states
+    float freq = 0.f;               // Cached cutoff (Hz) and rate
+    float rate = 0.f;
+    float q = 0.f;
+    T g = 0, k = 2;                 // tan(pi f / fs), 1 / Q
+    T a1 = 1, a2 = 0, a3 = 0;
+
+    void setFrequency(float f, float sampleRate) noexcept {
+        if (sampleRate == rate && std::abs(f - freq) <= freq * kPitchTolerance)
+            return;
+        freq = f;
+        rate = sampleRate;
+
+        const T normalized = std::clamp(T(f) / T(sampleRate), T(1.0e-4f), T(0.49f));
+        g = std::tan(T(3.14159265358979) * normalized);
+        updateCoefficients();
     }
 
     void setQ(float qVal) noexcept {
-        q = std::clamp(qVal, 0.5f, 10.f);
+        qVal = std::clamp(qVal, 0.5f, 10.f);
+        if (qVal == q)
+            return;
+        q = qVal;
+        k = T(1) / T(q);
+        updateCoefficients();
     }
 
-    float process(float in) noexcept {
-        // State variable filter (bandpass output)
-        s1 += f * (in - s1 - q * s2);
-        s2 += f * s1;
+    void reset() noexcept {
+        ic1 = ic2 = 0;
+    }
 
-        // Dampen to prevent explosion
-        s1 *= 0.999f;
-        s2 *= 0.999f;
+    // Constant skirt gain bandpass (peak gain = Q)
+    T process(T in) noexcept {
+        const T v3 = in - ic2;
+        const T v1 = a1 * ic1 + a2 * v3;
+        const T v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = T(2) * v1 - ic1;
+        ic2 = T(2) * v2 - ic2;
+        return v1;
+    }
 
-        return s2 * q * 2.f; // Bandpass output
+    // Fixed coefficients for the block; in and out may alias
+    void process(const T* in, T* out, int numSamples) noexcept {
+        T s1 = ic1, s2 = ic2;
+        for (int i = 0; i < numSamples; ++i) {
+            const T v3 = in[i] - s2;
+            const T v1 = a1 * s1 + a2 * v3;
+            const T v2 = s2 + a2 * s1 + a3 * v3;
+            s1 = T(2) * v1 - s1;
+            s2 = T(2) * v2 - s2;
+            out[i] = v1;
+        }
+        ic1 = s1;
+        ic2 = s2;
+    }
+
+private:
+    void updateCoefficients() noexcept {
+        a1 = T(1) / (T(1) + g * (g + k));
+        a2 = g * a1;
+        a3 = g * a2;
     }
 };
 
-// -----------------------------------------------------------------------------
-// Soft saturation (tape-like)
-// -----------------------------------------------------------------------------
-inline float soft_saturate(float x) noexcept {
-    // Tanh is good, but this is warmer
-    const float ax = std::abs(x);
-    if (ax < 1.f) {
-        return x;
-    } else if (ax < 2.f) {
-        return std::copysign(1.f + (ax - 1.f) * 0.5f, x);
-    } else {
-        return std::copysign(1.5f, x);
-    }
-}
+using BandpassFilter = BasicBandpassFilter<float>;
 
 // -----------------------------------------------------------------------------
 // Excitation stage
@@ -128,40 +194,478 @@ struct Excitation {
 };
 
 // -----------------------------------------------------------------------------
-// Air envelope (pressure-based, slow attack)
+// Pressure envelope: attack → breath swell → sustain, release
+//
+// Attack rises from the current level to the note pressure, the swell
+// moves on to sustain × note pressure, release falls to silence. Each
+// segment has a fixed length and a curve: -1 slow start, 0 linear, +1 fast
+// start (an RC charge cut at kCurveDepth time constants). Inside a segment
+// the level is an affine geometric series, y = c·y + k, with c and k fixed
+// when the segment starts, so blocks render with a multiply-add per sample.
+// The series runs in double: over a 3 s segment (144000 steps at 48 kHz) a
+// float recurrence drifts by up to a few percent of full scale before the
+// end snaps back. Levels are also clamped to the segment's span, so a
+// segment never overshoots its target. The exponentials live in setShape()
+// and only rerun when the shape or the rate changes.
+//
+// follow() hands the level to a live pressure (breath controller, audio
+// input): it then tracks it through a one-pole with a third of the attack /
+// release lengths as time constants, the response of an RC segment.
 // -----------------------------------------------------------------------------
-struct AirEnvelope {
+struct EnvelopeShape {
+    float attackMs = 90.f;      // To the note pressure
+    float swellMs = 200.f;      // Note pressure → sustain level
+    float sustain = 1.f;        // Held level, relative to the note pressure
+    float releaseMs = 360.f;    // To silence
+    float attackCurve = 0.6f;   // -1 slow start, 0 linear, +1 fast start
+    float swellCurve = 0.f;
+    float releaseCurve = 0.6f;
+
+    bool operator==(const EnvelopeShape&) const = default;
+};
+
+struct PressureEnvelope {
+    enum class Stage : uint8_t { Idle, Attack, Swell, Sustain, Follow, Release };
+
+    static constexpr float kCurveDepth = 5.f;   // Time constants per segment at curve ±1
+
+    // Segment timing at the current rate (cached by setShape())
+    struct SegmentShape {
+        int length = 1;         // Samples
+        double c = 1.0;         // Per-sample ratio
+        double g = 1.0;         // c^length
+    };
+
+    Stage stage = Stage::Idle;
     float level = 0.f;
-    float target = 0.f;
+    float target = 0.f;         // Note pressure, or the followed pressure
+    float notePressure = 0.f;   // From the last note-on
+
+    // Running segment: `remaining` steps of value = c * value + k, then
+    // `end`; levels stay within [lo, hi]
+    double value = 0.0, c = 1.0, k = 0.0;
+    float end = 0.f, lo = 0.f, hi = 0.f;
+    int remaining = 0;
+
+    EnvelopeShape shape;
+    float rate = 0.f;
+    SegmentShape attack, swell, release;
+    float attackFollow = 0.f, releaseFollow = 0.f;
+
+    void prepare(float sampleRate) noexcept {
+        rate = 0.f;
+        setShape(shape, sampleRate);
+        stage = Stage::Idle;
+        level = target = 0.f;
+        remaining = 0;
+    }
+
+    // A running segment keeps its timing; the next one uses the new shape
+    void setShape(const EnvelopeShape& s, float sampleRate) noexcept {
+        if (s == shape && sampleRate == rate)
+            return;
+        shape = s;
+        rate = sampleRate;
+
+        attack = makeSegment(s.attackMs, s.attackCurve);
+        swell = makeSegment(s.swellMs, s.swellCurve);
+        release = makeSegment(s.releaseMs, s.releaseCurve);
+        attackFollow = std::exp(-1.f / (std::max(s.attackMs / 3.f, 0.1f) * 0.001f * rate));
+        releaseFollow = std::exp(-1.f / (std::max(s.releaseMs / 3.f, 0.1f) * 0.001f * rate));
+    }
+
+    void noteOn(float pressure) noexcept {
+        target = notePressure = pressure;
+        startSegment(Stage::Attack, attack, pressure);
+    }
+
+    void noteOff() noexcept {
+        if (stage == Stage::Idle)
+            return;
+        target = 0.f;
+        startSegment(Stage::Release, release, 0.f);
+    }
 
-    // Attack: 10-60ms, Release: 80-200ms
-    void setTarget(float t, float sampleRate, float attackMs = 30.f, float releaseMs = 120.f) noexcept {
-        target = t;
+    // Live pressure takes over from the segments until the next note-on /
+    // note-off
+    void follow(float pressure) noexcept {
+        stage = Stage::Follow;
+        target = pressure;
+    }
+
+    // The live pressure is gone (stream reset): glide back to the note's
+    // sustain level over a swell segment
+    void endFollow() noexcept {
+        if (stage != Stage::Follow)
+            return;
+        target = notePressure;
+        startSegment(Stage::Swell, swell, target * shape.sustain);
+    }
+
+    // Still sounding (segment running, or held level above -80 dB)
+    bool isActive() const noexcept {
+        switch (stage) {
+            case Stage::Idle:    return false;
+            case Stage::Sustain: return target * shape.sustain > 0.f || level > 1.0e-4f;
+            case Stage::Follow:  return target > 0.f || level > 1.0e-4f;
+            default:             return true;
+        }
+    }
 
-        // Calculate time constants
-        const float attackCoef = std::exp(-1.f / (attackMs * 0.001f * sampleRate));
-        const float releaseCoef = std::exp(-1.f / (releaseMs * 0.001f * sampleRate));
+    float tick() noexcept {
+        float y;
+        render(&y, 1);
+        return y;
+    }
 
-        const float coef = (target > level) ? attackCoef : releaseCoef;
+    // Next numSamples levels
+    void render(float* out, int numSamples) noexcept {
+        for (int i = 0; i < numSamples;) {
+            switch (stage) {
+                case Stage::Attack:
+                case Stage::Swell:
+                case Stage::Release: {
+                    const int run = std::min(numSamples - i, remaining);
+                    double y = value;
+                    for (int j = 0; j < run; ++j) {
+                        y = y * c + k;
+                        out[i + j] = std::clamp(float(y), lo, hi);
+                    }
+                    value = y;
+                    level = out[i + run - 1];
+                    i += run;
+                    remaining -= run;
+                    if (remaining == 0) {
+                        finishSegment();
+                        out[i - 1] = level;
+                    }
+                    break;
+                }
+
+                case Stage::Sustain:
+                case Stage::Follow: {
+                    const float goal = stage == Stage::Sustain ? target * shape.sustain : target;
+                    for (; i < numSamples; ++i)
+                        out[i] = step(goal);
+                    break;
+                }
+
+                case Stage::Idle:
+                    std::fill(out + i, out + numSamples, level);
+                    i = numSamples;
+                    break;
+            }
+        }
+    }
 
-        // Smooth follow
-        level += (target - level) * (1.f - coef);
+    // Next numSamples levels following a pressure signal
+    void follow(const float* pressure, float* out, int numSamples) noexcept {
+        stage = Stage::Follow;
+        for (int i = 0; i < numSamples; ++i) {
+            target = pressure[i];
+            out[i] = step(target);
+        }
     }
 
-    float get() const noexcept {
+private:
+    SegmentShape makeSegment(float ms, float curve) const noexcept {
+        SegmentShape segment;
+        segment.length = std::max(1, int(std::lround(ms * 0.001f * rate)));
+
+        const double depth = double(std::clamp(curve, -1.f, 1.f) * kCurveDepth);
+        if (std::abs(depth) > 1.0e-3) {
+            segment.c = std::exp(-depth / double(segment.length));
+            segment.g = std::exp(-depth);
+        }
+        return segment;
+    }
+
+    // From level to `to` in segment.length steps: level = T + (level0 - T) c^n
+    // with T chosen so that n = length lands on `to` (linear when c = 1)
+    void startSegment(Stage next, const SegmentShape& segment, float to) noexcept {
+        stage = next;
+        end = to;
+        lo = std::min(level, to);
+        hi = std::max(level, to);
+        remaining = segment.length;
+        value = level;
+        c = segment.c;
+        if (segment.g == 1.0) {
+            k = (double(to) - value) / double(segment.length);
+        } else {
+            const double asymptote = (double(to) - value * segment.g) / (1.0 - segment.g);
+            k = asymptote * (1.0 - c);
+        }
+    }
+
+    void finishSegment() noexcept {
+        level = end;
+        switch (stage) {
+            case Stage::Attack:  startSegment(Stage::Swell, swell, target * shape.sustain); break;
+            case Stage::Swell:   stage = Stage::Sustain; break;
+            case Stage::Release: stage = Stage::Idle; break;
+            default: break;
+        }
+    }
+
+    // One-pole toward goal (attack or release time constant)
+    float step(float goal) noexcept {
+        const float coef = (goal > level) ? attackFollow : releaseFollow;
+        level += (goal - level) * (1.f - coef);
         return level;
     }
 };
 
+// -----------------------------------------------------------------------------
+// Host-rate voice stages (VoicePipeline.h)
+//
+// The default instrument is Resonator → EnvelopeGain → SpectralTilt →
+// Resistance, then SoftSaturation → TanhLimiter as the output stage.
+// Variants swap or drop stages at compile time (FormantResonator for a
+// voice without delay lines, Enable<false, SpectralTilt>, ...).
+// -----------------------------------------------------------------------------
+
+// 5. Resonator (pitch-defining): formant bandpass or waveguide bore
+//
+// An engine change on a sounding voice crossfades over kFadeMs. Formant ↔
+// bore runs both for the fade, with linear gains. Flute ↔ clarinet share the
+// one bore, so it fades out, switches model at silence and fades back in.
+// A note that starts on a silent voice takes the new engine at once. A bore
+// taken up again after the formant starts from cleared lines.
+//
+// Since the engine can change at any time, every voice carries the bore's
+// lines (WaveguideBore::arenaBytes(): 24 KB at 48 kHz, 96 KB at 192 kHz)
+// even while it plays the formant. The lines are carved once in prepare()
+// and not touched by the formant path. A formant-only instrument uses
+// FormantResonator and carries none.
+template <typename T>
+struct Resonator : StageDefaults {
+    static constexpr float kFadeMs = 20.f;
+
+    BasicBandpassFilter<T> formant;
+    WaveguideBore bore;
+
+    ResonanceEngine current = ResonanceEngine::Formant;    // Engine rendered
+    ResonanceEngine next = ResonanceEngine::Formant;       // Target of a running fade
+    int fadeLength = 960;
+    int fadeRemaining = 0;
+    bool snap = true;                                      // Next change applies at once
+
+    static size_t arenaBytes(double sr) noexcept { return WaveguideBore::arenaBytes(sr); }
+
+    void prepare(double sr, DspArena& arena) noexcept {
+        bore.prepare(sr, arena);
+        formant.reset();
+        fadeLength = std::max(2, int(sr * double(kFadeMs) * 0.001));
+        fadeRemaining = 0;
+        snap = true;
+    }
+
+    // A note starts on a silent voice: nothing to fade from
+    void start() noexcept { snap = true; }
+
+    T process(T excite, VoiceFrame& frame) noexcept {
+        if (fadeRemaining == 0 && frame.engine != current) {
+            if (current == ResonanceEngine::Formant && bore.excited)
+                bore.reset();
+            if (snap) {
+                current = frame.engine;
+            } else {
+                next = frame.engine;
+                fadeRemaining = fadeLength;
+            }
+        }
+        snap = false;
+
+        if (fadeRemaining == 0) {
+            frame.envelopeApplied = current != ResonanceEngine::Formant;
+            return frame.envelopeApplied ? processBore(excite, frame, current) : processFormant(excite, frame);
+        }
+
+        // Old engine's gain, 1 → 0 over the fade
+        --fadeRemaining;
+        const T fade = T(fadeRemaining) / T(fadeLength);
+        const ResonanceEngine from = current;
+        if (fadeRemaining == 0)
+            current = next;
+
+        frame.envelopeApplied = true;
+        if (from != ResonanceEngine::Formant && next != ResonanceEngine::Formant) {
+            // One bore: out, switch at the midpoint, back in
+            const bool second = fadeRemaining < fadeLength / 2;
+            if (second && bore.lastModel != next)
+                bore.reset();
+            const T gain = second ? T(1) - T(2) * fade : T(2) * fade - T(1);
+            return processBore(excite, frame, second ? next : from) * gain;
+        }
+
+        // Formant ↔ bore; the formant takes the envelope here, as the bore does
+        const T formantGain = from == ResonanceEngine::Formant ? fade : T(1) - fade;
+        const ResonanceEngine model = from == ResonanceEngine::Formant ? next : from;
+        return processFormant(excite, frame) * T(frame.env) * formantGain
+             + processBore(excite, frame, model) * (T(1) - formantGain);
+    }
+
+    void saveState(CheckpointWriter& w) const noexcept {
+        w.put(formant);
+        w.put(current); w.put(next); w.put(fadeRemaining); w.put(snap);
+        bore.saveState(w);
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        r.get(formant);
+        r.get(current); r.get(next); r.get(fadeRemaining); r.get(snap);
+        if (fadeRemaining < 0 || fadeRemaining > fadeLength)
+            r.fail();
+        return r.ok() && bore.restoreState(r);
+    }
+
+private:
+    T processFormant(T excite, const VoiceFrame& frame) noexcept {
+        formant.setFrequency(frame.pitch, frame.sampleRate);
+        formant.setQ(1.f + frame.formant * 4.f);    // Q: 1 to 5
+        return formant.process(excite) * T(0.75f);  // Peak gain is Q
+    }
+
+    // Envelope is the blowing pressure; the bore decides the onset
+    T processBore(T excite, const VoiceFrame& frame, ResonanceEngine model) noexcept {
+        bore.setTuning(frame.pitch, frame.formant, model);
+        T resonated = T(bore.process(frame.env, float(excite), model) * 0.5f);
+        resonated += excite * T(frame.env) * T(0.04f);  // Edge noise
+        return resonated;
+    }
+};
+
+// 5'. Formant bandpass only (no bore, no delay memory)
+template <typename T>
+struct FormantResonator : StageDefaults {
+    BasicBandpassFilter<T> formant;
+
+    void prepare(double, DspArena&) noexcept { formant.reset(); }
+
+    T process(T excite, VoiceFrame& frame) noexcept {
+        frame.envelopeApplied = false;
+        formant.setFrequency(frame.pitch, frame.sampleRate);
+        formant.setQ(1.f + frame.formant * 4.f);
+        return formant.process(excite) * T(0.75f);
+    }
+
+    void saveState(CheckpointWriter& w) const noexcept { w.put(formant); }
+    bool restoreState(CheckpointReader& r) noexcept { r.get(formant); return r.ok(); }
+};
+
+// 6. Envelope (unless the resonator already blew it into the bore)
+//
+// Straight after the resonator, so the formant and the bore take the
+// envelope at the same point and an engine crossfade meets no filter state
+// built up at a different level.
+template <typename T>
+struct EnvelopeGain : StageDefaults {
+    T process(T x, VoiceFrame& frame) noexcept {
+        return frame.envelopeApplied ? x : x * T(frame.env);
+    }
+};
+
+// 7. Tone shaping: spectral tilt (leaky integrator, dark ↔ bright)
+//
+// The pole is voiced at 48 kHz and mapped to the running rate, so the
+// corner (and with it the level of a note near it) stays put at 96 and
+// 192 kHz. Recomputed only when the tone or the rate changes.
+template <typename T>
+struct SpectralTilt : StageDefaults {
+    static constexpr float kReferenceRate = 48000.f;
+
+    T state = 0;
+    float cachedTone = -1.f, cachedRate = 0.f;
+    T lowpass = 0, direct = 0;      // 1 - pole at the running rate / at 48 kHz
+
+    void prepare(double, DspArena&) noexcept { state = 0; }
+
+    T process(T x, VoiceFrame& frame) noexcept {
+        if (frame.tone != cachedTone || frame.sampleRate != cachedRate) {
+            cachedTone = frame.tone;
+            cachedRate = frame.sampleRate;
+            const T coef = T(0.95f + frame.tone * 0.049f);  // 0.95 to 0.999 at 48 kHz
+            direct = T(1) - coef;
+            lowpass = frame.sampleRate == kReferenceRate
+                    ? direct : T(1) - std::pow(coef, T(kReferenceRate / frame.sampleRate));
+        }
+        state += (x - state) * lowpass;
+        return state + x * direct;
+    }
+
+    void saveState(CheckpointWriter& w) const noexcept { w.put(state); }
+    bool restoreState(CheckpointReader& r) noexcept { r.get(state); return r.ok(); }
+};
+
+// 8. Resistance: how tight the airflow feels
+template <typename T>
+struct Resistance : StageDefaults {
+    T process(T x, VoiceFrame& frame) noexcept {
+        return x * T(0.5f + frame.resistance * 0.5f);
+    }
+};
+
+// 9. Soft saturation (tape-like, 2x drive)
+template <typename T>
+struct SoftSaturation : StageDefaults {
+    T process(T x, VoiceFrame&) noexcept {
+        x *= T(2);
+        const T ax = std::abs(x);
+        if (ax < T(1))
+            return x;
+        if (ax < T(2))
+            return std::copysign(T(1) + (ax - T(1)) * T(0.5f), x);
+        return std::copysign(T(1.5f), x);
+    }
+};
+
+// 10. Dynamics containment (tanh limiter, -3 dB trim)
+template <typename T>
+struct TanhLimiter : StageDefaults {
+    T process(T x, VoiceFrame&) noexcept {
+        return std::tanh(x) * T(0.7f);
+    }
+};
+
+template <typename T>
+using DefaultShaper = VoicePipeline<T, Resonator, EnvelopeGain, SpectralTilt, Resistance>;
+
+template <typename T>
+using DefaultOutput = VoicePipeline<T, SoftSaturation, TanhLimiter>;
+
 // -----------------------------------------------------------------------------
 // Breath Lead Voice
+//
+// Multirate: at high host rates the slow stages (excitation noise, air
+// envelope, vibrato, drift) run at sampleRate / rateDivider (~48 kHz) and
+// are brought up to host rate by a polyphase interpolator (excitation) or
+// linear interpolation (envelope, pitch). The Shaper and Output stages
+// always run at host rate, in the Shaper's sample type.
+//
+// The envelope is rendered a run at a time: renderEnvelope() fills the
+// slow-rate levels for the next numSamples host samples before they are
+// processed. Without it, each slow tick steps the envelope on its own.
 // -----------------------------------------------------------------------------
-struct BreathLeadVoice {
+template <typename Shaper, typename Output = DefaultOutput<typename Shaper::Sample>>
+struct BasicBreathLeadVoice {
+    using Sample = typename Shaper::Sample;
+    static_assert(std::is_same_v<Sample, typename Output::Sample>, "One sample type per voice");
+
+    static constexpr float kInternalRate = 48000.f;
+    static constexpr int kMaxEnvelopeRun = 128;     // Host samples per renderEnvelope()
+
     Excitation excitation;
-    BandpassFilter formant;
-    AirEnvelope envelope;
+    PressureEnvelope envelope;
+    PolyphaseInterpolator upsampler;
+    Shaper shaper;
+    Output output;
+    VoiceFrame frame;
 
     float sampleRate = 48000.f;
+    bool multirate = true;      // Takes effect at prepare()
+    u64 noiseSeed = NoiseGenerator::kDefaultSeed;
+    int rateDivider = 1;        // Host samples per slow-stage sample
     float freq = 440.f;
 
     // Parameters
@@ -170,83 +674,228 @@ struct BreathLeadVoice {
     float formantParam = 0.5f;  // Vowel / resonance shape
     float resistance = 0.5f;    // How "tight" the airflow feels
     float vibratoDepth = 0.f;   // Vibrato depth
+    ResonanceEngine engine = ResonanceEngine::Formant;
 
     // Internal state
     float vibratoPhase = 0.f;
     float driftPhase = 0.f;
     u64 tickCount = 0;
 
-    void prepare(double sr) noexcept {
+    // Slow-stage outputs for the current run of rateDivider host samples
+    float exciteBuf[PolyphaseInterpolator::kMaxFactor] = {};
+    float envPrev = 0.f, envNow = 0.f;
+    float pitchPrev = 440.f, pitchNow = 440.f;
+    int slowPhase = 0;
+
+    // Envelope levels for the current run (renderEnvelope(); not checkpointed,
+    // a run is always used up by the time state is saved)
+    float envRun[kMaxEnvelopeRun] = {};
+    int envRunPos = 0, envRunLength = 0;
+
+    static size_t arenaBytes(double sr) noexcept { return Shaper::arenaBytes(sr) + Output::arenaBytes(sr); }
+
+    // Carves the stages' delay lines from the arena (arenaBytes(sr) of it)
+    void prepare(double sr, DspArena& arena) noexcept {
         sampleRate = float(sr);
+        shaper.prepare(sr, arena);
+        output.prepare(sr, arena);
+
+        // Noise restarts at this voice's seed with the pink filter cleared,
+        // so a prepared voice renders the same whatever it played before
+        excitation.noise.reset(noiseSeed);
+        excitation.phase = 0.f;
         tickCount = 0;
         vibratoPhase = 0.f;
         driftPhase = 0.f;
-        envelope.level = 0.f;
-        envelope.target = 0.f;
+
+        // 88.2/96 kHz → 2, 176.4/192 kHz → 4
+        rateDivider = 1;
+        if (multirate)
+            while (rateDivider < PolyphaseInterpolator::kMaxFactor
+                   && sampleRate / float(rateDivider * 2) >= kInternalRate * 0.9f)
+                rateDivider *= 2;
+
+        upsampler.prepare(rateDivider);
+        envelope.prepare(sampleRate / float(rateDivider));
+        slowPhase = 0;
+        envPrev = envNow = 0.f;
+        envRunPos = envRunLength = 0;
+        pitchPrev = pitchNow = freq;
     }
 
     void noteOn(float frequency, float velocity) noexcept {
+        if (!envelope.isActive()) {
+            shaper.start();
+            output.start();
+        }
         freq = frequency;
-        // Velocity → initial air pressure
-        envelope.target = velocity * air;
+        // Velocity → note pressure
+        envelope.noteOn(velocity * air);
     }
 
     void noteOff() noexcept {
-        envelope.target = 0.f;
+        envelope.noteOff();
     }
 
-    void process(float& outL, float& outR) noexcept {
-        tickCount++;
+    // Starts the voice (if silent) on a live pressure with no note; the
+    // envelope then follows until noteOn() / noteOff()
+    void startFollow(float pressure) noexcept {
+        if (!envelope.isActive()) {
+            shaper.start();
+            output.start();
+        }
+        envelope.follow(pressure);
+    }
+
+    // Breath stream reset: a held note goes back to its own pressure
+    void endFollow() noexcept {
+        envelope.endFollow();
+    }
+
+    // Still sounding (held, or release running)
+    bool isActive() const noexcept {
+        return envelope.isActive();
+    }
+
+    // Where this voice's noise sequence starts (one per voice of a synth,
+    // so stacked voices don't breathe in unison)
+    void setNoiseSeed(u64 seed) noexcept {
+        noiseSeed = seed;
+        excitation.noise.reset(seed);
+    }
+
+    void setEnvelopeShape(const EnvelopeShape& shape) noexcept {
+        envelope.setShape(shape, sampleRate / float(rateDivider));
+    }
+
+    // Envelope levels for the slow ticks among the next numSamples host
+    // samples (at most kMaxEnvelopeRun), as one block. With `pressure` (one
+    // per host sample, times pressureScale) the envelope follows it, else
+    // its segments run. The caller then processes exactly numSamples.
+    void renderEnvelope(int numSamples, const float* pressure, float pressureScale) noexcept {
+        const int first = slowPhase == 0 ? 0 : rateDivider - slowPhase;
+        numSamples = std::min(numSamples, kMaxEnvelopeRun);
+
+        int count = 0;
+        if (pressure != nullptr) {
+            float targets[kMaxEnvelopeRun];
+            for (int i = first; i < numSamples; i += rateDivider)
+                targets[count++] = pressure[i] * pressureScale;
+            envelope.follow(targets, envRun, count);
+        } else {
+            count = first < numSamples ? (numSamples - first + rateDivider - 1) / rateDivider : 0;
+            envelope.render(envRun, count);
+        }
+
+        envRunPos = 0;
+        envRunLength = count;
+    }
+
+    // -------------------------------------------------------------------------
+    // Checkpoint (complete state; restore needs a voice prepared at the
+    // same sample rate)
+    // -------------------------------------------------------------------------
+    void saveState(CheckpointWriter& w) const noexcept {
+        w.put(excitation); w.put(envelope); w.put(upsampler);
+        w.put(sampleRate); w.put(multirate); w.put(rateDivider);
+        w.put(freq); w.put(air); w.put(tone); w.put(formantParam);
+        w.put(resistance); w.put(vibratoDepth); w.put(engine);
+        w.put(vibratoPhase); w.put(driftPhase); w.put(tickCount);
+        w.put(exciteBuf); w.put(envPrev); w.put(envNow);
+        w.put(pitchPrev); w.put(pitchNow); w.put(slowPhase);
+        shaper.saveState(w);
+        output.saveState(w);
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        float rate = 0.f;
+        r.get(excitation); r.get(envelope); r.get(upsampler);
+        r.get(rate); r.get(multirate); r.get(rateDivider);
+        if (rate != sampleRate)
+            r.fail();
+        r.get(freq); r.get(air); r.get(tone); r.get(formantParam);
+        r.get(resistance); r.get(vibratoDepth); r.get(engine);
+        r.get(vibratoPhase); r.get(driftPhase); r.get(tickCount);
+        r.get(exciteBuf); r.get(envPrev); r.get(envNow);
+        r.get(pitchPrev); r.get(pitchNow); r.get(slowPhase);
+        envRunPos = envRunLength = 0;
+        return r.ok() && shaper.restoreState(r) && output.restoreState(r);
+    }
+
+    // Slow stages, once per rateDivider host samples
+    void tickSlow() noexcept {
+        const float slowRate = sampleRate / float(rateDivider);
 
         // 1. Excitation (noise + tiny sine)
-        const float excite = excitation.process(0.5f, freq, sampleRate);
+        const float excite = excitation.process(0.5f, freq, slowRate);
+        upsampler.process(excite, exciteBuf);
 
-        // 2. Air envelope
-        envelope.setTarget(envelope.target, sampleRate, 30.f, 120.f);
-        const float env = envelope.get();
+        // 2. Pressure envelope
+        envPrev = envNow;
+        envNow = envRunPos < envRunLength ? envRun[envRunPos++] : envelope.tick();
 
         // 3. Slow vibrato (5-6 Hz max)
-        vibratoPhase += 6.f / sampleRate;
+        vibratoPhase += 6.f / slowRate;
         if (vibratoPhase > 1.f) vibratoPhase -= 1.f;
         const float vibrato = std::sin(vibratoPhase * 6.28318f) * vibratoDepth * 0.02f;
 
         // 4. Subtle pitch drift
-        driftPhase += 0.5f / sampleRate;
+        driftPhase += 0.5f / slowRate;
         if (driftPhase > 1.f) driftPhase -= 1.f;
         const float drift = std::sin(driftPhase * 6.28318f) * 0.005f; // ±5 cents
 
-        // 5. Formant filter (pitch-defining)
-        const float pitch = freq * (1.f + vibrato + drift);
-        formant.setFrequency(pitch, sampleRate);
-        formant.setQ(1.f + formantParam * 4.f); // Q: 1 to 5
+        pitchPrev = pitchNow;
+        pitchNow = freq * (1.f + vibrato + drift);
+    }
+
+    void process(Sample& outL, Sample& outR) noexcept {
+        const Sample out = output.process(processShaped(), frame);
 
-        const float resonated = formant.process(excite);
+        // Output (mono for now, could add slight stereo spread)
+        outL = out;
+        outR = out;
+    }
 
-        // 6. Tone shaping (spectral tilt)
-        // Dark: low-pass, Bright: more high-end
-        // Simple tilt filter using leaky integrator
-        static float tiltState = 0.f;
-        const float tiltCoef = 0.95f + tone * 0.049f; // 0.95 to 0.999
-        tiltState += (resonated - tiltState) * (1.f - tiltCoef);
-        const float tilted = tiltState + resonated * (1.f - tiltCoef);
+    // Shaper stages; the synth runs the output stages per block
+    // (processOutput())
+    Sample processShaped() noexcept {
+        tickCount++;
 
-        // 7. Resistance (how tight the airflow feels)
-        // Affects dynamics response
-        const float compressed = tilted * (0.5f + resistance * 0.5f);
+        if (slowPhase == 0)
+            tickSlow();
 
-        // 8. Apply envelope
-        const float shaped = compressed * env;
+        // Host-rate view of the slow stages
+        const float t = float(slowPhase + 1) / float(rateDivider);
+        frame.excite = exciteBuf[slowPhase];
+        frame.env = envPrev + (envNow - envPrev) * t;
+        frame.pitch = pitchPrev + (pitchNow - pitchPrev) * t;
+        slowPhase = slowPhase + 1 == rateDivider ? 0 : slowPhase + 1;
 
-        // 9. Soft saturation (tape-like)
-        const float saturated = soft_saturate(shaped * 2.f);
+        frame.sampleRate = sampleRate;
+        frame.tone = tone;
+        frame.formant = formantParam;
+        frame.resistance = resistance;
+        frame.engine = engine;
 
-        // 10. Dynamics containment (soft limiter at -6 dBFS)
-        const float limited = std::tanh(saturated);
+        return shaper.process(Sample(frame.excite), frame);
+    }
 
-        // Output (mono for now, could add slight stereo spread)
-        outL = limited * 0.7f;
-        outR = limited * 0.7f;
+    // Output stages over a block, in place. The default float chain is the
+    // dispatched SIMD saturation kernel (same stages, same result as
+    // saturate_sample()).
+    void processOutput(Sample* x, int numSamples) noexcept {
+        if constexpr (std::is_same_v<Output, DefaultOutput<float>>) {
+            simd::kernels().saturate(x, numSamples);
+        } else {
+            for (int i = 0; i < numSamples; ++i)
+                x[i] = output.process(x[i], frame);
+        }
     }
 };
 
+using BreathLeadVoice = BasicBreathLeadVoice<DefaultShaper<float>>;
+
+// Double Shaper and Output stages; excitation, envelope and the bore stay float
+using BreathLeadVoiceDouble = BasicBreathLeadVoice<DefaultShaper<double>>;
+
 } // namespace breath
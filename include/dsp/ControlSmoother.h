@@ -0,0 +1,53 @@
+/*
+  ControlSmoother.h - Control-rate parameter smoothing
+
+  Expression and parameter streams are not rendered per sample. Incoming
+  values only move a target; the smoother advances once per control tick
+  (every kControlInterval samples) and the voice reads the smoothed value.
+  Dense controller data therefore costs one store per message and one
+  multiply-add per control tick, independent of message rate.
+*/
+
+#pragma once
+
+#include <cmath>
+
+namespace breath {
+
+// Samples between control-rate updates (0.67 ms at 48 kHz)
+constexpr int kControlInterval = 32;
+
+// -----------------------------------------------------------------------------
+// One-pole smoother ticked at control rate
+// -----------------------------------------------------------------------------
+struct ControlSmoother {
+    float current = 0.f;
+    float target = 0.f;
+    float coef = 0.f;   // Per-tick follow amount (0 = frozen, 1 = jump)
+
+    // timeMs: time to reach ~63% of a step
+    void setTime(float timeMs, float sampleRate, int interval = kControlInterval) noexcept {
+        const float ticks = timeMs * 0.001f * sampleRate / float(interval);
+        coef = ticks > 0.f ? 1.f - std::exp(-1.f / ticks) : 1.f;
+    }
+
+    void reset(float value) noexcept {
+        current = value;
+        target = value;
+    }
+
+    void setTarget(float t) noexcept {
+        target = t;
+    }
+
+    float tick() noexcept {
+        current += (target - current) * coef;
+        return current;
+    }
+
+    bool isSettled() const noexcept {
+        return std::abs(target - current) < 1.0e-5f;
+    }
+};
+
+} // namespace breath
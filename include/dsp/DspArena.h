@@ -0,0 +1,92 @@
+/*
+  DspArena.h - One cache-line aligned block for all engine buffers
+
+  The owner (engine / processor) sums the components' arenaBytes() for the
+  sample rate, reserve()s exactly that, and each component's prepare()
+  carves its buffers out in order. Buffers therefore sit back to back in
+  one allocation, the footprint is known up front, and release() frees
+  everything at once. After release(), prepare the components again
+  against the empty arena: they carve null buffers and drop their pointers
+  into the freed block.
+
+  Every carve starts on a cache line (kAlignment) and comes back zeroed.
+  Only plain data lives here: the arena never runs constructors.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace breath {
+
+class DspArena {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    // Arena bytes taken by `count` Ts (whole cache lines)
+    template <typename T>
+    static constexpr size_t bytesFor(size_t count) noexcept {
+        return (count * sizeof(T) + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    DspArena() = default;
+    ~DspArena() { release(); }
+
+    DspArena(const DspArena&) = delete;
+    DspArena& operator=(const DspArena&) = delete;
+
+    // Off the audio thread. Exactly `bytes` (kept if already that size),
+    // then rewinds so prepare() can carve again. False if allocation fails.
+    bool reserve(size_t bytes) {
+        if (bytes != capacity_) {
+            release();
+            if (bytes > 0) {
+                base_ = static_cast<std::byte*>(::operator new(bytes, std::align_val_t(kAlignment), std::nothrow));
+                if (base_ == nullptr)
+                    return false;
+                capacity_ = bytes;
+            }
+        }
+        used_ = 0;
+        return true;
+    }
+
+    // Zeroed, cache-line aligned; nullptr if the reservation was too small
+    template <typename T>
+    T* allocate(size_t count) noexcept {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "Arena buffers hold plain data");
+        static_assert(alignof(T) <= kAlignment);
+
+        const size_t bytes = bytesFor<T>(count);
+        if (bytes > capacity_ - used_)
+            return nullptr;
+
+        std::byte* p = base_ + used_;
+        std::memset(p, 0, bytes);
+        used_ += bytes;
+        return reinterpret_cast<T*>(p);
+    }
+
+    void release() noexcept {
+        if (base_ != nullptr)
+            ::operator delete(base_, std::align_val_t(kAlignment));
+        base_ = nullptr;
+        capacity_ = 0;
+        used_ = 0;
+    }
+
+    bool isAllocated() const noexcept { return base_ != nullptr; }
+    size_t capacity() const noexcept { return capacity_; }
+    size_t used() const noexcept { return used_; }
+
+private:
+    std::byte* base_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+};
+
+} // namespace breath
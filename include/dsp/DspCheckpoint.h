@@ -0,0 +1,125 @@
+/*
+  DspCheckpoint.h - Capture / restore complete DSP state as a flat blob
+
+  A checkpoint holds everything a render depends on (RNG seeds, filter and
+  delay-line states, phases, envelopes, counters), so rendering from a
+  restored checkpoint is bit-identical to rendering straight through. Use
+  it to split a long offline render into time chunks on separate cores,
+  or to resume a bounce.
+
+  Blob layout (native endian, same build and sample rate only):
+
+    magic "BLCK", u32 version, f64 sample rate, then each component's
+    fields in a fixed order. Plain-data members are copied raw; delay
+    lines store only the window their longest possible delay can read.
+
+  CheckpointWriter with a null buffer only measures, so callers can size
+  storage with one pass and fill it with a second. Neither side allocates.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace breath {
+
+class CheckpointWriter {
+public:
+    CheckpointWriter(uint8_t* out, size_t capacity) noexcept
+        : out_(out), capacity_(capacity) {}
+
+    template <typename T>
+    void put(const T& value) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "Checkpoint fields must be plain data");
+        putBytes(&value, sizeof(T));
+    }
+
+    void putFloats(const float* data, size_t count) noexcept {
+        putBytes(data, count * sizeof(float));
+    }
+
+    void putBytes(const void* data, size_t size) noexcept {
+        if (out_ != nullptr && size_ + size <= capacity_)
+            std::memcpy(out_ + size_, data, size);
+        else if (out_ != nullptr)
+            overflow_ = true;
+        size_ += size;
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool ok() const noexcept { return !overflow_; }
+
+private:
+    uint8_t* out_;
+    size_t capacity_;
+    size_t size_ = 0;
+    bool overflow_ = false;
+};
+
+class CheckpointReader {
+public:
+    CheckpointReader(const uint8_t* data, size_t size) noexcept
+        : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T& value) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "Checkpoint fields must be plain data");
+        return getBytes(&value, sizeof(T));
+    }
+
+    bool getFloats(float* data, size_t count) noexcept {
+        return getBytes(data, count * sizeof(float));
+    }
+
+    bool getBytes(void* data, size_t size) noexcept {
+        if (failed_ || size > size_ - pos_) {
+            failed_ = true;
+            return false;
+        }
+        std::memcpy(data, data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    // Marks the checkpoint unusable (e.g. a sample-rate or layout mismatch)
+    void fail() noexcept { failed_ = true; }
+
+    bool ok() const noexcept { return !failed_; }
+    bool atEnd() const noexcept { return pos_ == size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+namespace checkpoint {
+
+constexpr uint32_t kVersion = 13;
+
+inline void write_header(CheckpointWriter& w, double sampleRate) noexcept {
+    w.putBytes("BLCK", 4);
+    w.put(kVersion);
+    w.put(sampleRate);
+}
+
+// Fails the reader unless magic, version and sample rate all match
+inline bool read_header(CheckpointReader& r, double sampleRate) noexcept {
+    char magic[4] = {};
+    uint32_t version = 0;
+    double rate = 0.0;
+
+    if (!r.getBytes(magic, 4) || !r.get(version) || !r.get(rate))
+        return false;
+
+    if (std::memcmp(magic, "BLCK", 4) != 0 || version != kVersion || rate != sampleRate)
+        r.fail();
+    return r.ok();
+}
+
+} // namespace checkpoint
+} // namespace breath
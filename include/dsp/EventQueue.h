@@ -0,0 +1,98 @@
+/*
+  EventQueue.h - Bounded wait-free multi-producer / single-consumer queue
+
+  Carries timestamped events from any number of threads (network,
+  sequencer, UI) to the audio thread. Storage is a fixed ring inside the
+  object; neither side allocates or locks, and every call finishes in a
+  bounded number of steps:
+
+  - push() reserves room with one fetch_add on the occupancy count (undone
+    and counted as dropped when full), then takes a ticket from the tail.
+    A reservation guarantees the ticket's slot was already released.
+  - drain() (consumer only) reads ready slots in ticket order and stops at
+    the first slot whose producer has not finished writing; that event and
+    everything after it are picked up by the next drain.
+
+  Capacity must be a power of two.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace DSP {
+
+template <typename T, int Capacity>
+class EventQueue {
+public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "Events must be plain data");
+
+    static constexpr int kCapacity = Capacity;
+
+    // Any thread. Returns false (and counts the event as dropped) when full.
+    bool push(const T& event) noexcept {
+        // acq_rel on both counters: the slot's previous reader happens-before
+        // this write, through whichever reservation made room for the ticket
+        if (reserved_.fetch_add(1, std::memory_order_acq_rel) >= Capacity) {
+            reserved_.fetch_sub(1, std::memory_order_relaxed);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const uint64_t ticket = tail_.fetch_add(1, std::memory_order_acq_rel);
+        Slot& slot = slots_[ticket & kMask];
+        slot.event = event;
+        slot.ready.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Calls fn(const T&) for up to maxEvents events in
+    // push order; returns how many were delivered.
+    template <typename Fn>
+    int drain(Fn&& fn, int maxEvents = Capacity) noexcept {
+        int count = 0;
+        while (count < maxEvents) {
+            Slot& slot = slots_[head_ & kMask];
+            if (!slot.ready.load(std::memory_order_acquire))
+                break;
+
+            fn(static_cast<const T&>(slot.event));
+
+            slot.ready.store(false, std::memory_order_relaxed);
+            ++head_;
+            reserved_.fetch_sub(1, std::memory_order_release);
+            ++count;
+        }
+        return count;
+    }
+
+    // Any thread
+    uint64_t getDroppedCount() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    void resetDroppedCount() noexcept { dropped_.store(0, std::memory_order_relaxed); }
+
+    // Approximate (includes events still being written)
+    int getNumPending() const noexcept {
+        const int n = reserved_.load(std::memory_order_relaxed);
+        return n < 0 ? 0 : (n > Capacity ? Capacity : n);
+    }
+
+private:
+    static constexpr uint64_t kMask = uint64_t(Capacity - 1);
+
+    struct Slot {
+        T event {};
+        std::atomic<bool> ready { false };
+    };
+
+    // Producers, consumer and the shared count on separate cache lines
+    alignas(64) std::atomic<uint64_t> tail_ { 0 };
+    alignas(64) std::atomic<int> reserved_ { 0 };
+    alignas(64) uint64_t head_ = 0;
+    alignas(64) std::atomic<uint64_t> dropped_ { 0 };
+    Slot slots_[Capacity];
+};
+
+} // namespace DSP
@@ -0,0 +1,271 @@
+/*
+  FdnAmbience.h - Shared room/body stage (8-line feedback delay network)
+
+  One instance sits after the voice mix, so the whole instrument pays for a
+  single small room instead of one reverb per voice.
+
+    in (L+R)/2 ─► 8 delay lines ─► damping + decay ─► Hadamard ─┐
+                       ▲                                        │
+                       └────────────────────────────────────────┘
+    taps: even lines → left, odd lines → right
+
+  - Delay lengths are mutually prime-ish and scale with Size; they glide
+    per sample across each control tick (linear-interpolated reads) so Size
+    automation doesn't click
+  - Decay per line is set from a common RT60 (longer with Size)
+  - Damping is a one-pole lowpass per line (high frequencies die first)
+  - The 8-lane damping and the Hadamard matrix are one dispatched kernel
+    (simd::Kernels::filterBank8: AVX2, SSE2, NEON or scalar)
+
+  The delay lines are carved from the engine's DspArena in prepare(), for
+  the largest Size; process() does not allocate. With Mix at zero the stage
+  is bypassed and costs nothing.
+
+  Mix and Size are followed once per kControlInterval samples of the
+  stage's own timeline, so the result does not depend on how the caller
+  slices its blocks.
+*/
+
+#pragma once
+
+#include "ControlSmoother.h"
+#include "DspArena.h"
+#include "DspCheckpoint.h"
+#include "SimdDispatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// FDN ambience
+// -----------------------------------------------------------------------------
+class FdnAmbience {
+public:
+    static constexpr int kNumLines = 8;
+
+    static size_t arenaBytes(double sampleRate) noexcept {
+        return DspArena::bytesFor<float>(size_t(lineSizeFor(sampleRate)) * kNumLines);
+    }
+
+    // Carves the delay lines from the arena (arenaBytes() of it); call off
+    // the audio thread
+    void prepare(double sampleRate, DspArena& arena) noexcept {
+        sampleRate_ = float(sampleRate);
+
+        const uint32_t size = lineSizeFor(sampleRate);
+        lines_ = arena.allocate<float>(size_t(size) * kNumLines);
+        lineSize_ = lines_ != nullptr ? size : 0;
+        mask_ = lineSize_ > 0 ? size - 1 : 0;
+
+        mix_.setTime(30.f, sampleRate_);
+        mix_.reset(mix_.target);
+
+        reset();
+        updateLengths(true);
+    }
+
+    void reset() noexcept {
+        clearLines();
+        samplesUntilTick_ = 0;
+    }
+
+    // 0..1 wet level (0 = bypass)
+    void setMix(float mix) noexcept { mix_.setTarget(std::clamp(mix, 0.f, 1.f)); }
+
+    // 0..1: small body → large room (lengths and decay)
+    void setSize(float size) noexcept { size_ = std::clamp(size, 0.f, 1.f); }
+
+    // 0..1: bright → dark tail
+    void setDamping(float damping) noexcept { damping_ = std::clamp(damping, 0.f, 1.f); }
+
+    bool isActive() const noexcept { return !bypassed_; }
+
+    // Checkpoint (line contents only while the stage is running)
+    void saveState(CheckpointWriter& w) const noexcept {
+        w.put(mix_); w.put(size_); w.put(damping_);
+        w.put(appliedSize_); w.put(appliedDamping_); w.put(gliding_); w.put(bypassed_);
+        w.put(delay_); w.put(delayStep_); w.put(gain_); w.put(coef_); w.put(state_);
+        w.put(lineSize_); w.put(writePos_);
+        w.put(samplesUntilTick_); w.put(tickMix_);
+        if (!bypassed_)
+            w.putFloats(lines_, numLineSamples());
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        uint32_t lineSize = 0;
+        r.get(mix_); r.get(size_); r.get(damping_);
+        r.get(appliedSize_); r.get(appliedDamping_); r.get(gliding_); r.get(bypassed_);
+        r.get(delay_); r.get(delayStep_); r.get(gain_); r.get(coef_); r.get(state_);
+        r.get(lineSize); r.get(writePos_);
+        r.get(samplesUntilTick_); r.get(tickMix_);
+
+        if (lineSize != lineSize_ || samplesUntilTick_ < 0 || samplesUntilTick_ > kControlInterval) {
+            r.fail();
+            return false;
+        }
+        writePos_ &= mask_;
+
+        if (!bypassed_)
+            r.getFloats(lines_, numLineSamples());
+        else
+            std::fill(lines_, lines_ + numLineSamples(), 0.f);
+        return r.ok();
+    }
+
+    // In place on the instrument's stereo mix; left and right may alias.
+    // Double buffers keep the dry path in double; the network runs in float.
+    template <typename Sample>
+    void process(Sample* left, Sample* right, int numSamples) noexcept {
+        for (int start = 0; start < numSamples;) {
+            if (samplesUntilTick_ == 0) {
+                samplesUntilTick_ = kControlInterval;
+                tick();
+            }
+
+            const int n = std::min(samplesUntilTick_, numSamples - start);
+            if (!bypassed_)
+                renderChunk(left + start, right + start, n, tickMix_);
+            samplesUntilTick_ -= n;
+            start += n;
+        }
+    }
+
+private:
+    static constexpr float kBaseMs[kNumLines] = {
+        7.3f, 9.1f, 11.3f, 13.7f, 17.1f, 19.9f, 23.3f, 29.3f
+    };
+    static constexpr float kMinScale = 0.35f;
+    static constexpr float kMaxScale = 2.2f;
+
+    static uint32_t lineSizeFor(double sampleRate) noexcept {
+        const float longest = kBaseMs[kNumLines - 1] * kMaxScale * 0.001f * float(sampleRate) + 4.f;
+        uint32_t size = 1;
+        while (size < uint32_t(longest)) size <<= 1;
+        return size;
+    }
+
+    size_t numLineSamples() const noexcept { return size_t(lineSize_) * kNumLines; }
+
+    void clearLines() noexcept {
+        std::fill(lines_, lines_ + numLineSamples(), 0.f);
+        std::fill(std::begin(state_), std::end(state_), 0.f);
+        writePos_ = 0;
+    }
+
+    // Control tick: mix smoother, bypass, delay lengths
+    void tick() noexcept {
+        tickMix_ = mix_.tick();
+        if (tickMix_ < 1.0e-4f && mix_.target == 0.f) {
+            bypassed_ = true;
+            return;
+        }
+
+        // Waking up: drop whatever tail was left when we bypassed
+        if (bypassed_) {
+            clearLines();
+            updateLengths(true);
+            bypassed_ = false;
+        }
+
+        updateLengths(false);
+    }
+
+    // Delay lengths glide towards Size, reaching this tick's value by the
+    // next tick in per-sample steps; decay and damping follow
+    void updateLengths(bool snap) noexcept {
+        if (!snap && !gliding_ && size_ == appliedSize_ && damping_ == appliedDamping_) {
+            std::fill(std::begin(delayStep_), std::end(delayStep_), 0.f);
+            return;
+        }
+        appliedSize_ = size_;
+        appliedDamping_ = damping_;
+
+        const float scale = kMinScale + (kMaxScale - kMinScale) * size_;
+        const float rt60 = 0.25f + size_ * 2.25f;
+        const float glide = snap ? 1.f : 0.05f;
+        gliding_ = false;
+
+        for (int i = 0; i < kNumLines; ++i) {
+            const float target = kBaseMs[i] * scale * 0.001f * sampleRate_;
+            const float next = delay_[i] + (target - delay_[i]) * glide;
+            gliding_ = gliding_ || std::abs(target - next) > 0.01f;
+            if (snap) {
+                delay_[i] = next;
+                delayStep_[i] = 0.f;
+            } else {
+                delayStep_[i] = (next - delay_[i]) / float(kControlInterval);
+            }
+
+            // -60 dB after rt60 seconds of round trips through this line
+            gain_[i] = std::pow(10.f, -3.f * next / (rt60 * sampleRate_));
+            coef_[i] = 1.f - damping_ * 0.85f;
+        }
+    }
+
+    template <typename Sample>
+    void renderChunk(Sample* left, Sample* right, int n, float mix) noexcept {
+        const auto& kernels = simd::kernels();
+        alignas(16) float taps[kNumLines];
+
+        for (int s = 0; s < n; ++s) {
+            const float input = float(Sample(0.5f) * (left[s] + right[s]));
+
+            // Fractional reads (linear; lengths glide)
+            for (int i = 0; i < kNumLines; ++i) {
+                const int whole = int(delay_[i]);
+                const float frac = delay_[i] - float(whole);
+                const float* line = lines_ + size_t(i) * lineSize_;
+                const float a = line[(writePos_ - uint32_t(whole)) & mask_];
+                const float b = line[(writePos_ - uint32_t(whole) - 1) & mask_];
+                taps[i] = a + (b - a) * frac;
+                delay_[i] += delayStep_[i];
+            }
+
+            const float wetL = (taps[0] + taps[2] + taps[4] + taps[6]) * 0.5f;
+            const float wetR = (taps[1] + taps[3] + taps[5] + taps[7]) * 0.5f;
+
+            kernels.filterBank8(taps, state_, coef_, gain_);
+
+            for (int i = 0; i < kNumLines; ++i) {
+                const float sign = (i & 2) ? -0.35f : 0.35f;
+                lines_[size_t(i) * lineSize_ + writePos_] = taps[i] + input * sign;
+            }
+            writePos_ = (writePos_ + 1) & mask_;
+
+            // Computed before writing: left and right may be the same buffer
+            const float dry = 1.f - 0.3f * mix;
+            const Sample outL = left[s] * Sample(dry) + Sample(wetL * mix);
+            const Sample outR = right[s] * Sample(dry) + Sample(wetR * mix);
+            left[s] = outL;
+            right[s] = outR;
+        }
+    }
+
+    float* lines_ = nullptr;        // kNumLines × lineSize_, in the arena
+    uint32_t lineSize_ = 0;
+    uint32_t mask_ = 0;
+    uint32_t writePos_ = 0;
+
+    alignas(16) float delay_[kNumLines] = {};
+    alignas(16) float delayStep_[kNumLines] = {};  // Per sample, until the next tick
+    alignas(16) float gain_[kNumLines] = {};
+    alignas(16) float coef_[kNumLines] = {};
+    alignas(16) float state_[kNumLines] = {};
+
+    ControlSmoother mix_;
+    float sampleRate_ = 48000.f;
+    float size_ = 0.4f;
+    float damping_ = 0.4f;
+    float appliedSize_ = -1.f;
+    float appliedDamping_ = -1.f;
+    bool gliding_ = false;
+    bool bypassed_ = true;
+
+    int samplesUntilTick_ = 0;
+    float tickMix_ = 0.f;
+};
+
+} // namespace breath
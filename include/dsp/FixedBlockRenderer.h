@@ -0,0 +1,119 @@
+/*
+  FixedBlockRenderer.h - Fixed internal blocks under any host block size
+
+  Hosts call with whatever block size suits them (1, 17, 480, 4096, or a
+  different size every call). Behind a FixedBlockRenderer the engine
+  renders on its own grid of kProcessBlock samples into aligned buffers,
+  so control ticks, the room's smoothers and the voices' tick-aligned runs
+  fall on the same samples however the host slices time.
+
+  Two modes:
+  - BlockLatency::Zero (default): a host block that ends inside a grid
+    block renders that part of it right away; the next call renders the
+    rest. No delay, and blocks still start on grid edges, never on host
+    block edges.
+  - BlockLatency::Buffered: the engine only ever renders whole blocks.
+    What the host did not take of the last one waits in the FIFO for the
+    next call, at the cost of kProcessBlock samples of latency
+    (getLatencySamples(), report it to the host).
+
+  process() calls renderBlock(start, left, right, n) once per piece of a
+  grid block. `start` is where the piece begins relative to the host
+  block: events at host offset o belong to it when o < start + n (and
+  were not taken by an earlier piece). It is negative in Buffered mode,
+  where the engine runs behind the host. The callback writes all n
+  samples of left and right.
+*/
+
+#pragma once
+
+#include "ControlSmoother.h"
+#include "DspCheckpoint.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace breath {
+
+// Samples per internal block (one control tick at the default rate)
+constexpr int kProcessBlock = kControlInterval;
+
+enum class BlockLatency {
+    Zero,       // Partial blocks rendered directly
+    Buffered    // Whole blocks only, kProcessBlock samples late
+};
+
+template <typename Sample>
+class FixedBlockRenderer {
+public:
+    // Not while process() runs; restarts the grid
+    void setLatency(BlockLatency latency) noexcept {
+        latency_ = latency;
+        reset();
+    }
+
+    BlockLatency getLatency() const noexcept { return latency_; }
+    int getLatencySamples() const noexcept { return latency_ == BlockLatency::Buffered ? kProcessBlock : 0; }
+
+    // Back to the start of a grid block; Buffered starts one block of
+    // silence ahead
+    void reset() noexcept {
+        std::fill(std::begin(left_), std::end(left_), Sample(0));
+        std::fill(std::begin(right_), std::end(right_), Sample(0));
+        filled_ = latency_ == BlockLatency::Buffered ? kProcessBlock : 0;
+        played_ = 0;
+    }
+
+    // Fills numSamples of outL / outR (which may alias)
+    template <typename RenderBlock>
+    void process(Sample* outL, Sample* outR, int numSamples, RenderBlock&& renderBlock) noexcept {
+        // Engine position relative to the host block
+        int start = filled_ - played_ - getLatencySamples();
+
+        for (int pos = 0; pos < numSamples;) {
+            if (played_ == filled_) {
+                if (filled_ == kProcessBlock)
+                    filled_ = played_ = 0;
+
+                const int n = latency_ == BlockLatency::Buffered
+                                  ? kProcessBlock
+                                  : std::min(kProcessBlock - filled_, numSamples - pos);
+                renderBlock(start, left_ + filled_, right_ + filled_, n);
+                filled_ += n;
+                start += n;
+            }
+
+            const int n = std::min(filled_ - played_, numSamples - pos);
+            std::copy(left_ + played_, left_ + played_ + n, outL + pos);
+            std::copy(right_ + played_, right_ + played_ + n, outR + pos);
+            played_ += n;
+            pos += n;
+        }
+    }
+
+    // Checkpoint (between host blocks)
+    void saveState(CheckpointWriter& w) const noexcept {
+        w.put(latency_); w.put(filled_); w.put(played_);
+        w.put(left_); w.put(right_);
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        BlockLatency latency = latency_;
+        r.get(latency); r.get(filled_); r.get(played_);
+        r.get(left_); r.get(right_);
+
+        if (latency != latency_ || filled_ < 0 || filled_ > kProcessBlock || played_ < 0 || played_ > filled_)
+            r.fail();
+        return r.ok();
+    }
+
+private:
+    // The current grid block: [0, filled_) rendered, [0, played_) handed out
+    alignas(64) Sample left_[kProcessBlock] = {};
+    alignas(64) Sample right_[kProcessBlock] = {};
+    int filled_ = 0;
+    int played_ = 0;
+    BlockLatency latency_ = BlockLatency::Zero;
+};
+
+} // namespace breath
@@ -27,9 +27,11 @@ struct ScheduledEvent
 
     Type type = NoteOn;
     int noteNumber = 0;
-    float velocity = 0.0f;
-    float value = 0.0f;
+    float velocity = 0.0f;          // 0..1
+    float value = 0.0f;             // CC: 0..1, PitchBend: -1..1
     int controllerNumber = 0;
+    int channel = 0;                // MIDI channel 0-15 (MPE member channels)
+    int sampleOffset = 0;           // Samples into the next processed block
 };
 
 //==============================================================================
@@ -47,7 +49,9 @@ public:
     virtual void reset() = 0;
     virtual void process(float** outputs, int numChannels, int numSamples) = 0;
 
-    // Event handling
+    // Event handling. May be called from any thread, concurrently with
+    // process(): events are queued and applied at their sampleOffset in the
+    // next block (later blocks for offsets past its end). Must not block.
     virtual void handleEvent(const ScheduledEvent& event) = 0;
 
     // Parameters
@@ -68,6 +72,11 @@ public:
 
     // Optional panic method
     virtual void panic() {}
+
+    // Optional: frees what prepare() allocated (prepare() again before
+    // process()), and the bytes the instrument currently holds
+    virtual void releaseResources() {}
+    virtual size_t getMemoryFootprint() const { return 0; }
 };
 
 } // namespace DSP
@@ -0,0 +1,472 @@
+/*
+  JsonStream.h - Allocation-free JSON writer and pull parser
+
+  For small documents in caller-owned buffers (presets, snapshots):
+
+  - JsonWriter streams into a fixed char buffer and always leaves it
+    null-terminated; overflow sets a flag instead of writing past the end.
+    Floats are written with 9 significant digits, so every float reads
+    back exactly.
+  - JsonReader walks a null-terminated document once, front to back. The
+    caller pulls what it expects (objects, keys, numbers, strings) and
+    skips the rest; unknown values of any depth are skipped without
+    recursion. Any syntax error latches failed().
+
+  Neither side allocates, and neither depends on the C locale: numbers use
+  '.' whatever LC_NUMERIC says.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+class JsonWriter {
+public:
+    static constexpr int kMaxDepth = 16;
+
+    JsonWriter(char* out, int capacity) noexcept
+        : out_(out), capacity_(capacity > 0 && out != nullptr ? capacity : 0) {
+        if (capacity_ > 0)
+            out_[0] = '\0';
+        else
+            overflow_ = true;
+    }
+
+    void beginObject() noexcept { open('{'); }
+    void endObject() noexcept { close('}'); }
+    void beginArray() noexcept { open('['); }
+    void endArray() noexcept { close(']'); }
+
+    // Object member name; the next value call writes its value
+    void key(const char* name) noexcept {
+        separator();
+        string(name);
+        put(':');
+        afterKey_ = true;
+    }
+
+    void value(float v) noexcept {
+        separator();
+        if (!std::isfinite(v)) {
+            raw("null");    // JSON has no NaN / Inf
+            return;
+        }
+
+        char text[32];
+        const int n = std::snprintf(text, sizeof(text), "%.9g", double(v));
+        for (int i = 0; i < n; ++i)
+            put(text[i] == ',' ? '.' : text[i]);   // Locale decimal comma
+    }
+
+    void value(int v) noexcept {
+        separator();
+        char text[16];
+        int n = 0;
+        uint32_t u = v < 0 ? 0u - uint32_t(v) : uint32_t(v);
+        do {
+            text[n++] = char('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        if (v < 0)
+            put('-');
+        while (n > 0)
+            put(text[--n]);
+    }
+
+    void value(bool v) noexcept {
+        separator();
+        raw(v ? "true" : "false");
+    }
+
+    void value(const char* s) noexcept {
+        separator();
+        string(s);
+    }
+
+    bool ok() const noexcept { return !overflow_ && depth_ == 0; }
+    int size() const noexcept { return pos_; }  // Excluding the terminator
+
+private:
+    void put(char c) noexcept {
+        if (pos_ + 1 < capacity_) {
+            out_[pos_++] = c;
+            out_[pos_] = '\0';
+        } else {
+            overflow_ = true;
+        }
+    }
+
+    void raw(const char* s) noexcept {
+        while (*s != '\0')
+            put(*s++);
+    }
+
+    void string(const char* s) noexcept {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (; s != nullptr && *s != '\0'; ++s) {
+            const unsigned char c = static_cast<unsigned char>(*s);
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(char(c));
+            } else if (c < 0x20) {
+                raw("\\u00");
+                put(hex[c >> 4]);
+                put(hex[c & 15]);
+            } else {
+                put(char(c));
+            }
+        }
+        put('"');
+    }
+
+    // Comma before every element but the first at this level
+    void separator() noexcept {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        if (depth_ > 0) {
+            if (!first_[depth_ - 1])
+                put(',');
+            first_[depth_ - 1] = false;
+        }
+    }
+
+    void open(char c) noexcept {
+        separator();
+        put(c);
+        if (depth_ < kMaxDepth)
+            first_[depth_] = true;
+        else
+            overflow_ = true;
+        ++depth_;
+    }
+
+    void close(char c) noexcept {
+        if (depth_ > 0)
+            --depth_;
+        put(c);
+    }
+
+    char* out_;
+    int capacity_;
+    int pos_ = 0;
+    int depth_ = 0;
+    bool overflow_ = false;
+    bool afterKey_ = false;
+    bool first_[kMaxDepth] = {};
+};
+
+// -----------------------------------------------------------------------------
+// Pull parser
+// -----------------------------------------------------------------------------
+class JsonReader {
+public:
+    static constexpr int kMaxDepth = 64;
+
+    explicit JsonReader(const char* text) noexcept
+        : p_(text != nullptr ? text : "") {
+        if (text == nullptr)
+            failed_ = true;
+    }
+
+    bool failed() const noexcept { return failed_; }
+
+    // Only whitespace left
+    bool atEnd() noexcept {
+        skipWhitespace();
+        return !failed_ && *p_ == '\0';
+    }
+
+    // Consumes '{'; then loop on nextKey() until it returns false
+    bool beginObject() noexcept {
+        if (!expect('{'))
+            return false;
+        if (depth_ >= kMaxDepth)
+            return fail();
+        first_[depth_++] = true;
+        return true;
+    }
+
+    // Reads the next member name (truncated to keySize - 1) and its ':'.
+    // Returns false at the closing '}' (consumed) or on error.
+    bool nextKey(char* key, int keySize) noexcept {
+        if (failed_ || depth_ == 0)
+            return fail();
+
+        skipWhitespace();
+        if (*p_ == '}') {
+            ++p_;
+            --depth_;
+            return false;
+        }
+        if (!first_[depth_ - 1] && !expect(','))
+            return false;
+        first_[depth_ - 1] = false;
+
+        return readString(key, keySize) && expect(':');
+    }
+
+    bool readString(char* out, int outSize) noexcept {
+        if (!expect('"'))
+            return false;
+
+        int n = 0;
+        for (;;) {
+            char c = *p_;
+            if (c == '\0' || static_cast<unsigned char>(c) < 0x20)
+                return fail();
+            ++p_;
+            if (c == '"')
+                break;
+
+            if (c == '\\') {
+                const char e = *p_++;
+                switch (e) {
+                    case '"': case '\\': case '/': c = e; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u': {
+                        unsigned code = 0;
+                        for (int i = 0; i < 4; ++i) {
+                            const int d = hexDigit(*p_);
+                            if (d < 0)
+                                return fail();
+                            code = code * 16 + unsigned(d);
+                            ++p_;
+                        }
+                        c = code < 0x80 ? char(code) : '?';   // Names are ASCII
+                        break;
+                    }
+                    default:
+                        return fail();
+                }
+            }
+
+            if (n + 1 < outSize)
+                out[n++] = c;
+        }
+
+        if (outSize > 0)
+            out[n] = '\0';
+        return true;
+    }
+
+    bool readNumber(double& out) noexcept {
+        skipWhitespace();
+        const char* s = p_;
+
+        const bool negative = *s == '-';
+        if (negative)
+            ++s;
+        if (!isDigit(*s))
+            return fail();
+
+        // Up to 19 significant digits exactly; the rest only scale
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+
+        if (*s == '0') {
+            ++s;
+        } else {
+            for (; isDigit(*s); ++s) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + uint64_t(*s - '0');
+                    if (mantissa != 0) ++digits;
+                } else {
+                    ++exponent;
+                }
+            }
+        }
+
+        if (*s == '.') {
+            ++s;
+            if (!isDigit(*s))
+                return fail();
+            for (; isDigit(*s); ++s) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + uint64_t(*s - '0');
+                    if (mantissa != 0) ++digits;
+                    --exponent;
+                }
+            }
+        }
+
+        if (*s == 'e' || *s == 'E') {
+            ++s;
+            const bool negativeExp = *s == '-';
+            if (*s == '+' || *s == '-')
+                ++s;
+            if (!isDigit(*s))
+                return fail();
+            int e = 0;
+            for (; isDigit(*s); ++s)
+                if (e < 10000)
+                    e = e * 10 + (*s - '0');
+            exponent += negativeExp ? -e : e;
+        }
+
+        // Exact for the short values the writer produces (|exp| <= 22)
+        static constexpr double kPow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        double value = double(mantissa);
+        if (mantissa != 0) {
+            if (exponent >= -22 && exponent <= 22)
+                value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+            else
+                value *= std::pow(10.0, double(exponent));
+        }
+
+        if (!std::isfinite(value))
+            return fail();
+
+        p_ = s;
+        out = negative ? -value : value;
+        return true;
+    }
+
+    bool readBool(bool& out) noexcept {
+        skipWhitespace();
+        if (literal("true")) {
+            out = true;
+            return true;
+        }
+        if (literal("false")) {
+            out = false;
+            return true;
+        }
+        return fail();
+    }
+
+    // Skips one value of any type and depth
+    bool skipValue() noexcept {
+        uint64_t stack = 0;     // 1 = object, 0 = array, per open level
+        int depth = 0;
+
+        for (;;) {
+            skipWhitespace();
+            if (failed_)
+                return false;
+
+            // A value
+            const char c = *p_;
+            if (c == '{' || c == '[') {
+                if (depth >= 64)
+                    return fail();
+                ++p_;
+                stack = (stack << 1) | (c == '{' ? 1u : 0u);
+                ++depth;
+
+                skipWhitespace();
+                if (*p_ == (c == '{' ? '}' : ']')) {
+                    ++p_;
+                    --depth;
+                    stack >>= 1;
+                } else {
+                    if (c == '{' && !(skipString() && expect(':')))
+                        return false;
+                    continue;
+                }
+            } else if (c == '"') {
+                if (!skipString())
+                    return false;
+            } else if (c == 't' || c == 'f') {
+                bool b;
+                if (!readBool(b))
+                    return false;
+            } else if (c == 'n') {
+                if (!literal("null"))
+                    return fail();
+            } else {
+                double d;
+                if (!readNumber(d))
+                    return false;
+            }
+
+            // After a value: close finished containers, or move to the next element
+            for (;;) {
+                if (depth == 0)
+                    return true;
+
+                const bool inObject = (stack & 1) != 0;
+                skipWhitespace();
+                if (*p_ == ',') {
+                    ++p_;
+                    if (inObject && !(skipString() && expect(':')))
+                        return false;
+                    break;
+                }
+                if (*p_ != (inObject ? '}' : ']'))
+                    return fail();
+                ++p_;
+                --depth;
+                stack >>= 1;
+            }
+        }
+    }
+
+private:
+    static bool isDigit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+    static int hexDigit(char c) noexcept {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool fail() noexcept {
+        failed_ = true;
+        return false;
+    }
+
+    void skipWhitespace() noexcept {
+        while (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')
+            ++p_;
+    }
+
+    bool expect(char c) noexcept {
+        if (failed_)
+            return false;
+        skipWhitespace();
+        if (*p_ != c)
+            return fail();
+        ++p_;
+        return true;
+    }
+
+    bool literal(const char* word) noexcept {
+        const size_t n = std::strlen(word);
+        if (std::strncmp(p_, word, n) != 0)
+            return false;
+        p_ += n;
+        return true;
+    }
+
+    bool skipString() noexcept {
+        char scratch[1];
+        return readString(scratch, 0);
+    }
+
+    const char* p_;
+    int depth_ = 0;
+    bool failed_ = false;
+    bool first_[kMaxDepth] = {};
+};
+
+} // namespace breath
@@ -0,0 +1,105 @@
+/*
+  MpeZone.h - MIDI Polyphonic Expression zone layout
+
+  Classifies MIDI channels into master / member / global roles and tracks
+  the MPE Configuration Message (RPN 6) and pitch bend sensitivity (RPN 0)
+  so per-note and zone-wide bend ranges follow the controller.
+
+  Pure data, no allocation. Channels are 0-based (0 = MIDI channel 1).
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+namespace breath {
+
+struct MpeZone {
+    enum class Role { Global, Master, Member };
+
+    bool enabled = false;
+
+    // Member channel counts (MPE default: lower zone with 15 members)
+    int lowerMembers = 15;
+    int upperMembers = 0;
+
+    // Bend ranges in semitones (MPE defaults)
+    float memberBendRange = 48.f;
+    float masterBendRange = 2.f;
+
+    // Per-channel RPN selection (127/127 = null)
+    uint8_t rpnMsb[16] = { 127, 127, 127, 127, 127, 127, 127, 127,
+                           127, 127, 127, 127, 127, 127, 127, 127 };
+    uint8_t rpnLsb[16] = { 127, 127, 127, 127, 127, 127, 127, 127,
+                           127, 127, 127, 127, 127, 127, 127, 127 };
+
+    // Manual switch (e.g. from a parameter); falls back to the default layout
+    void setEnabled(bool shouldEnable) noexcept {
+        enabled = shouldEnable;
+        if (enabled && lowerMembers == 0 && upperMembers == 0)
+            lowerMembers = 15;
+    }
+
+    Role roleOf(int channel) const noexcept {
+        if (!enabled)
+            return Role::Global;
+
+        if (lowerMembers > 0) {
+            if (channel == 0) return Role::Master;
+            if (channel >= 1 && channel <= lowerMembers) return Role::Member;
+        }
+        if (upperMembers > 0) {
+            if (channel == 15) return Role::Master;
+            if (channel <= 14 && channel >= 15 - upperMembers) return Role::Member;
+        }
+        return Role::Global;
+    }
+
+    // Feed every controller message through here first.
+    // Returns true if the message was consumed as zone configuration.
+    bool handleController(int channel, int cc, int value) noexcept {
+        switch (cc) {
+            case 101: rpnMsb[channel] = uint8_t(value); return true;
+            case 100: rpnLsb[channel] = uint8_t(value); return true;
+            case 6:   return handleDataEntry(channel, value);
+            default:  return false;
+        }
+    }
+
+private:
+    bool handleDataEntry(int channel, int value) noexcept {
+        if (rpnMsb[channel] != 0)
+            return false;
+
+        if (rpnLsb[channel] == 6) {
+            // MPE Configuration Message (only valid on channel 1 or 16)
+            const int members = std::clamp(value, 0, 15);
+            if (channel == 0) {
+                lowerMembers = members;
+                upperMembers = std::min(upperMembers, std::max(0, 14 - members));
+            } else if (channel == 15) {
+                upperMembers = members;
+                lowerMembers = std::min(lowerMembers, std::max(0, 14 - members));
+            } else {
+                return true;
+            }
+            enabled = lowerMembers > 0 || upperMembers > 0;
+            return true;
+        }
+
+        if (rpnLsb[channel] == 0) {
+            // Pitch bend sensitivity
+            const Role role = roleOf(channel);
+            if (role == Role::Member)
+                memberBendRange = float(std::clamp(value, 0, 96));
+            else
+                masterBendRange = float(std::clamp(value, 0, 96));
+            return true;
+        }
+
+        return false;
+    }
+};
+
+} // namespace breath
@@ -0,0 +1,94 @@
+/*
+  PolyphaseResampler.h - Integer-factor polyphase interpolator
+
+  Joins a stage running at a decimated internal rate to the host-rate path.
+  One low-rate input sample produces `factor` high-rate samples; each output
+  phase is an 8-tap dot product against the same input history, so the
+  cost per output sample is constant whatever the factor.
+
+  The prototype is a Blackman-windowed sinc with its cutoff at 90% of the
+  low-rate Nyquist, designed in prepare() into fixed storage (no heap).
+  Factor 1 is a plain pass-through.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace breath {
+
+class PolyphaseInterpolator {
+public:
+    static constexpr int kMaxFactor = 4;
+    static constexpr int kTapsPerPhase = 8;
+
+    void prepare(int factor) noexcept {
+        factor_ = std::clamp(factor, 1, kMaxFactor);
+
+        const int length = factor_ * kTapsPerPhase;
+        const float centre = 0.5f * float(length - 1);
+        const float cutoff = 0.9f * 0.5f / float(factor_);  // Cycles per output sample
+
+        for (int p = 0; p < factor_; ++p) {
+            float sum = 0.f;
+            for (int k = 0; k < kTapsPerPhase; ++k) {
+                const int n = p + k * factor_;
+                const float x = float(n) - centre;
+                const float sinc = x == 0.f ? 2.f * cutoff
+                                            : std::sin(6.28318531f * cutoff * x) / (3.14159265f * x);
+                const float w = 0.42f - 0.5f * std::cos(6.28318531f * float(n) / float(length - 1))
+                              + 0.08f * std::cos(12.5663706f * float(n) / float(length - 1));
+                coefs_[p][k] = sinc * w;
+                sum += coefs_[p][k];
+            }
+
+            // Unity DC gain per phase (no ripple at the low rate's sample points)
+            for (int k = 0; k < kTapsPerPhase; ++k)
+                coefs_[p][k] /= sum;
+        }
+
+        reset();
+    }
+
+    void reset() noexcept {
+        std::fill(std::begin(history_), std::end(history_), 0.f);
+        pos_ = 0;
+    }
+
+    int getFactor() const noexcept { return factor_; }
+
+    // Group delay in low-rate samples
+    float getLatency() const noexcept {
+        return factor_ > 1 ? 0.5f * float(factor_ * kTapsPerPhase - 1) / float(factor_) : 0.f;
+    }
+
+    // Push one low-rate sample, write getFactor() high-rate samples
+    void process(float in, float* out) noexcept {
+        if (factor_ == 1) {
+            out[0] = in;
+            return;
+        }
+
+        // History is stored twice so every phase reads one contiguous run
+        pos_ = (pos_ == 0 ? kTapsPerPhase : pos_) - 1;
+        history_[pos_] = in;
+        history_[pos_ + kTapsPerPhase] = in;
+
+        const float* x = history_ + pos_;   // x[k] = input k samples ago
+        for (int p = 0; p < factor_; ++p) {
+            float acc = 0.f;
+            for (int k = 0; k < kTapsPerPhase; ++k)
+                acc += coefs_[p][k] * x[k];
+            out[p] = acc;
+        }
+    }
+
+private:
+    alignas(16) float coefs_[kMaxFactor][kTapsPerPhase] = {};
+    alignas(16) float history_[2 * kTapsPerPhase] = {};
+    int pos_ = 0;
+    int factor_ = 1;
+};
+
+} // namespace breath
@@ -0,0 +1,106 @@
+/*
+  PresetMorph.h - Continuous morphing between preset snapshots
+
+  Up to kMaxEndpoints snapshots are spread evenly over a single 0..1 morph
+  position (A at 0, last endpoint at 1) and interpolated piecewise-linearly.
+
+  Each endpoint goes from the loader thread to the audio thread through its
+  own SnapshotMailbox: the loader publishes, the audio thread takes the
+  newest complete snapshot at each control block and keeps its copy
+  otherwise. No locks, no allocation, and no shared copy that both threads
+  touch at once.
+
+  The interpolated snapshot is a target only; SnapshotSmoother glides the
+  voice towards it at control rate so fast macro moves don't zipper.
+*/
+
+#pragma once
+
+#include "PresetSnapshot.h"
+#include "ControlSmoother.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace breath {
+
+inline PresetSnapshot lerp_snapshot(const PresetSnapshot& a, const PresetSnapshot& b, float t) noexcept {
+    const auto mix = [t](float x, float y) { return x + (y - x) * t; };
+    return { mix(a.air, b.air), mix(a.tone, b.tone), mix(a.formant, b.formant),
+             mix(a.resistance, b.resistance), mix(a.vibrato, b.vibrato),
+             mix(a.masterGain, b.masterGain),
+             t < 0.5f ? a.engine : b.engine };   // Engines switch at the midpoint
+}
+
+class PresetMorpher {
+public:
+    static constexpr int kMaxEndpoints = 4;
+
+    // -------------------------------------------------------------------------
+    // Loader thread
+    // -------------------------------------------------------------------------
+    void loadEndpoint(int slot, const PresetSnapshot& snapshot) noexcept {
+        if (slot < 0 || slot >= kMaxEndpoints)
+            return;
+
+        endpoints_[slot].publish(snapshot);
+    }
+
+    void setNumEndpoints(int n) noexcept {
+        numEndpoints_.store(std::clamp(n, 1, kMaxEndpoints), std::memory_order_release);
+    }
+
+    // -------------------------------------------------------------------------
+    // Audio thread (once per control block)
+    // -------------------------------------------------------------------------
+    PresetSnapshot evaluate(float position) noexcept {
+        const int n = numEndpoints_.load(std::memory_order_acquire);
+        for (int i = 0; i < n; ++i)
+            endpoints_[i].consume(current_[i]);
+
+        if (n == 1)
+            return current_[0];
+
+        const float scaled = std::clamp(position, 0.f, 1.f) * float(n - 1);
+        const int lower = std::min(int(scaled), n - 2);
+        return lerp_snapshot(current_[lower], current_[lower + 1], scaled - float(lower));
+    }
+
+private:
+    SnapshotMailbox<PresetSnapshot> endpoints_[kMaxEndpoints];
+    PresetSnapshot current_[kMaxEndpoints];     // Audio-thread copies
+    std::atomic<int> numEndpoints_ { 2 };
+};
+
+// -----------------------------------------------------------------------------
+// Snapshot smoother (one ControlSmoother per value, ticked per control block)
+// -----------------------------------------------------------------------------
+struct SnapshotSmoother {
+    ControlSmoother air, tone, formant, resistance, vibrato, masterGain;
+    int engine = 0;             // Discrete: follows the target immediately
+
+    void prepare(float sampleRate, float timeMs = 20.f) noexcept {
+        for (auto* s : { &air, &tone, &formant, &resistance, &vibrato, &masterGain })
+            s->setTime(timeMs, sampleRate);
+    }
+
+    void reset(const PresetSnapshot& v) noexcept {
+        air.reset(v.air); tone.reset(v.tone); formant.reset(v.formant);
+        resistance.reset(v.resistance); vibrato.reset(v.vibrato); masterGain.reset(v.masterGain);
+        engine = v.engine;
+    }
+
+    void setTarget(const PresetSnapshot& v) noexcept {
+        air.setTarget(v.air); tone.setTarget(v.tone); formant.setTarget(v.formant);
+        resistance.setTarget(v.resistance); vibrato.setTarget(v.vibrato); masterGain.setTarget(v.masterGain);
+        engine = v.engine;
+    }
+
+    PresetSnapshot tick() noexcept {
+        return { air.tick(), tone.tick(), formant.tick(),
+                 resistance.tick(), vibrato.tick(), masterGain.tick(), engine };
+    }
+};
+
+} // namespace breath
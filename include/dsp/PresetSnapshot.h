@@ -0,0 +1,94 @@
+/*
+  PresetSnapshot.h - Preparsed preset values + lock-free audio-thread handoff
+
+  A PresetSnapshot is plain data (no strings, no heap), so it can be copied
+  on the audio thread. SnapshotMailbox hands the latest published snapshot
+  from one producer thread to the audio thread with a triple buffer: both
+  sides are wait-free, the reader always sees a complete snapshot, and
+  intermediate values the reader never picked up are simply skipped.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Preset values (0..1 floats, same meaning as the host parameters)
+// -----------------------------------------------------------------------------
+struct PresetSnapshot {
+    float air = 0.5f;
+    float tone = 0.6f;
+    float formant = 0.5f;
+    float resistance = 0.4f;
+    float vibrato = 0.f;
+    float masterGain = 0.7f;
+    int engine = 0;             // ResonanceEngine index
+};
+
+static_assert(std::is_trivially_copyable_v<PresetSnapshot>);
+
+// Clamps each value to its range; NaN and infinities take the default.
+// Returns false if anything had to change.
+inline bool sanitise(PresetSnapshot& s) noexcept {
+    const PresetSnapshot defaults;
+    bool clean = true;
+
+    const auto unit = [&clean](float& v, float fallback) {
+        const float fixed = std::isfinite(v) ? std::clamp(v, 0.f, 1.f) : fallback;
+        clean = clean && fixed == v;
+        v = fixed;
+    };
+
+    unit(s.air, defaults.air);
+    unit(s.tone, defaults.tone);
+    unit(s.formant, defaults.formant);
+    unit(s.resistance, defaults.resistance);
+    unit(s.vibrato, defaults.vibrato);
+    unit(s.masterGain, defaults.masterGain);
+
+    const int engine = std::clamp(s.engine, 0, 2);
+    clean = clean && engine == s.engine;
+    s.engine = engine;
+    return clean;
+}
+
+// -----------------------------------------------------------------------------
+// Triple-buffered latest-value mailbox (single producer, single consumer)
+// -----------------------------------------------------------------------------
+template <typename T>
+class SnapshotMailbox {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Mailbox payload must be POD");
+
+    // Producer: copy in and publish
+    void publish(const T& value) noexcept {
+        slots_[back_] = value;
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Consumer: returns true (and fills out) if something new was published
+    bool consume(T& out) noexcept {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0)
+            return false;
+
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        out = slots_[front_];
+        return true;
+    }
+
+private:
+    static constexpr int kFresh = 4;
+    static constexpr int kIndexMask = 3;
+
+    T slots_[3] {};
+    int back_ = 0;                      // Producer-owned
+    int front_ = 1;                     // Consumer-owned
+    std::atomic<int> middle_ { 2 };     // Shared; kFresh = unread value
+};
+
+} // namespace breath
@@ -4,6 +4,16 @@
 // Implements Cooley-Tukey FFT algorithm with zero external dependencies
 // Optimized for audio processing (powers of 2 only)
 //
+// All scratch memory is allocated in the constructor; forward/inverse and
+// the real-valued variants do not allocate and are safe on the audio thread
+// (one FFT instance per thread).
+//
+// Twiddles and bit-reversal indices are read-only and shared by every FFT
+// of the same size in the process (breath::SharedTable).
+//
+// Butterfly stages run through the runtime-dispatched SIMD kernel
+// (breath::simd, see SimdDispatch.h); every ISA gives the scalar result.
+//
 // Copyright (c) 2025 ChoirV2 Project
 // MIT License - See LICENSE for details
 //==============================================================================
@@ -13,12 +23,70 @@
 
 #include <vector>
 #include <complex>
+#include <stdexcept>
 #include <cmath>
 #include <algorithm>
 #include <numbers>
+#include <memory>
+
+#include "SimdDispatch.h"
+#include "SharedTable.h"
 
 namespace PureDSP {
 
+//==============================================================================
+// Read-only tables for one FFT size (shared, see breath::SharedTable)
+struct FFTTables
+{
+    using Complex = std::complex<float>;
+
+    FFTTables(double /*sampleRate*/, int size)
+    {
+        const int log2Size = static_cast<int>(std::log2(size));
+
+        // Twiddle factors
+        std::vector<Complex> twiddleFactors(size / 2);
+        for (int k = 0; k < size / 2; ++k)
+        {
+            float phase = -2.0f * std::numbers::pi_v<float> * k / size;
+            twiddleFactors[k] = Complex(std::cos(phase), std::sin(phase));
+        }
+
+        // Per-stage twiddles, contiguous for the vector kernels: the stage
+        // with half-size h uses twiddleFactors[j * size / (2h)], j < h,
+        // stored from offset h - 1
+        stageTwiddles.resize(std::max(size - 1, 0));
+        for (int half = 1; half < size; half <<= 1)
+        {
+            for (int j = 0; j < half; ++j)
+            {
+                stageTwiddles[half - 1 + j] = twiddleFactors[(j * size) / (2 * half)];
+            }
+        }
+
+        // Bit reversal indices
+        bitReversalIndices.resize(size);
+        for (int i = 0; i < size; ++i)
+        {
+            bitReversalIndices[i] = reverseBits(i, log2Size);
+        }
+    }
+
+    static int reverseBits(int n, int numBits)
+    {
+        int reversed = 0;
+        for (int i = 0; i < numBits; ++i)
+        {
+            reversed = (reversed << 1) | (n & 1);
+            n >>= 1;
+        }
+        return reversed;
+    }
+
+    std::vector<Complex> stageTwiddles;     // size - 1 factors, grouped by stage
+    std::vector<int> bitReversalIndices;
+};
+
 //==============================================================================
 // Minimal FFT implementation using Cooley-Tukey algorithm
 class FFT
@@ -30,26 +98,18 @@ public:
     //==============================================================================
     FFT(int size)
         : size_(size)
-        , log2Size_(static_cast<int>(std::log2(size)))
     {
         // Verify size is power of 2
         if (size & (size - 1))
             throw std::invalid_argument("FFT size must be power of 2");
 
-        // Pre-compute twiddle factors
-        twiddleFactors_.resize(size_ / 2);
-        for (int k = 0; k < size_ / 2; ++k)
-        {
-            float phase = -2.0f * std::numbers::pi_v<float> * k / size_;
-            twiddleFactors_[k] = Complex(std::cos(phase), std::sin(phase));
-        }
+        tables_ = breath::SharedTable<FFTTables>::get(0.0, size_);
+        stageTwiddles_ = tables_->stageTwiddles.data();
+        bitReversalIndices_ = tables_->bitReversalIndices.data();
 
-        // Pre-compute bit reversal indices
-        bitReversalIndices_.resize(size_);
-        for (int i = 0; i < size_; ++i)
-        {
-            bitReversalIndices_[i] = reverseBits(i, log2Size_);
-        }
+        // Scratch buffers (no allocation after construction)
+        buffer_.resize(size_);
+        fullSpectrum_.resize(size_);
     }
 
     ~FFT() = default;
@@ -59,20 +119,16 @@ public:
     void forward(const float* input, Complex* output)
     {
         // Convert real input to complex
-        ComplexVector buffer(size_);
         for (int i = 0; i < size_; ++i)
         {
-            buffer[i] = Complex(input[bitReversalIndices_[i]], 0.0f);
+            buffer_[i] = Complex(input[bitReversalIndices_[i]], 0.0f);
         }
 
         // Perform FFT
-        perform(buffer.data());
+        perform(buffer_.data());
 
         // Copy output
-        for (int i = 0; i < size_; ++i)
-        {
-            output[i] = buffer[i];
-        }
+        std::copy(buffer_.begin(), buffer_.end(), output);
     }
 
     //==============================================================================
@@ -80,20 +136,19 @@ public:
     void inverse(const Complex* input, float* output)
     {
         // Copy and conjugate input
-        ComplexVector buffer(size_);
         for (int i = 0; i < size_; ++i)
         {
-            buffer[bitReversalIndices_[i]] = std::conj(input[i]);
+            buffer_[bitReversalIndices_[i]] = std::conj(input[i]);
         }
 
         // Perform FFT
-        perform(buffer.data());
+        perform(buffer_.data());
 
         // Conjugate and scale to get inverse
         float scale = 1.0f / size_;
         for (int i = 0; i < size_; ++i)
         {
-            output[i] = std::real(buffer[i]) * scale;
+            output[i] = std::real(buffer_[i]) * scale;
         }
     }
 
@@ -104,14 +159,13 @@ public:
     void realForward(const float* input, Complex* output)
     {
         // Perform full FFT
-        ComplexVector fullFFT(size_);
-        forward(input, fullFFT.data());
+        forward(input, fullSpectrum_.data());
 
         // Copy only positive frequencies (0 to Nyquist)
         int numBins = size_ / 2 + 1;
         for (int i = 0; i < numBins; ++i)
         {
-            output[i] = fullFFT[i];
+            output[i] = fullSpectrum_[i];
         }
     }
 
@@ -122,75 +176,54 @@ public:
     void realInverse(const Complex* input, float* output)
     {
         // Reconstruct full spectrum (conjugate symmetry for real signals)
-        ComplexVector fullFFT(size_);
-        fullFFT[0] = input[0];  // DC component
-        fullFFT[size_ / 2] = input[size_ / 2];  // Nyquist component
+        fullSpectrum_[0] = input[0];  // DC component
+        fullSpectrum_[size_ / 2] = input[size_ / 2];  // Nyquist component
 
         // Fill positive frequencies
         for (int i = 1; i < size_ / 2; ++i)
         {
-            fullFFT[i] = input[i];
+            fullSpectrum_[i] = input[i];
             // Negative frequencies are conjugates
-            fullFFT[size_ - i] = std::conj(input[i]);
+            fullSpectrum_[size_ - i] = std::conj(input[i]);
         }
 
         // Perform inverse FFT
-        inverse(fullFFT.data(), output);
+        inverse(fullSpectrum_.data(), output);
     }
 
     //==============================================================================
     int getSize() const { return size_; }
     int getNumBins() const { return size_ / 2 + 1; }
 
-private:
-    //==============================================================================
-    void perform(Complex* data)
+    // This FFT and its scratch buffers; the shared tables are not counted
+    size_t getMemoryFootprint() const
     {
-        // Cooley-Tukey FFT algorithm
-        for (int stage = 1; stage <= log2Size_; ++stage)
-        {
-            int m = 1 << stage;  // 2^stage
-            int m2 = m >> 1;     // m/2
-
-            for (int k = 0; k < size_; k += m)
-            {
-                for (int j = 0; j < m2; ++j)
-                {
-                    int evenIndex = k + j;
-                    int oddIndex = k + j + m2;
-
-                    // Get twiddle factor
-                    int twiddleIndex = (j * size_) / m;
-                    Complex twiddle = twiddleFactors_[twiddleIndex];
-
-                    // Butterfly operation
-                    Complex t = twiddle * data[oddIndex];
-                    Complex u = data[evenIndex];
-
-                    data[evenIndex] = u + t;
-                    data[oddIndex] = u - t;
-                }
-            }
-        }
+        return sizeof(*this) + (buffer_.capacity() + fullSpectrum_.capacity()) * sizeof(Complex);
     }
 
+private:
     //==============================================================================
-    int reverseBits(int n, int numBits) const
+    void perform(Complex* data)
     {
-        int reversed = 0;
-        for (int i = 0; i < numBits; ++i)
+        // Cooley-Tukey FFT algorithm, one radix-2 stage per kernel call
+        // (std::complex<float> is layout-compatible with float[2])
+        const auto& kernels = breath::simd::kernels();
+        float* values = reinterpret_cast<float*>(data);
+
+        for (int half = 1; half < size_; half <<= 1)
         {
-            reversed = (reversed << 1) | (n & 1);
-            n >>= 1;
+            const float* twiddles = reinterpret_cast<const float*>(stageTwiddles_ + (half - 1));
+            kernels.fftButterflies(values, twiddles, size_, half);
         }
-        return reversed;
     }
 
     //==============================================================================
     int size_;
-    int log2Size_;
-    ComplexVector twiddleFactors_;
-    std::vector<int> bitReversalIndices_;
+    std::shared_ptr<const FFTTables> tables_;
+    const Complex* stageTwiddles_ = nullptr;    // Into tables_
+    const int* bitReversalIndices_ = nullptr;
+    ComplexVector buffer_;          // In-place work buffer
+    ComplexVector fullSpectrum_;    // Real-FFT spectrum expansion
 };
 
 //==============================================================================
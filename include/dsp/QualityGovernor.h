@@ -0,0 +1,173 @@
+/*
+  QualityGovernor.h - Adaptive DSP quality under CPU pressure
+
+  Times every block against its deadline (numSamples / sampleRate) and
+  steps through fixed quality tiers: down when the smoothed load gets close
+  to the deadline (or blocks keep missing it), back up only after the load has
+  stayed low for a while. The gap between the two thresholds, a minimum
+  dwell after every change and the hold time keep it from hunting.
+
+  Tiers only touch settings that can change without a click:
+  - Control interval: smoothers are re-timed at a tick boundary, so the
+    expression curves keep their shape, just coarser
+  - Voice limit: new notes stay inside the limit; voices above it finish
+    their note and release tail untouched
+  - Ambience: the room's wet level fades out / in over its mix smoother
+
+  The audio thread is the only writer; tier, load and change count can be
+  read from any thread.
+*/
+
+#pragma once
+
+#include "BlockProfiler.h"
+#include "ControlSmoother.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Tiers
+// -----------------------------------------------------------------------------
+enum class QualityTier {
+    Full = 0,
+    Reduced,
+    Low,
+    Minimal
+};
+
+constexpr int kNumQualityTiers = 4;
+
+struct QualitySettings {
+    int controlInterval;    // Samples per control tick
+    int voiceLimit;         // Voices new notes may use
+    bool ambience;          // Room stage on
+};
+
+constexpr QualitySettings kQualitySettings[kNumQualityTiers] = {
+    { kControlInterval,     8, true  },   // Full
+    { kControlInterval * 2, 8, true  },   // Reduced
+    { kControlInterval * 2, 4, false },   // Low
+    { kControlInterval * 4, 2, false },   // Minimal
+};
+
+inline const QualitySettings& quality_settings(QualityTier tier) noexcept {
+    return kQualitySettings[std::clamp(int(tier), 0, kNumQualityTiers - 1)];
+}
+
+inline const char* quality_tier_name(QualityTier tier) noexcept {
+    switch (tier) {
+        case QualityTier::Full:    return "Full";
+        case QualityTier::Reduced: return "Reduced";
+        case QualityTier::Low:     return "Low";
+        case QualityTier::Minimal: return "Minimal";
+    }
+    return "?";
+}
+
+// -----------------------------------------------------------------------------
+// Governor
+// -----------------------------------------------------------------------------
+class QualityGovernor {
+public:
+    // Load = block time / block deadline
+    static constexpr float kDownLoad = 0.8f;        // Smoothed load to step down
+    static constexpr float kUpLoad = 0.45f;         // ...and to step back up
+    static constexpr float kSmoothingSeconds = 0.1f;
+    static constexpr float kDwellSeconds = 0.25f;   // After any change
+    static constexpr float kHoldSeconds = 2.f;      // Below kUpLoad before stepping up
+    static constexpr int kMissesToStep = 2;         // Missed deadlines within...
+    static constexpr float kMissWindowSeconds = 1.f;  // ...this long (one can be the OS)
+
+    // Non-audio thread
+    void prepare(double sampleRate) noexcept {
+        sampleRate_ = sampleRate;
+        smoothedLoad_ = 0.f;
+        sinceChange_ = 0.f;
+        belowUp_ = 0.f;
+        missWindow_ = 0.f;
+        misses_ = 0;
+        tier_.store(int(QualityTier::Full), std::memory_order_relaxed);
+        load_.store(0.f, std::memory_order_relaxed);
+    }
+
+    // Any thread. Disabled pins the Full tier (the next block picks it up).
+    void setEnabled(bool shouldEnable) noexcept { enabled_.store(shouldEnable, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+    // Audio thread
+    int64_t beginBlock() const noexcept { return steady_nanos(); }
+
+    void endBlock(int64_t startNanos, int numSamples) noexcept {
+        if (numSamples <= 0 || sampleRate_ <= 0.0)
+            return;
+
+        const float blockSeconds = float(double(numSamples) / sampleRate_);
+        const float load = float(double(steady_nanos() - startNanos) * 1.0e-9) / blockSeconds;
+
+        smoothedLoad_ += (load - smoothedLoad_) * (1.f - std::exp(-blockSeconds / kSmoothingSeconds));
+        load_.store(smoothedLoad_, std::memory_order_relaxed);
+        sinceChange_ += blockSeconds;
+
+        missWindow_ += blockSeconds;
+        if (missWindow_ >= kMissWindowSeconds) {
+            missWindow_ = 0.f;
+            misses_ = 0;
+        }
+        if (load > 1.f)
+            ++misses_;
+
+        int tier = tier_.load(std::memory_order_relaxed);
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            if (tier != int(QualityTier::Full))
+                changeTier(int(QualityTier::Full));
+            return;
+        }
+
+        if ((misses_ >= kMissesToStep || smoothedLoad_ > kDownLoad) && tier < kNumQualityTiers - 1) {
+            belowUp_ = 0.f;
+            if (sinceChange_ >= kDwellSeconds)
+                changeTier(tier + 1);
+        } else if (smoothedLoad_ < kUpLoad && tier > 0) {
+            belowUp_ += blockSeconds;
+            if (belowUp_ >= kHoldSeconds && sinceChange_ >= kDwellSeconds)
+                changeTier(tier - 1);
+        } else {
+            belowUp_ = 0.f;
+        }
+    }
+
+    // Any thread
+    QualityTier getTier() const noexcept { return QualityTier(tier_.load(std::memory_order_relaxed)); }
+    const QualitySettings& getSettings() const noexcept { return quality_settings(getTier()); }
+    float getLoad() const noexcept { return load_.load(std::memory_order_relaxed); }
+    uint64_t getTierChangeCount() const noexcept { return changes_.load(std::memory_order_relaxed); }
+
+private:
+    void changeTier(int tier) noexcept {
+        tier_.store(tier, std::memory_order_relaxed);
+        changes_.fetch_add(1, std::memory_order_relaxed);
+        sinceChange_ = 0.f;
+        belowUp_ = 0.f;
+        missWindow_ = 0.f;
+        misses_ = 0;
+    }
+
+    double sampleRate_ = 48000.0;
+    float smoothedLoad_ = 0.f;
+    float sinceChange_ = 0.f;       // Seconds of audio
+    float belowUp_ = 0.f;
+    float missWindow_ = 0.f;
+    int misses_ = 0;
+
+    std::atomic<bool> enabled_ { true };
+    std::atomic<int> tier_ { int(QualityTier::Full) };
+    std::atomic<float> load_ { 0.f };
+    std::atomic<uint64_t> changes_ { 0 };
+};
+
+} // namespace breath
@@ -0,0 +1,75 @@
+/*
+  RealtimeGuard.h - Traps allocations and locks on the audio thread
+
+  Render entry points (processBlock, InstrumentDSP::process) open a
+  ScopedRealtimeSection. In builds with BREATHLEAD_RT_CHECKS (CMake option
+  BREATHLEAD_ENABLE_RT_CHECKS) the hooks in src/dsp/RealtimeChecks.cpp
+  watch, while a section is open on the calling thread:
+  - operator new / delete, every form
+  - malloc, calloc, realloc, aligned allocation and free (glibc)
+  - pthread_mutex_lock (glibc): std::mutex, juce::CriticalSection, ...
+
+  The first violation is printed to stderr and aborts, so the debugger or
+  core dump holds the offending stack. set_trapping(false) only counts
+  them (get_violation_count()), e.g. to report at the end of a session.
+
+  Without BREATHLEAD_RT_CHECKS a section is an empty object and nothing
+  is hooked.
+*/
+
+#pragma once
+
+#ifndef BREATHLEAD_RT_CHECKS
+ #define BREATHLEAD_RT_CHECKS 0
+#endif
+
+#include <cstdint>
+
+namespace breath {
+
+#if BREATHLEAD_RT_CHECKS
+
+namespace realtime {
+
+enum class Violation {
+    Allocation = 0,
+    Deallocation,
+    Lock
+};
+
+constexpr int kNumViolations = 3;
+
+// Calling thread only (sections nest)
+void enter_section() noexcept;
+void leave_section() noexcept;
+bool is_in_section() noexcept;
+
+// Any thread
+void set_trapping(bool shouldAbort) noexcept;
+uint64_t get_violation_count(Violation kind) noexcept;
+const char* violation_name(Violation kind) noexcept;
+
+} // namespace realtime
+
+class ScopedRealtimeSection {
+public:
+    ScopedRealtimeSection() noexcept { realtime::enter_section(); }
+    ~ScopedRealtimeSection() { realtime::leave_section(); }
+
+    ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+    ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+};
+
+#else
+
+class ScopedRealtimeSection {
+public:
+    ScopedRealtimeSection() noexcept {}
+
+    ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+    ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+};
+
+#endif
+
+} // namespace breath
@@ -0,0 +1,82 @@
+/*
+  SharedTable.h - Process-wide, reference-counted read-only DSP tables
+
+  Tables that depend only on (sample rate, size) are built once per
+  process and shared by every plugin / engine instance instead of one
+  copy each. SharedTable<T>::get(sampleRate, size) hands out the live
+  table for that key, or builds T(sampleRate, size) if there is none. The
+  table is freed when its last holder lets go; a later get() builds it
+  again.
+
+  get() locks and allocates: call it from constructors / prepare(), never
+  on the audio thread. Concurrent first calls for one key build it once.
+  A table is immutable once built (holders see `const T`), so any number
+  of threads may read it. Tables that do not depend on the sample rate
+  use 0 for it.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace breath {
+
+template <typename T>
+class SharedTable {
+public:
+    static std::shared_ptr<const T> get(double sampleRate, int size) {
+        auto& registry = instance();
+        const std::lock_guard<std::mutex> lock(registry.mutex);
+
+        Entry* reusable = nullptr;
+        for (auto& entry : registry.entries) {
+            if (entry.sampleRate == sampleRate && entry.size == size) {
+                if (auto table = entry.table.lock())
+                    return table;
+                reusable = &entry;
+            } else if (reusable == nullptr && entry.table.expired()) {
+                reusable = &entry;
+            }
+        }
+
+        std::shared_ptr<const T> table = std::make_shared<const T>(sampleRate, size);
+        if (reusable != nullptr)
+            *reusable = { sampleRate, size, table };
+        else
+            registry.entries.push_back({ sampleRate, size, table });
+        return table;
+    }
+
+    // Tables alive right now (diagnostics)
+    static int getNumLive() {
+        auto& registry = instance();
+        const std::lock_guard<std::mutex> lock(registry.mutex);
+
+        int count = 0;
+        for (const auto& entry : registry.entries)
+            if (!entry.table.expired())
+                ++count;
+        return count;
+    }
+
+private:
+    struct Entry {
+        double sampleRate;
+        int size;
+        std::weak_ptr<const T> table;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+};
+
+} // namespace breath
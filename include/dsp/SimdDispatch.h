@@ -0,0 +1,843 @@
+/*
+  SimdDispatch.h - Runtime CPU-feature dispatch for the SIMD kernels
+
+  One binary runs on every render machine: the instruction set is detected
+  on first use and each kernel family is bound to the widest variant the
+  CPU (and OS) supports:
+
+    family          scalar  NEON   SSE2   AVX2   AVX-512
+    noise fill        x      -      x      x      x
+    filter bank 8     x      x      x      x      (AVX2)
+    saturation        x      -      x      x      x
+    FFT butterflies   x      -      x      x      x
+
+  '-' binds the scalar variant; AVX-512 runs the 8-lane filter bank with
+  the AVX2 kernel (one register either way). Wide FFT kernels hand stages
+  narrower than a register down to the next kernel.
+
+  Every variant is bit-identical to the scalar one. Saturation limits with
+  the same rational tanh everywhere (within 4e-7 of std::tanh), and the
+  kernels are compiled without multiply-add contraction, so no variant
+  rounds a step the others round twice. That holds for builds targeting a
+  baseline ISA; with -march=native GCC's vectoriser can still fuse the
+  scalar FFT's complex multiply.
+
+  Override for testing: force_isa(), or BREATHLEAD_SIMD=scalar|neon|sse2|
+  avx2|avx512 in the environment (read on first use). Requests above what
+  the CPU supports fall back to the best supported ISA below them. Switch
+  only while no audio is rendering.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define BREATH_SIMD_X86 1
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #endif
+#elif defined(__ARM_NEON)
+ #define BREATH_SIMD_NEON 1
+ #include <arm_neon.h>
+#endif
+
+// GCC / Clang compile each variant for its own ISA; MSVC needs no flags
+#if defined(BREATH_SIMD_X86) && (!defined(_MSC_VER) || defined(__clang__))
+ #define BREATH_TARGET(isa) __attribute__((target(isa)))
+#else
+ #define BREATH_TARGET(isa)
+#endif
+
+// Every kernel rounds each multiply and add on its own: a fused
+// multiply-add in one variant and not another (GCC contracts across
+// statements, and AVX-512 implies FMA) would break bit-equivalence
+#if defined(__clang__)
+ #pragma float_control(push)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Soft saturation (tape-like)
+// -----------------------------------------------------------------------------
+inline float soft_saturate(float x) noexcept {
+    // Tanh is good, but this is warmer
+    const float ax = std::abs(x);
+    if (ax < 1.f) {
+        return x;
+    } else if (ax < 2.f) {
+        return std::copysign(1.f + (ax - 1.f) * 0.5f, x);
+    } else {
+        return std::copysign(1.5f, x);
+    }
+}
+
+// Rational tanh coefficients (odd 13 / even 6, |error| < 4e-7 on ±7.9)
+namespace tanh_coefs {
+constexpr float a1 = 4.89352455891786e-03f, a3 = 6.37261928875436e-04f;
+constexpr float a5 = 1.48572235717979e-05f, a7 = 5.12229709037114e-08f;
+constexpr float a9 = -8.60467152213735e-11f, a11 = 2.00018790482477e-13f;
+constexpr float a13 = -2.76076847742355e-16f;
+constexpr float b0 = 4.89352518554385e-03f, b2 = 2.26843463243900e-03f;
+constexpr float b4 = 1.18534705686654e-04f, b6 = 1.19825839466702e-06f;
+constexpr float kClamp = 7.90531110763549805f;
+} // namespace tanh_coefs
+
+// Rational tanh, evaluated in the same order as every SIMD variant
+inline float tanh_rational(float x) noexcept {
+    using namespace tanh_coefs;
+    x = std::min(std::max(x, -kClamp), kClamp);
+    const float x2 = x * x;
+
+    float p = a13;
+    p = p * x2 + a11;
+    p = p * x2 + a9;
+    p = p * x2 + a7;
+    p = p * x2 + a5;
+    p = p * x2 + a3;
+    p = p * x2 + a1;
+    p = p * x;
+
+    float q = b6;
+    q = q * x2 + b4;
+    q = q * x2 + b2;
+    q = q * x2 + b0;
+    return p / q;
+}
+
+// Voice output stage: soft saturation (2x drive) → tanh limiter → 0.7 trim
+inline float saturate_sample(float x) noexcept {
+    return tanh_rational(soft_saturate(x * 2.f)) * 0.7f;
+}
+
+namespace simd {
+
+enum class Isa : int { Scalar = 0, Neon, Sse2, Avx2, Avx512 };
+
+struct Kernels {
+    Isa isa;
+
+    // out[i] = next white sample (LCG, ±1), seed advanced by n
+    void (*noiseFill)(uint64_t& seed, float* out, int n) noexcept;
+
+    // 8 one-pole damping filters, then v ← H8 · v / √8
+    //   state ← state + (v - state) · coef ;  v ← state · gain
+    void (*filterBank8)(float* v, float* state, const float* coef, const float* gain) noexcept;
+
+    // x ← saturate_sample(x)
+    void (*saturate)(float* x, int n) noexcept;
+
+    // One radix-2 stage over `size` interleaved complex values; `twiddles`
+    // holds the stage's `half` factors contiguously
+    void (*fftButterflies)(float* data, const float* twiddles, int size, int half) noexcept;
+};
+
+constexpr uint64_t kLcgMul = 6364136223846793005ULL;
+constexpr uint64_t kLcgInc = 1442695040888963407ULL;
+
+// LCG constants for advancing `steps` states at once (lane-parallel noise)
+constexpr uint64_t lcg_jump_mul(int steps) noexcept {
+    uint64_t m = 1;
+    for (int i = 0; i < steps; ++i) m *= kLcgMul;
+    return m;
+}
+
+constexpr uint64_t lcg_jump_inc(int steps) noexcept {
+    uint64_t c = 0;
+    for (int i = 0; i < steps; ++i) c = c * kLcgMul + kLcgInc;
+    return c;
+}
+
+// =============================================================================
+// Scalar (reference)
+// =============================================================================
+inline float lcg_white(uint64_t& seed) noexcept {
+    seed = seed * kLcgMul + kLcgInc;
+    return float((seed >> 32) & 0xFFFFFF) / 16777216.f * 2.f - 1.f;
+}
+
+inline void noise_fill_scalar(uint64_t& seed, float* out, int n) noexcept {
+    for (int i = 0; i < n; ++i)
+        out[i] = lcg_white(seed);
+}
+
+inline void filter_bank8_scalar(float* v, float* state, const float* coef, const float* gain) noexcept {
+    constexpr float kNorm = 0.35355339f;
+
+    for (int i = 0; i < 8; ++i) {
+        state[i] += (v[i] - state[i]) * coef[i];
+        v[i] = state[i] * gain[i];
+    }
+
+    // Fast Walsh-Hadamard: strides 4, 2, 1
+    for (int stride = 4; stride > 0; stride >>= 1) {
+        for (int i = 0; i < 8; i += stride * 2) {
+            for (int j = i; j < i + stride; ++j) {
+                const float x = v[j], y = v[j + stride];
+                v[j] = x + y;
+                v[j + stride] = x - y;
+            }
+        }
+    }
+    for (int i = 0; i < 8; ++i)
+        v[i] *= kNorm;
+}
+
+inline void saturate_scalar(float* x, int n) noexcept {
+    for (int i = 0; i < n; ++i)
+        x[i] = saturate_sample(x[i]);
+}
+
+inline void fft_butterflies_scalar(float* data, const float* twiddles, int size, int half) noexcept {
+    for (int k = 0; k < size; k += 2 * half) {
+        float* even = data + 2 * k;
+        float* odd = even + 2 * half;
+        for (int j = 0; j < half; ++j) {
+            const float wr = twiddles[2 * j], wi = twiddles[2 * j + 1];
+            const float or_ = odd[2 * j], oi = odd[2 * j + 1];
+            const float tr = wr * or_ - wi * oi;
+            const float ti = wr * oi + wi * or_;
+            const float ur = even[2 * j], ui = even[2 * j + 1];
+            even[2 * j] = ur + tr;
+            even[2 * j + 1] = ui + ti;
+            odd[2 * j] = ur - tr;
+            odd[2 * j + 1] = ui - ti;
+        }
+    }
+}
+
+// =============================================================================
+// NEON (filter bank only)
+// =============================================================================
+#if defined(BREATH_SIMD_NEON)
+inline void filter_bank8_neon(float* v, float* state, const float* coef, const float* gain) noexcept {
+    constexpr float kNorm = 0.35355339f;
+
+    for (int i = 0; i < 8; i += 4) {
+        float32x4_t s = vld1q_f32(state + i);
+        s = vmlaq_f32(s, vsubq_f32(vld1q_f32(v + i), s), vld1q_f32(coef + i));
+        vst1q_f32(state + i, s);
+        vst1q_f32(v + i, vmulq_f32(s, vld1q_f32(gain + i)));
+    }
+
+    float32x4_t a = vld1q_f32(v);
+    float32x4_t b = vld1q_f32(v + 4);
+
+    float32x4_t t = vaddq_f32(a, b);
+    b = vsubq_f32(a, b);
+    a = t;
+
+    const float s2v[4] = { 1.f, 1.f, -1.f, -1.f };
+    const float s1v[4] = { 1.f, -1.f, 1.f, -1.f };
+    const float32x4_t s2 = vld1q_f32(s2v);
+    const float32x4_t s1 = vld1q_f32(s1v);
+
+    a = vmlaq_f32(vextq_f32(a, a, 2), a, s2);
+    b = vmlaq_f32(vextq_f32(b, b, 2), b, s2);
+
+    a = vmlaq_f32(vrev64q_f32(a), a, s1);
+    b = vmlaq_f32(vrev64q_f32(b), b, s1);
+
+    vst1q_f32(v, vmulq_n_f32(a, kNorm));
+    vst1q_f32(v + 4, vmulq_n_f32(b, kNorm));
+}
+#endif
+
+#if defined(BREATH_SIMD_X86)
+// =============================================================================
+// SSE2
+// =============================================================================
+
+// Low 64 bits of x · m per lane (SSE2 has only 32x32 → 64 multiplies)
+BREATH_TARGET("sse2")
+inline __m128i mullo64_sse2(__m128i x, __m128i mLo, __m128i mHi) noexcept {
+    const __m128i lo = _mm_mul_epu32(x, mLo);
+    const __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), mLo),
+                                        _mm_mul_epu32(x, mHi));
+    return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+}
+
+// Two 2-lane states → four white samples
+BREATH_TARGET("sse2")
+inline __m128 lcg_to_float_sse2(__m128i a, __m128i b) noexcept {
+    const __m128i mask = _mm_set1_epi64x(0xFFFFFF);
+    a = _mm_and_si128(_mm_srli_epi64(a, 32), mask);
+    b = _mm_and_si128(_mm_srli_epi64(b, 32), mask);
+    const __m128i packed = _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0)),
+                                              _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(packed), _mm_set1_ps(1.f / 16777216.f));
+    return _mm_sub_ps(_mm_mul_ps(scaled, _mm_set1_ps(2.f)), _mm_set1_ps(1.f));
+}
+
+BREATH_TARGET("sse2")
+inline void noise_fill_sse2(uint64_t& seed, float* out, int n) noexcept {
+    constexpr uint64_t kMul = lcg_jump_mul(4), kInc = lcg_jump_inc(4);
+    int i = 0;
+
+    if (n >= 4) {
+        uint64_t s[4];
+        s[0] = seed * kLcgMul + kLcgInc;
+        for (int l = 1; l < 4; ++l)
+            s[l] = s[l - 1] * kLcgMul + kLcgInc;
+
+        __m128i a = _mm_set_epi64x(int64_t(s[1]), int64_t(s[0]));
+        __m128i b = _mm_set_epi64x(int64_t(s[3]), int64_t(s[2]));
+        const __m128i mLo = _mm_set1_epi64x(int64_t(kMul & 0xFFFFFFFF));
+        const __m128i mHi = _mm_set1_epi64x(int64_t(kMul >> 32));
+        const __m128i inc = _mm_set1_epi64x(int64_t(kInc));
+
+        for (;;) {
+            _mm_storeu_ps(out + i, lcg_to_float_sse2(a, b));
+            i += 4;
+            if (i + 4 > n)
+                break;
+            a = _mm_add_epi64(mullo64_sse2(a, mLo, mHi), inc);
+            b = _mm_add_epi64(mullo64_sse2(b, mLo, mHi), inc);
+        }
+
+        alignas(16) uint64_t last[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(last), b);
+        seed = last[1];
+    }
+
+    for (; i < n; ++i)
+        out[i] = lcg_white(seed);
+}
+
+BREATH_TARGET("sse2")
+inline void filter_bank8_sse2(float* v, float* state, const float* coef, const float* gain) noexcept {
+    for (int i = 0; i < 8; i += 4) {
+        __m128 s = _mm_loadu_ps(state + i);
+        s = _mm_add_ps(s, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(v + i), s), _mm_loadu_ps(coef + i)));
+        _mm_storeu_ps(state + i, s);
+        _mm_storeu_ps(v + i, _mm_mul_ps(s, _mm_loadu_ps(gain + i)));
+    }
+
+    __m128 a = _mm_loadu_ps(v);
+    __m128 b = _mm_loadu_ps(v + 4);
+
+    __m128 t = _mm_add_ps(a, b);
+    b = _mm_sub_ps(a, b);
+    a = t;
+
+    // Stride 2: swap halves, then add / subtract
+    const __m128 s2 = _mm_setr_ps(1.f, 1.f, -1.f, -1.f);
+    a = _mm_add_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)), _mm_mul_ps(a, s2));
+    b = _mm_add_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), _mm_mul_ps(b, s2));
+
+    // Stride 1: swap pairs, then add / subtract
+    const __m128 s1 = _mm_setr_ps(1.f, -1.f, 1.f, -1.f);
+    a = _mm_add_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_mul_ps(a, s1));
+    b = _mm_add_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_mul_ps(b, s1));
+
+    const __m128 norm = _mm_set1_ps(0.35355339f);
+    _mm_storeu_ps(v, _mm_mul_ps(a, norm));
+    _mm_storeu_ps(v + 4, _mm_mul_ps(b, norm));
+}
+
+BREATH_TARGET("sse2")
+inline __m128 tanh_sse2(__m128 x) noexcept {
+    using namespace tanh_coefs;
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-kClamp)), _mm_set1_ps(kClamp));
+    const __m128 x2 = _mm_mul_ps(x, x);
+
+    __m128 p = _mm_set1_ps(a13);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a11));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a9));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a3));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a1));
+    p = _mm_mul_ps(p, x);
+
+    __m128 q = _mm_set1_ps(b6);
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(b4));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(b2));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(b0));
+    return _mm_div_ps(p, q);
+}
+
+BREATH_TARGET("sse2")
+inline void saturate_sse2(float* x, int n) noexcept {
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    const __m128 one = _mm_set1_ps(1.f);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(x + i), _mm_set1_ps(2.f));
+        const __m128 ax = _mm_andnot_ps(signMask, v);
+        const __m128 knee = _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_min_ps(ax, _mm_set1_ps(2.f)), one),
+                                                       _mm_set1_ps(0.5f)));
+        const __m128 below = _mm_cmplt_ps(ax, one);
+        const __m128 mag = _mm_or_ps(_mm_and_ps(below, ax), _mm_andnot_ps(below, knee));
+        const __m128 soft = _mm_or_ps(mag, _mm_and_ps(signMask, v));
+        _mm_storeu_ps(x + i, _mm_mul_ps(tanh_sse2(soft), _mm_set1_ps(0.7f)));
+    }
+
+    for (; i < n; ++i)
+        x[i] = saturate_sample(x[i]);
+}
+
+BREATH_TARGET("sse2")
+inline void fft_butterflies_sse2(float* data, const float* twiddles, int size, int half) noexcept {
+    if (half < 2) {
+        fft_butterflies_scalar(data, twiddles, size, half);
+        return;
+    }
+
+    const __m128 negEven = _mm_setr_ps(-0.f, 0.f, -0.f, 0.f);
+    for (int k = 0; k < size; k += 2 * half) {
+        float* even = data + 2 * k;
+        float* odd = even + 2 * half;
+        for (int j = 0; j < half; j += 2) {
+            const __m128 w = _mm_loadu_ps(twiddles + 2 * j);
+            const __m128 o = _mm_loadu_ps(odd + 2 * j);
+            const __m128 u = _mm_loadu_ps(even + 2 * j);
+
+            // (or·wr - oi·wi, oi·wr + or·wi)
+            const __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+            const __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+            const __m128 swapped = _mm_shuffle_ps(o, o, _MM_SHUFFLE(2, 3, 0, 1));
+            const __m128 t = _mm_add_ps(_mm_mul_ps(o, wr), _mm_xor_ps(_mm_mul_ps(swapped, wi), negEven));
+
+            _mm_storeu_ps(even + 2 * j, _mm_add_ps(u, t));
+            _mm_storeu_ps(odd + 2 * j, _mm_sub_ps(u, t));
+        }
+    }
+}
+
+// =============================================================================
+// AVX2
+// =============================================================================
+BREATH_TARGET("avx2")
+inline __m256i mullo64_avx2(__m256i x, __m256i mLo, __m256i mHi) noexcept {
+    const __m256i lo = _mm256_mul_epu32(x, mLo);
+    const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), mLo),
+                                           _mm256_mul_epu32(x, mHi));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+BREATH_TARGET("avx2")
+inline __m256 lcg_to_float_avx2(__m256i a, __m256i b) noexcept {
+    const __m256i mask = _mm256_set1_epi64x(0xFFFFFF);
+    const __m256i evens = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    a = _mm256_permutevar8x32_epi32(_mm256_and_si256(_mm256_srli_epi64(a, 32), mask), evens);
+    b = _mm256_permutevar8x32_epi32(_mm256_and_si256(_mm256_srli_epi64(b, 32), mask), evens);
+    const __m256i packed = _mm256_permute2x128_si256(a, b, 0x20);
+    const __m256 scaled = _mm256_mul_ps(_mm256_cvtepi32_ps(packed), _mm256_set1_ps(1.f / 16777216.f));
+    return _mm256_sub_ps(_mm256_mul_ps(scaled, _mm256_set1_ps(2.f)), _mm256_set1_ps(1.f));
+}
+
+BREATH_TARGET("avx2")
+inline void noise_fill_avx2(uint64_t& seed, float* out, int n) noexcept {
+    constexpr uint64_t kMul = lcg_jump_mul(8), kInc = lcg_jump_inc(8);
+    int i = 0;
+
+    if (n >= 8) {
+        alignas(32) uint64_t s[8];
+        s[0] = seed * kLcgMul + kLcgInc;
+        for (int l = 1; l < 8; ++l)
+            s[l] = s[l - 1] * kLcgMul + kLcgInc;
+
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(s + 4));
+        const __m256i mLo = _mm256_set1_epi64x(int64_t(kMul & 0xFFFFFFFF));
+        const __m256i mHi = _mm256_set1_epi64x(int64_t(kMul >> 32));
+        const __m256i inc = _mm256_set1_epi64x(int64_t(kInc));
+
+        for (;;) {
+            _mm256_storeu_ps(out + i, lcg_to_float_avx2(a, b));
+            i += 8;
+            if (i + 8 > n)
+                break;
+            a = _mm256_add_epi64(mullo64_avx2(a, mLo, mHi), inc);
+            b = _mm256_add_epi64(mullo64_avx2(b, mLo, mHi), inc);
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(s + 4), b);
+        seed = s[7];
+    }
+
+    for (; i < n; ++i)
+        out[i] = lcg_white(seed);
+}
+
+BREATH_TARGET("avx2")
+inline void filter_bank8_avx2(float* v, float* state, const float* coef, const float* gain) noexcept {
+    __m256 s = _mm256_loadu_ps(state);
+    s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(v), s), _mm256_loadu_ps(coef)));
+    _mm256_storeu_ps(state, s);
+    __m256 x = _mm256_mul_ps(s, _mm256_loadu_ps(gain));
+
+    // Stride 4: swap 128-bit halves; strides 2 and 1 within each half
+    const __m256 s4 = _mm256_setr_ps(1.f, 1.f, 1.f, 1.f, -1.f, -1.f, -1.f, -1.f);
+    const __m256 s2 = _mm256_setr_ps(1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f);
+    const __m256 s1 = _mm256_setr_ps(1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f);
+    x = _mm256_add_ps(_mm256_permute2f128_ps(x, x, 0x01), _mm256_mul_ps(x, s4));
+    x = _mm256_add_ps(_mm256_permute_ps(x, _MM_SHUFFLE(1, 0, 3, 2)), _mm256_mul_ps(x, s2));
+    x = _mm256_add_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_mul_ps(x, s1));
+
+    _mm256_storeu_ps(v, _mm256_mul_ps(x, _mm256_set1_ps(0.35355339f)));
+}
+
+BREATH_TARGET("avx2")
+inline __m256 tanh_avx2(__m256 x) noexcept {
+    using namespace tanh_coefs;
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-kClamp)), _mm256_set1_ps(kClamp));
+    const __m256 x2 = _mm256_mul_ps(x, x);
+
+    __m256 p = _mm256_set1_ps(a13);
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a11));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a9));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a1));
+    p = _mm256_mul_ps(p, x);
+
+    __m256 q = _mm256_set1_ps(b6);
+    q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(b4));
+    q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(b2));
+    q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(b0));
+    return _mm256_div_ps(p, q);
+}
+
+BREATH_TARGET("avx2")
+inline void saturate_avx2(float* x, int n) noexcept {
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    const __m256 one = _mm256_set1_ps(1.f);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_set1_ps(2.f));
+        const __m256 ax = _mm256_andnot_ps(signMask, v);
+        const __m256 knee = _mm256_add_ps(one, _mm256_mul_ps(_mm256_sub_ps(_mm256_min_ps(ax, _mm256_set1_ps(2.f)), one),
+                                                             _mm256_set1_ps(0.5f)));
+        const __m256 mag = _mm256_blendv_ps(knee, ax, _mm256_cmp_ps(ax, one, _CMP_LT_OQ));
+        const __m256 soft = _mm256_or_ps(mag, _mm256_and_ps(signMask, v));
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(tanh_avx2(soft), _mm256_set1_ps(0.7f)));
+    }
+
+    if (i < n)
+        saturate_sse2(x + i, n - i);
+}
+
+BREATH_TARGET("avx2")
+inline void fft_butterflies_avx2(float* data, const float* twiddles, int size, int half) noexcept {
+    if (half < 4) {
+        fft_butterflies_sse2(data, twiddles, size, half);
+        return;
+    }
+
+    for (int k = 0; k < size; k += 2 * half) {
+        float* even = data + 2 * k;
+        float* odd = even + 2 * half;
+        for (int j = 0; j < half; j += 4) {
+            const __m256 w = _mm256_loadu_ps(twiddles + 2 * j);
+            const __m256 o = _mm256_loadu_ps(odd + 2 * j);
+            const __m256 u = _mm256_loadu_ps(even + 2 * j);
+
+            const __m256 swapped = _mm256_permute_ps(o, _MM_SHUFFLE(2, 3, 0, 1));
+            const __m256 t = _mm256_addsub_ps(_mm256_mul_ps(o, _mm256_moveldup_ps(w)),
+                                              _mm256_mul_ps(swapped, _mm256_movehdup_ps(w)));
+
+            _mm256_storeu_ps(even + 2 * j, _mm256_add_ps(u, t));
+            _mm256_storeu_ps(odd + 2 * j, _mm256_sub_ps(u, t));
+        }
+    }
+}
+
+// =============================================================================
+// AVX-512 (F only)
+// =============================================================================
+#if defined(__GNUC__) && !defined(__clang__)
+ // GCC 12's avx512fintrin.h trips this on its own _mm512_undefined_*()
+ #pragma GCC diagnostic push
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+BREATH_TARGET("avx512f")
+inline __m512i mullo64_avx512(__m512i x, __m512i mLo, __m512i mHi) noexcept {
+    const __m512i lo = _mm512_mul_epu32(x, mLo);
+    const __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(x, 32), mLo),
+                                           _mm512_mul_epu32(x, mHi));
+    return _mm512_add_epi64(lo, _mm512_slli_epi64(cross, 32));
+}
+
+BREATH_TARGET("avx512f")
+inline __m512 lcg_to_float_avx512(__m512i a, __m512i b) noexcept {
+    const __m512i mask = _mm512_set1_epi64(0xFFFFFF);
+    const __m256i lo = _mm512_cvtepi64_epi32(_mm512_and_si512(_mm512_srli_epi64(a, 32), mask));
+    const __m256i hi = _mm512_cvtepi64_epi32(_mm512_and_si512(_mm512_srli_epi64(b, 32), mask));
+    const __m512i packed = _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+    const __m512 scaled = _mm512_mul_ps(_mm512_cvtepi32_ps(packed), _mm512_set1_ps(1.f / 16777216.f));
+    return _mm512_sub_ps(_mm512_mul_ps(scaled, _mm512_set1_ps(2.f)), _mm512_set1_ps(1.f));
+}
+
+BREATH_TARGET("avx512f")
+inline void noise_fill_avx512(uint64_t& seed, float* out, int n) noexcept {
+    constexpr uint64_t kMul = lcg_jump_mul(16), kInc = lcg_jump_inc(16);
+    int i = 0;
+
+    if (n >= 16) {
+        alignas(64) uint64_t s[16];
+        s[0] = seed * kLcgMul + kLcgInc;
+        for (int l = 1; l < 16; ++l)
+            s[l] = s[l - 1] * kLcgMul + kLcgInc;
+
+        __m512i a = _mm512_load_si512(s);
+        __m512i b = _mm512_load_si512(s + 8);
+        const __m512i mLo = _mm512_set1_epi64(int64_t(kMul & 0xFFFFFFFF));
+        const __m512i mHi = _mm512_set1_epi64(int64_t(kMul >> 32));
+        const __m512i inc = _mm512_set1_epi64(int64_t(kInc));
+
+        for (;;) {
+            _mm512_storeu_ps(out + i, lcg_to_float_avx512(a, b));
+            i += 16;
+            if (i + 16 > n)
+                break;
+            a = _mm512_add_epi64(mullo64_avx512(a, mLo, mHi), inc);
+            b = _mm512_add_epi64(mullo64_avx512(b, mLo, mHi), inc);
+        }
+
+        _mm512_store_si512(s + 8, b);
+        seed = s[15];
+    }
+
+    if (i < n)
+        noise_fill_avx2(seed, out + i, n - i);
+}
+
+BREATH_TARGET("avx512f")
+inline __m512 tanh_avx512(__m512 x) noexcept {
+    using namespace tanh_coefs;
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-kClamp)), _mm512_set1_ps(kClamp));
+    const __m512 x2 = _mm512_mul_ps(x, x);
+
+    __m512 p = _mm512_set1_ps(a13);
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a11));
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a9));
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a7));
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a5));
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a3));
+    p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(a1));
+    p = _mm512_mul_ps(p, x);
+
+    __m512 q = _mm512_set1_ps(b6);
+    q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(b4));
+    q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(b2));
+    q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(b0));
+    return _mm512_div_ps(p, q);
+}
+
+BREATH_TARGET("avx512f")
+inline void saturate_avx512(float* x, int n) noexcept {
+    const __m512i absMask = _mm512_set1_epi32(0x7FFFFFFF);
+    const __m512 one = _mm512_set1_ps(1.f);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_mul_ps(_mm512_loadu_ps(x + i), _mm512_set1_ps(2.f));
+        const __m512i bits = _mm512_castps_si512(v);
+        const __m512 ax = _mm512_castsi512_ps(_mm512_and_si512(bits, absMask));
+        const __m512 knee = _mm512_add_ps(one, _mm512_mul_ps(_mm512_sub_ps(_mm512_min_ps(ax, _mm512_set1_ps(2.f)), one),
+                                                             _mm512_set1_ps(0.5f)));
+        const __m512 mag = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(ax, one, _CMP_LT_OQ), knee, ax);
+        const __m512 soft = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(mag),
+                                                                _mm512_andnot_si512(absMask, bits)));
+        _mm512_storeu_ps(x + i, _mm512_mul_ps(tanh_avx512(soft), _mm512_set1_ps(0.7f)));
+    }
+
+    if (i < n)
+        saturate_avx2(x + i, n - i);
+}
+
+BREATH_TARGET("avx512f")
+inline void fft_butterflies_avx512(float* data, const float* twiddles, int size, int half) noexcept {
+    if (half < 8) {
+        fft_butterflies_avx2(data, twiddles, size, half);
+        return;
+    }
+
+    for (int k = 0; k < size; k += 2 * half) {
+        float* even = data + 2 * k;
+        float* odd = even + 2 * half;
+        for (int j = 0; j < half; j += 8) {
+            const __m512 w = _mm512_loadu_ps(twiddles + 2 * j);
+            const __m512 o = _mm512_loadu_ps(odd + 2 * j);
+            const __m512 u = _mm512_loadu_ps(even + 2 * j);
+
+            // No addsub: subtract in the real lanes, add in the imaginary
+            const __m512 wr = _mm512_permute_ps(w, _MM_SHUFFLE(2, 2, 0, 0));
+            const __m512 wi = _mm512_permute_ps(w, _MM_SHUFFLE(3, 3, 1, 1));
+            const __m512 t1 = _mm512_mul_ps(o, wr);
+            const __m512 t2 = _mm512_mul_ps(_mm512_permute_ps(o, _MM_SHUFFLE(2, 3, 0, 1)), wi);
+            const __m512 t = _mm512_mask_sub_ps(_mm512_add_ps(t1, t2), __mmask16(0x5555), t1, t2);
+
+            _mm512_storeu_ps(even + 2 * j, _mm512_add_ps(u, t));
+            _mm512_storeu_ps(odd + 2 * j, _mm512_sub_ps(u, t));
+        }
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+ #pragma GCC diagnostic pop
+#endif
+#endif // BREATH_SIMD_X86
+
+#if defined(__clang__)
+ #pragma float_control(pop)
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+// =============================================================================
+// Kernel tables and binding
+// =============================================================================
+inline constexpr Kernels kScalarKernels {
+    Isa::Scalar, noise_fill_scalar, filter_bank8_scalar, saturate_scalar, fft_butterflies_scalar
+};
+
+#if defined(BREATH_SIMD_NEON)
+inline constexpr Kernels kNeonKernels {
+    Isa::Neon, noise_fill_scalar, filter_bank8_neon, saturate_scalar, fft_butterflies_scalar
+};
+#endif
+
+#if defined(BREATH_SIMD_X86)
+inline constexpr Kernels kSse2Kernels {
+    Isa::Sse2, noise_fill_sse2, filter_bank8_sse2, saturate_sse2, fft_butterflies_sse2
+};
+inline constexpr Kernels kAvx2Kernels {
+    Isa::Avx2, noise_fill_avx2, filter_bank8_avx2, saturate_avx2, fft_butterflies_avx2
+};
+inline constexpr Kernels kAvx512Kernels {
+    Isa::Avx512, noise_fill_avx512, filter_bank8_avx2, saturate_avx512, fft_butterflies_avx512
+};
+#endif
+
+inline const char* isa_name(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::Neon:   return "neon";
+        case Isa::Sse2:   return "sse2";
+        case Isa::Avx2:   return "avx2";
+        case Isa::Avx512: return "avx512";
+        default:          return "scalar";
+    }
+}
+
+// Widest ISA this CPU and OS can run
+inline Isa detect_isa() noexcept {
+#if defined(BREATH_SIMD_X86)
+ #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] >> 26) & 1;
+    const bool avx = (info[2] >> 28) & 1;
+    const bool osxsave = (info[2] >> 27) & 1;
+
+    // YMM / ZMM state enabled by the OS
+    const uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymm = (xcr0 & 0x06) == 0x06;
+    const bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false, avx512 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = avx && ymm && ((info[1] >> 5) & 1);
+        avx512 = avx2 && zmm && ((info[1] >> 16) & 1);
+    }
+ #else
+    __builtin_cpu_init();
+    const bool sse2 = __builtin_cpu_supports("sse2");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool avx512 = avx2 && __builtin_cpu_supports("avx512f");
+ #endif
+    return avx512 ? Isa::Avx512 : avx2 ? Isa::Avx2 : sse2 ? Isa::Sse2 : Isa::Scalar;
+#elif defined(BREATH_SIMD_NEON)
+    return Isa::Neon;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+inline bool is_supported(Isa isa) noexcept {
+    if (isa == Isa::Scalar)
+        return true;
+#if defined(BREATH_SIMD_X86)
+    return isa != Isa::Neon && int(isa) <= int(detect_isa());
+#elif defined(BREATH_SIMD_NEON)
+    return isa == Isa::Neon;
+#else
+    return false;
+#endif
+}
+
+inline const Kernels& kernels_for(Isa isa) noexcept {
+    switch (isa) {
+#if defined(BREATH_SIMD_NEON)
+        case Isa::Neon:   return kNeonKernels;
+#endif
+#if defined(BREATH_SIMD_X86)
+        case Isa::Sse2:   return kSse2Kernels;
+        case Isa::Avx2:   return kAvx2Kernels;
+        case Isa::Avx512: return kAvx512Kernels;
+#endif
+        default:          return kScalarKernels;
+    }
+}
+
+namespace detail {
+inline std::atomic<const Kernels*> boundKernels { nullptr };
+
+// BREATHLEAD_SIMD=<name> caps the detected ISA
+inline Isa requested_isa() noexcept {
+    const Isa detected = detect_isa();
+    const char* env = std::getenv("BREATHLEAD_SIMD");
+    if (env == nullptr)
+        return detected;
+
+    for (int i = 0; i <= int(Isa::Avx512); ++i)
+        if (std::strcmp(env, isa_name(Isa(i))) == 0)
+            return Isa(i);
+    return detected;
+}
+} // namespace detail
+
+// Binds the best supported ISA at or below `isa`; returns what was bound
+inline Isa force_isa(Isa isa) noexcept {
+    int i = int(isa);
+    while (i > 0 && !is_supported(Isa(i)))
+        --i;
+    detail::boundKernels.store(&kernels_for(Isa(i)), std::memory_order_release);
+    return Isa(i);
+}
+
+// Kernel table in use (binds on first call)
+inline const Kernels& kernels() noexcept {
+    const Kernels* bound = detail::boundKernels.load(std::memory_order_acquire);
+    if (bound == nullptr) {
+        force_isa(detail::requested_isa());
+        bound = detail::boundKernels.load(std::memory_order_acquire);
+    }
+    return *bound;
+}
+
+inline Isa active_isa() noexcept { return kernels().isa; }
+
+} // namespace simd
+} // namespace breath
@@ -0,0 +1,129 @@
+/*
+  VoicePipeline.h - Compile-time composition of voice stages
+
+  A voice's host-rate path is a list of stage types run in order:
+
+    using Shaper = VoicePipeline<float, Resonator, EnvelopeGain, SpectralTilt, Resistance>;
+
+  Each stage is a class template over the sample type (float for realtime,
+  double for double-precision hosts and bounces). The pipeline holds the
+  stages by value and calls them through a fold expression: no virtual
+  calls, no per-stage branches, and a stage that is left out of the list
+  (or wrapped in Enable<false, Stage>) does not exist in the build.
+
+  A stage derives from StageDefaults and hides what it needs:
+
+    T process(T x, VoiceFrame& frame)        every sample (required)
+    static size_t arenaBytes(double sr)      delay memory it carves
+    void prepare(double sr, DspArena&)       reset + carve (off the audio thread)
+    void start()                             a note starts on a silent voice
+    void saveState / restoreState            checkpoint (DspCheckpoint.h)
+
+  VoiceFrame carries the per-sample context the voice computed at the slow
+  rate (excitation, envelope, pitch) and its parameters. Stages may leave
+  notes for later ones in it (envelopeApplied).
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "DspArena.h"
+#include "DspCheckpoint.h"
+#include "WaveguideBore.h"
+
+namespace breath {
+
+// -----------------------------------------------------------------------------
+// Per-sample context handed down the pipeline
+// -----------------------------------------------------------------------------
+struct VoiceFrame {
+    // Slow stages at host rate
+    float excite = 0.f;
+    float env = 0.f;
+    float pitch = 440.f;
+
+    // Voice parameters
+    float sampleRate = 48000.f;
+    float tone = 0.5f;
+    float formant = 0.5f;
+    float resistance = 0.5f;
+    ResonanceEngine engine = ResonanceEngine::Formant;
+
+    // Set by a stage that already applied the envelope (bore pressure)
+    bool envelopeApplied = false;
+};
+
+// -----------------------------------------------------------------------------
+// Stage defaults (hidden by the stages that need them)
+// -----------------------------------------------------------------------------
+struct StageDefaults {
+    static size_t arenaBytes(double) noexcept { return 0; }
+    void prepare(double, DspArena&) noexcept {}
+    void start() noexcept {}
+    void saveState(CheckpointWriter&) const noexcept {}
+    bool restoreState(CheckpointReader&) noexcept { return true; }
+};
+
+// Passes the signal through; what a disabled stage becomes
+template <typename T>
+struct Bypass : StageDefaults {
+    T process(T x, VoiceFrame&) noexcept { return x; }
+};
+
+// Enable<kWithTilt, SpectralTilt>::type: the stage, or Bypass
+template <bool Enabled, template <typename> class Stage>
+struct Enable {
+    template <typename T>
+    using type = std::conditional_t<Enabled, Stage<T>, Bypass<T>>;
+};
+
+// -----------------------------------------------------------------------------
+// Pipeline
+// -----------------------------------------------------------------------------
+template <typename T, template <typename> class... Stages>
+class VoicePipeline {
+public:
+    using Sample = T;
+
+    static constexpr int kNumStages = int(sizeof...(Stages));
+
+    static size_t arenaBytes(double sr) noexcept {
+        return (size_t(0) + ... + Stages<T>::arenaBytes(sr));
+    }
+
+    void prepare(double sr, DspArena& arena) noexcept {
+        std::apply([&](auto&... stage) { (stage.prepare(sr, arena), ...); }, stages_);
+    }
+
+    void start() noexcept {
+        std::apply([](auto&... stage) { (stage.start(), ...); }, stages_);
+    }
+
+    T process(T x, VoiceFrame& frame) noexcept {
+        std::apply([&](auto&... stage) { ((x = stage.process(x, frame)), ...); }, stages_);
+        return x;
+    }
+
+    void saveState(CheckpointWriter& w) const noexcept {
+        std::apply([&](const auto&... stage) { (stage.saveState(w), ...); }, stages_);
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        return std::apply([&](auto&... stage) { return (stage.restoreState(r) && ...); }, stages_);
+    }
+
+    // The stage of this type (must appear once)
+    template <template <typename> class Stage>
+    Stage<T>& get() noexcept { return std::get<Stage<T>>(stages_); }
+
+    template <template <typename> class Stage>
+    const Stage<T>& get() const noexcept { return std::get<Stage<T>>(stages_); }
+
+private:
+    std::tuple<Stages<T>...> stages_;
+};
+
+} // namespace breath
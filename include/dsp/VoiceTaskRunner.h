@@ -0,0 +1,83 @@
+/*
+  VoiceTaskRunner.h - Hook for rendering voices on a host thread pool
+
+  BreathLeadSynth hands its voices to a runner as independent tasks, one
+  per sounding voice, and mixes the results itself in slot order. Output
+  is therefore bit-identical whether the tasks run serially or spread over
+  threads. The runner only has to run task(context, 0..count-1), each
+  exactly once, on any threads, and return once all of them finished.
+
+  Worker threads may have a different floating-point mode than the audio
+  thread (flush-to-zero, rounding). Tasks run under the caller's mode
+  (capture_fp_state() / ScopedFpState) so the result cannot depend on
+  which thread rendered a voice.
+
+  Without a runner (or when run() declines) voices render serially on the
+  calling thread. The plugin has none in any format; embedders pass one
+  through BreathLeadDSP::setVoiceTaskRunner().
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+ #include <xmmintrin.h>
+ #define BREATH_FP_STATE_MXCSR 1
+#endif
+
+namespace breath {
+
+class VoiceTaskRunner {
+public:
+    using Task = void (*)(void* context, int index) noexcept;
+
+    virtual ~VoiceTaskRunner() = default;
+
+    // Audio thread. Runs all `count` tasks and returns true, or runs none
+    // and returns false (the caller then renders serially).
+    virtual bool run(Task task, void* context, int count) noexcept = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Floating-point mode of the calling thread (MXCSR / FPCR)
+// -----------------------------------------------------------------------------
+struct FpState {
+    uint64_t bits = 0;
+};
+
+inline FpState capture_fp_state() noexcept {
+#if BREATH_FP_STATE_MXCSR
+    return { _mm_getcsr() };
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, fpcr" : "=r"(v));
+    return { v };
+#else
+    return {};
+#endif
+}
+
+inline void apply_fp_state(FpState state) noexcept {
+#if BREATH_FP_STATE_MXCSR
+    _mm_setcsr(uint32_t(state.bits));
+#elif defined(__aarch64__)
+    asm volatile("msr fpcr, %0" : : "r"(state.bits));
+#else
+    (void)state;
+#endif
+}
+
+class ScopedFpState {
+public:
+    explicit ScopedFpState(FpState state) noexcept : saved_(capture_fp_state()) { apply_fp_state(state); }
+    ~ScopedFpState() { apply_fp_state(saved_); }
+
+    ScopedFpState(const ScopedFpState&) = delete;
+    ScopedFpState& operator=(const ScopedFpState&) = delete;
+
+private:
+    FpState saved_;
+};
+
+} // namespace breath
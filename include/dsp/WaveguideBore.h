@@ -0,0 +1,300 @@
+/*
+  WaveguideBore.h - Digital waveguide bore (alternative resonance engine)
+
+  Physically-inspired replacement for the single formant bandpass:
+
+    breath ──► excitation ──► bore delay ──► loss filter ──► reflection ─┐
+                  ▲   (jet / reed)                                       │
+                  └──────────────────────────────────────────────────────┘
+
+  - Flute:    open-open bore, jet delay + cubic jet nonlinearity
+  - Clarinet: closed-open bore (half length), reed reflection table
+
+  The bore is a power-of-two ring buffer tuned with an integer read plus a
+  first-order allpass for the fractional part. Lines are carved from the
+  engine's DspArena in prepare(), long enough for kLowestFrequency at that
+  sample rate, so no note ever reallocates.
+*/
+
+#pragma once
+
+#include "DspArena.h"
+#include "DspCheckpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace breath {
+
+enum class ResonanceEngine : int {
+    Formant = 0,    // Original bandpass formant
+    Flute,          // Waveguide, jet excitation
+    Clarinet        // Waveguide, reed excitation
+};
+
+// -----------------------------------------------------------------------------
+// Power-of-two delay line
+// -----------------------------------------------------------------------------
+struct DelayLine {
+    float* buffer = nullptr;    // mask + 1 samples, owned by the arena
+    uint32_t mask = 0;
+    uint32_t writePos = 0;
+
+    static uint32_t sizeFor(int minLength) noexcept {
+        uint32_t size = 1;
+        while (size < uint32_t(minLength)) size <<= 1;
+        return size;
+    }
+
+    static size_t arenaBytes(int minLength) noexcept {
+        return DspArena::bytesFor<float>(sizeFor(minLength));
+    }
+
+    void allocate(int minLength, DspArena& arena) noexcept {
+        const uint32_t size = sizeFor(minLength);
+        buffer = arena.allocate<float>(size);
+        mask = buffer != nullptr ? size - 1 : 0;
+        writePos = 0;
+    }
+
+    void clear() noexcept {
+        if (buffer != nullptr)
+            std::fill(buffer, buffer + mask + 1, 0.f);
+        writePos = 0;
+    }
+
+    void write(float x) noexcept {
+        buffer[writePos] = x;
+        writePos = (writePos + 1) & mask;
+    }
+
+    // delay >= 1: sample written `delay` writes ago
+    float read(int delay) const noexcept {
+        return buffer[(writePos - uint32_t(delay)) & mask];
+    }
+
+    // Checkpoint the last `length` samples (oldest first)
+    void saveWindow(CheckpointWriter& w, uint32_t length) const noexcept {
+        length = std::min(length, mask + 1);
+        w.put(writePos);
+        w.put(length);
+
+        // At most two contiguous runs around the wrap point
+        const uint32_t start = (writePos - length) & mask;
+        const uint32_t first = std::min(length, mask + 1 - start);
+        w.putFloats(buffer + start, first);
+        w.putFloats(buffer, length - first);
+    }
+
+    bool restoreWindow(CheckpointReader& r) noexcept {
+        uint32_t length = 0;
+        if (buffer == nullptr || !r.get(writePos) || !r.get(length) || length > mask + 1) {
+            r.fail();
+            return false;
+        }
+        writePos &= mask;
+        std::fill(buffer, buffer + mask + 1, 0.f);
+
+        const uint32_t start = (writePos - length) & mask;
+        const uint32_t first = std::min(length, mask + 1 - start);
+        r.getFloats(buffer + start, first);
+        r.getFloats(buffer, length - first);
+        return r.ok();
+    }
+};
+
+// -----------------------------------------------------------------------------
+// First-order allpass fractional delay (d in [0.5, 1.5) for a flat response)
+// -----------------------------------------------------------------------------
+struct AllpassTuner {
+    float a = 0.f;
+    float x1 = 0.f, y1 = 0.f;
+
+    void setDelay(float d) noexcept {
+        a = (1.f - d) / (1.f + d);
+    }
+
+    float process(float x) noexcept {
+        const float y = a * x + x1 - a * y1;
+        x1 = x;
+        y1 = y;
+        return y;
+    }
+
+    void reset() noexcept { x1 = y1 = 0.f; }
+};
+
+// -----------------------------------------------------------------------------
+// Waveguide bore
+// -----------------------------------------------------------------------------
+struct WaveguideBore {
+    static constexpr float kLowestFrequency = 20.f;
+
+    DelayLine bore;
+    DelayLine jet;
+    AllpassTuner tuner;
+
+    float sampleRate = 48000.f;
+    float lastFreq = -1.f;
+    float lastBrightness = -1.f;
+    ResonanceEngine lastModel = ResonanceEngine::Formant;
+    int boreDelay = 100;
+    int jetDelay = 50;
+
+    // Loss filter (one-pole lowpass) on the reflection
+    float lossState = 0.f;
+    float lossCoef = 0.65f;     // Pole: higher = darker, more damped
+    float turbulence = 0.3f;    // Flute: breath noise on the jet
+
+    // DC blockers: jet feedback and output
+    float dcX1 = 0.f, dcY1 = 0.f;
+    float outX1 = 0.f, outY1 = 0.f;
+
+    bool excited = false;       // Lines hold data (skipped in checkpoints otherwise)
+
+    static int maxLengthFor(double sr) noexcept {
+        return int(std::ceil(sr / kLowestFrequency)) + 4;
+    }
+
+    static size_t arenaBytes(double sr) noexcept {
+        return DelayLine::arenaBytes(maxLengthFor(sr)) + DelayLine::arenaBytes(maxLengthFor(sr) / 2);
+    }
+
+    // Carves both lines from the arena (arenaBytes(sr) of it)
+    void prepare(double sr, DspArena& arena) noexcept {
+        sampleRate = float(sr);
+        bore.allocate(maxLengthFor(sr), arena);
+        jet.allocate(maxLengthFor(sr) / 2, arena);
+        reset();
+    }
+
+    void reset() noexcept {
+        bore.clear();
+        jet.clear();
+        tuner.reset();
+        lossState = 0.f;
+        dcX1 = dcY1 = 0.f;
+        outX1 = outY1 = 0.f;
+        lastFreq = -1.f;
+        excited = false;
+    }
+
+    // Retune only when pitch, brightness or model actually change
+    void setTuning(float freq, float brightness, ResonanceEngine model) noexcept {
+        if (freq == lastFreq && brightness == lastBrightness && model == lastModel)
+            return;
+        lastFreq = freq;
+        lastBrightness = brightness;
+        lastModel = model;
+
+        // Flute pitch depends on the jet timing, so its loss stays fixed and
+        // brightness moves the breath noise instead
+        float length, jetTrim;
+        if (model == ResonanceEngine::Clarinet) {
+            lossCoef = 0.65f - brightness * 0.4f;
+            length = 0.5f * sampleRate / std::max(freq, kLowestFrequency);  // Quarter-wave
+            jetTrim = 0.f;
+        } else {
+            lossCoef = 0.65f;
+            turbulence = 0.4f - brightness * 0.3f;
+            length = sampleRate / std::max(freq, kLowestFrequency);
+            jetTrim = sampleRate * 2.0e-5f;     // Measured lag of the jet/DC-blocker loop
+        }
+
+        // Phase delay of the one-pole loss filter at the loop frequency
+        const float w = 6.28318f / length;
+        const float lossDelay = std::atan2(lossCoef * std::sin(w), 1.f - lossCoef * std::cos(w)) / w;
+
+        // Integer part from the ring buffer, 0.5..1.5 from the allpass
+        const float total = std::clamp(length - lossDelay + jetTrim, 2.f, float(bore.mask - 1));
+        const int whole = int(total - 0.5f);
+        tuner.setDelay(total - float(whole));
+        boreDelay = std::max(1, whole);
+        jetDelay = std::max(1, int(total * 0.5f + 0.5f));
+    }
+
+    static float jet_table(float x) noexcept {
+        return std::clamp(x * (x * x - 1.f), -1.f, 1.f);
+    }
+
+    static float reed_table(float x) noexcept {
+        return std::clamp(0.7f - 0.3f * x, -1.f, 1.f);
+    }
+
+    // breath: 0..1 envelope, noise: turbulence sample (about ±0.5)
+    float process(float breath, float noise, ResonanceEngine model) noexcept {
+        excited = true;
+        const float boreOut = tuner.process(bore.read(boreDelay));
+
+        // Reflection with frequency-dependent loss
+        lossState += (boreOut - lossState) * (1.f - lossCoef);
+
+        // Mouth pressure: square-root curve so moderate breath reaches the
+        // oscillation threshold, quiet breath stays airy
+        const float mouth = std::sqrt(std::min(breath * 2.5f, 1.f));
+
+        if (model == ResonanceEngine::Clarinet) {
+            // Closed end: inverted reflection against the reed
+            const float pressure = mouth * (0.85f + 0.1f * noise);
+            const float diff = -0.95f * lossState - pressure;
+            bore.write(pressure + diff * reed_table(diff));
+        } else {
+            // Open end: jet sees the reflected wave through a DC blocker
+            const float pressure = mouth * (1.15f + turbulence * noise);
+
+            const float dc = lossState - dcX1 + 0.995f * dcY1;
+            dcX1 = lossState;
+            dcY1 = dc;
+
+            jet.write(pressure - 0.5f * dc);
+            bore.write(jet_table(jet.read(jetDelay)) + 0.5f * dc);
+        }
+
+        // The jet table's offset would otherwise thump on every onset
+        const float out = boreOut - outX1 + 0.995f * outY1;
+        outX1 = boreOut;
+        outY1 = out;
+
+        return out * 0.3f;
+    }
+
+    // -------------------------------------------------------------------------
+    // Checkpoint: scalars, then only the line windows the longest delay at
+    // this sample rate can reach
+    // -------------------------------------------------------------------------
+    void saveState(CheckpointWriter& w) const noexcept {
+        w.put(tuner);
+        w.put(lastFreq); w.put(lastBrightness); w.put(lastModel);
+        w.put(boreDelay); w.put(jetDelay);
+        w.put(lossState); w.put(lossCoef); w.put(turbulence);
+        w.put(dcX1); w.put(dcY1); w.put(outX1); w.put(outY1);
+        w.put(excited);
+
+        if (excited) {
+            const uint32_t window = uint32_t(sampleRate / kLowestFrequency) + 8;
+            bore.saveWindow(w, window);
+            jet.saveWindow(w, window / 2 + 4);
+        }
+    }
+
+    bool restoreState(CheckpointReader& r) noexcept {
+        r.get(tuner);
+        r.get(lastFreq); r.get(lastBrightness); r.get(lastModel);
+        r.get(boreDelay); r.get(jetDelay);
+        r.get(lossState); r.get(lossCoef); r.get(turbulence);
+        r.get(dcX1); r.get(dcY1); r.get(outX1); r.get(outY1);
+        r.get(excited);
+
+        if (excited) {
+            bore.restoreWindow(r);
+            jet.restoreWindow(r);
+        } else {
+            bore.clear();
+            jet.clear();
+        }
+        return r.ok();
+    }
+};
+
+} // namespace breath
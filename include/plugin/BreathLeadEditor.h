@@ -10,7 +10,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "plugin/BreathLeadProcessor.h"
 
-class BreathLeadEditor  : public juce::AudioProcessorEditor
+class BreathLeadEditor  : public juce::AudioProcessorEditor,
+                          private juce::Timer
 {
 public:
     BreathLeadEditor(BreathLeadProcessor& p);
@@ -21,6 +22,8 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
     // Reference to processor
     BreathLeadProcessor& processorRef;
 
@@ -37,5 +40,8 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> resistanceAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> vibratoAttachment_;
 
+    // DSP load (BREATHLEAD_PROFILING builds) and reduced-quality readout
+    juce::String profileText_;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BreathLeadEditor)
 };
@@ -8,10 +8,21 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "../dsp/BreathLeadVoice.h"
+#include "../dsp/BreathLeadSynth.h"
+#include "../dsp/AudioBreathFollower.h"
+#include "../dsp/FdnAmbience.h"
+#include "../dsp/FixedBlockRenderer.h"
+#include "../dsp/PresetSnapshot.h"
+#include "../dsp/PresetMorph.h"
+#include "../dsp/BlockProfiler.h"
+#include "../dsp/QualityGovernor.h"
+#include "../dsp/RealtimeGuard.h"
+#include "PresetLibrary.h"
+#include "PresetPreviewCache.h"
+#include "PluginState.h"
 
 class BreathLeadProcessor  : public juce::AudioProcessor,
-                              public juce::AudioProcessorValueTreeState::Listener
+                             private juce::Timer
 {
 public:
     BreathLeadProcessor();
@@ -22,6 +33,12 @@ public:
     void releaseResources() override;
 
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override;
+    void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) override;
+
+    // Double-precision hosts (and bounces) render through BreathLeadVoiceDouble.
+    // Only the host-rate filters, saturation and mix run in double; the
+    // excitation, envelope, bore and room stay float
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -36,44 +53,250 @@ public:
     double getTailLengthSeconds() const override { return 0.5f; }
 
     //==============================================================================
-    int getNumPrograms() override { return 1; }
-    int getCurrentProgram() override { return 0; }
-    void setCurrentProgram(int index) override { (void)index; }
-
-    const juce::String getProgramName(int index) override {
-        (void)index;
-        return {};
-    }
-    void changeProgramName(int index, const juce::String& name) override {
-        (void)index; (void)name;
-    }
+    // Factory programs, then the indexed preset library
+    int getNumPrograms() override;
+    int getCurrentProgram() override { return currentProgram_; }
+    void setCurrentProgram(int index) override;
+    const juce::String getProgramName(int index) override;
+    void changeProgramName(int index, const juce::String& name) override;
+
+    //==============================================================================
+    // Preset browser audition: plays the program's pre-rendered preview over
+    // the output. Returns false (and plays nothing) if the preview has not
+    // been rendered yet. Any thread.
+    bool auditionProgram(int index);
+    void stopAudition();
+    bool isPreviewReady(int index) const;
 
     //==============================================================================
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     //==============================================================================
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    // DSP checkpoints for chunked / resumable offline rendering. Call between
+    // blocks; restore needs the same build and sample rate. Both fail
+    // (empty block / false) between releaseResources() and prepareToPlay().
+    // On a failed restore the DSP state is undefined until the next
+    // prepareToPlay().
+    juce::MemoryBlock saveDspCheckpoint() const;
+    bool restoreDspCheckpoint(const void* data, size_t size);
+
+    //==============================================================================
+    // Adaptive quality: steps DSP quality down when blocks get close to their
+    // deadline (realtime only; offline renders always run at Full)
+    void setAdaptiveQuality(bool shouldEnable) { governor_.setEnabled(shouldEnable); }
+    breath::QualityTier getQualityTier() const { return governor_.getTier(); }
+    const breath::QualityGovernor& getGovernor() const { return governor_; }
+
+    //==============================================================================
+    // The engine renders fixed kProcessBlock-sample blocks whatever the host
+    // block size (FixedBlockRenderer.h). Zero latency (default) renders a
+    // partial block when the host block ends inside one; Buffered renders
+    // whole blocks only and reports one block of latency. Takes effect at
+    // the next prepareToPlay().
+    void setBlockLatency(breath::BlockLatency latency) { blockLatency_ = latency; }
+    breath::BlockLatency getBlockLatency() const { return blockLatency_; }
 
     //==============================================================================
+    // DSP memory of this instance: the processor itself, the arena (voices,
+    // room, input pitch tracker) and the tracker's FFT. After
+    // releaseResources() only the processor remains.
+    size_t getMemoryFootprint() const;
+
+    // MIDI messages the pending queue holds; what arrives past that is
+    // dropped and counted, since construction (any thread)
+    static constexpr int kMaxPendingMidi = 1024;
+    juce::uint64 getDroppedMidiCount() const { return midiDropped_.load(std::memory_order_relaxed); }
+
     juce::AudioProcessorValueTreeState& getParameters() { return parameters_; }
     const juce::AudioProcessorValueTreeState& getParameters() const { return parameters_; }
 
+#if BREATHLEAD_PROFILING
+    //==============================================================================
+    const breath::BlockProfiler& getProfiler() const { return profiler_; }
+    bool dumpProfile(const juce::File& file) const;
+#endif
+
 private:
+    //==============================================================================
+    struct FactoryPreset
+    {
+        juce::String name;
+        breath::PresetSnapshot values;
+    };
+
+    enum InputMode
+    {
+        InputOff = 0,
+        InputAir,
+        InputAirPitch
+    };
+
     //==============================================================================
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    template <typename Synth, typename Sample>
+    void renderBlock(Synth& synth, juce::AudioBuffer<Sample>& buffer, juce::MidiBuffer& midiMessages);
+    template <typename Synth, typename Sample>
+    int renderInternalBlock(Synth& synth, int next, int start, Sample* left, Sample* right, int numSamples);
+    template <typename Sample>
+    void followInput(const juce::AudioBuffer<Sample>& buffer, int numInputs, int start, int numSamples);
+    template <typename Sample>
+    void playAudition(Sample* left, Sample* right, int numSamples);
+    template <typename Sample>
+    breath::FixedBlockRenderer<Sample>& getBlockRenderer();
+    template <typename Synth>
+    void updateSynthParameters(Synth& synth);
+    breath::SynthParameters makeSynthParameters() const;
+    void applyQualityTier();
+    bool prepareBuffers(double sampleRate);
+    void detachBuffers();
+
+    // Programs (message thread unless noted)
+    void loadFactoryPresets();
+    bool getProgramSnapshot(int index, breath::PresetSnapshot& out) const;   // Any thread
+    breath::PresetSnapshot getHostSnapshot() const;                          // Any thread
+    void syncHostParameters(const breath::PresetSnapshot& snapshot);
+    void setParameterValue(const juce::String& parameterID, float value);
+    void applyProgram(int index);
+    void publishProgram(const breath::PresetSnapshot& snapshot);             // Any thread
+    void publishAudition(juce::uint64 key);                                  // Any thread
+    void loadMorphEndpoints();
+    void updatePreviewCache();
+    void timerCallback() override;
+    int getInputDelay() const;
+    static bool readLegacyState(const void* data, int sizeInBytes, breath::PluginState& state);
 
     //==============================================================================
-    // DSP voice (monophonic)
-    breath::BreathLeadVoice voice_;
+    // Every delay line below and the input pitch tracker's buffers, carved
+    // in prepareBuffers(); released (and the components detached) in
+    // releaseResources()
+    breath::DspArena arena_;
+    double preparedRate_ = 48000.0;
+
+    // DSP voice pool (monophonic unless an MPE zone is active), one per
+    // precision; only the one in use is prepared
+    breath::BreathLeadSynth synth_;
+    breath::BreathLeadSynthDouble synthDouble_;
+
+    // Shared room/body stage after the voice mix
+    breath::FdnAmbience ambience_;
+
+    // Fixed internal blocks, one per precision
+    breath::FixedBlockRenderer<float> blocks_;
+    breath::FixedBlockRenderer<double> blocksDouble_;
+    breath::BlockLatency blockLatency_ = breath::BlockLatency::Zero;
+
+    // MIDI not rendered yet, in buffer order. Positions are relative to the
+    // current host block (negative for what Buffered carried over).
+    struct PendingMidi
+    {
+        int position;
+        int numBytes;
+        uint8_t data[3];
+    };
+
+    PendingMidi pendingMidi_[kMaxPendingMidi];
+    int numPendingMidi_ = 0;
+    std::atomic<juce::uint64> midiDropped_ { 0 };
+
+    // Audio input → air / pitch. The host block is followed a span at a
+    // time before the engine overwrites it; values are kept per input
+    // sample so internal blocks (which may lag the host) read their own.
+    static constexpr int kMaxSpan = 1024;
+    static constexpr int kInputRingSize = 4096;
+    breath::AudioBreathFollower inputFollower_;
+    float inputAir_[kInputRingSize] = {};
+    float inputPitch_[kInputRingSize] = {};
+    juce::int64 inputClock_ = 0;        // Input samples before this host block
+    int inputMode_ = InputOff;
+    bool followInput_ = false;
+
+    // Air + Pitch runs MIDI and air one tracker hop late so each sample's
+    // pitch is already known; that delay is the reported latency, updated
+    // from the timer when the mode changes
+    int inputDelay_ = 0;
+    std::atomic<int> latencySamples_ { 0 };
+
+    // The sound being played (audio thread): host knobs that moved, the
+    // last program from the mailbox, or the morph
+    breath::PresetSnapshot sound_;
+    breath::PresetSnapshot lastHostValues_ { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1 };
 
     // Parameters (minimal, intentional)
     juce::AudioProcessorValueTreeState parameters_;
 
-    // MIDI state
-    int lastNoteNumber_ = -1;
-    float lastVelocity_ = 0.f;
-    bool noteIsOn_ = false;
+    // Raw parameter values, read once per block
+    std::atomic<float>* airParam_ = nullptr;
+    std::atomic<float>* toneParam_ = nullptr;
+    std::atomic<float>* formantParam_ = nullptr;
+    std::atomic<float>* resistanceParam_ = nullptr;
+    std::atomic<float>* vibratoParam_ = nullptr;
+    std::atomic<float>* mpeParam_ = nullptr;
+    std::atomic<float>* breathInParam_ = nullptr;
+    std::atomic<float>* engineParam_ = nullptr;
+    std::atomic<float>* roomParam_ = nullptr;
+    std::atomic<float>* roomSizeParam_ = nullptr;
+    std::atomic<float>* attackParam_ = nullptr;
+    std::atomic<float>* swellParam_ = nullptr;
+    std::atomic<float>* sustainParam_ = nullptr;
+    std::atomic<float>* releaseParam_ = nullptr;
+    std::atomic<float>* attackCurveParam_ = nullptr;
+    std::atomic<float>* swellCurveParam_ = nullptr;
+    std::atomic<float>* releaseCurveParam_ = nullptr;
+    std::atomic<float>* masterParam_ = nullptr;
+    std::atomic<float>* inputModeParam_ = nullptr;
+    std::atomic<float>* inputSensParam_ = nullptr;
+    std::atomic<float>* morphOnParam_ = nullptr;
+    std::atomic<float>* morphParam_ = nullptr;
+    std::atomic<float>* morphAParam_ = nullptr;
+    std::atomic<float>* morphBParam_ = nullptr;
+    std::atomic<float>* morphCParam_ = nullptr;
+
+    // MPE switch position each synth last followed. Per synth: after a
+    // precision change the other one catches up on its first block
+    bool mpeSwitch_ = false;
+    bool mpeSwitchDouble_ = false;
+
+    // Preset system
+    std::vector<FactoryPreset> factoryPresets_;
+    PresetLibrary presetLibrary_;
+    PresetPreviewCache previewCache_;
+    std::atomic<int> currentProgram_ { 0 };
+
+    // Program the host selected off the message thread (-1: none); the
+    // timer applies it, so the library is only read on the message thread
+    std::atomic<int> requestedProgram_ { -1 };
+
+    // Program handoff to the audio thread. The mailbox takes one producer;
+    // programs come from any thread, so publishProgram() serialises them
+    breath::SnapshotMailbox<breath::PresetSnapshot> pendingProgram_;
+    juce::SpinLock programPublishLock_;
+
+    // Preset audition: the preview's cache key (0 stops) goes through the
+    // mailbox, serialised like programs; the audio thread pins the preview
+    // while it plays
+    breath::SnapshotMailbox<juce::uint64> pendingAudition_;
+    juce::SpinLock auditionPublishLock_;
+    PresetPreviewCache::Preview audition_;
+    double auditionPosition_ = 0.0;
+
+    // Preset morph (macro + CC16 sweep across up to three programs)
+    static constexpr int kMorphController = 16;
+    breath::PresetMorpher morpher_;
+    breath::SnapshotSmoother morphSmoother_;
+    int loadedMorphPrograms_[breath::PresetMorpher::kMaxEndpoints] = { -1, -1, -1, -1 };
+    float morphPosition_ = 0.0f;
+    float lastMorphParam_ = -1.0f;
+    bool morphing_ = false;
+
+    // CPU governor and the settings currently applied
+    breath::QualityGovernor governor_;
+    bool ambienceEnabled_ = true;
+
+#if BREATHLEAD_PROFILING
+    // processBlock timing (compiled out unless BREATHLEAD_PROFILING)
+    breath::BlockProfiler profiler_;
+#endif
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BreathLeadProcessor)
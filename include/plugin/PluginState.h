@@ -0,0 +1,310 @@
+/*
+  PluginState.h - Compact versioned binary plugin state
+
+  Layout (little endian):
+
+    offset  size  field
+    0       4     magic "BLST"
+    4       2     writer version
+    6       2     minimum reader version
+    8       4     payload size
+    12      4     CRC-32 of payload
+    16      ...   payload: records of { u16 tag, u16 length, bytes }
+
+  Compatibility:
+  - Older states load in newer builds: missing tags keep their defaults.
+  - Newer states load in older builds: unknown tags are skipped, unless the
+    writer raised the minimum reader version above ours.
+  - States saved before this format (JUCE ValueTree stream) are migrated by
+    the plugin wrapper, which recognises them by the missing magic.
+
+  Every decoded value is checked before it is stored: a non-finite float
+  is dropped (the field keeps its value) and numbers are clamped to the
+  range of the matching host parameter, so a damaged or hand-edited state
+  never reaches the voices as NaN or out of range.
+
+  Pure C++, no JUCE. encode() writes into a caller buffer and decode()
+  fills a struct in place; neither allocates.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace breath {
+
+struct PluginState {
+    float air = 0.5f;
+    float tone = 0.5f;
+    float formant = 0.5f;
+    float resistance = 0.5f;
+    float vibrato = 0.f;
+    float masterGain = 0.7f;
+    int32_t engine = 0;
+    int32_t program = 0;
+
+    int32_t inputMode = 0;
+    float inputSensitivity = 0.5f;
+
+    int32_t morphOn = 0;
+    float morphPosition = 0.f;
+    int32_t morphA = 1;
+    int32_t morphB = 8;
+    int32_t morphC = 0;
+
+    float roomMix = 0.f;
+    float roomSize = 0.4f;
+
+    float attack = 90.f;        // Pressure envelope (ms, curves -1..1)
+    float swell = 200.f;
+    float sustain = 1.f;
+    float release = 360.f;
+    float attackCurve = 0.6f;
+    float swellCurve = 0.f;
+    float releaseCurve = 0.6f;
+
+    int32_t mpe = 0;
+    int32_t breathSources = 0;  // 0 breath, 1 + expression, 2 + mod wheel
+};
+
+namespace state {
+
+constexpr uint16_t kVersion = 2;
+constexpr uint16_t kMinReaderVersion = 1;
+constexpr size_t kHeaderSize = 16;
+
+enum Tag : uint16_t {
+    kTagAir = 1,
+    kTagTone,
+    kTagFormant,
+    kTagResistance,
+    kTagVibrato,
+    kTagMasterGain,
+    kTagProgram,
+    kTagInputMode,
+    kTagInputSensitivity,
+    kTagMorphOn,
+    kTagMorphPosition,
+    kTagMorphA,
+    kTagMorphB,
+    kTagMorphC,
+    kTagEngine,
+    kTagRoomMix,
+    kTagRoomSize,
+    kTagAttack,
+    kTagSwell,
+    kTagSustain,
+    kTagRelease,
+    kTagAttackCurve,
+    kTagSwellCurve,
+    kTagReleaseCurve,
+    kTagMpe,
+    kTagBreathSources,
+    kNumTags
+};
+
+// Every value is 4 bytes: header + (tag, length, value) per record
+constexpr size_t kMaxEncodedSize = kHeaderSize + (kNumTags - 1) * 8;
+
+// -----------------------------------------------------------------------------
+// CRC-32 (IEEE 802.3), table built at compile time
+// -----------------------------------------------------------------------------
+constexpr std::array<uint32_t, 256> make_crc_table() noexcept {
+    std::array<uint32_t, 256> table {};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+inline constexpr auto kCrcTable = make_crc_table();
+
+inline uint32_t crc32(const uint8_t* data, size_t size) noexcept {
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+        c = kCrcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// -----------------------------------------------------------------------------
+// Little-endian helpers
+// -----------------------------------------------------------------------------
+inline void put_u16(uint8_t* p, uint16_t v) noexcept {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+}
+
+inline void put_u32(uint8_t* p, uint32_t v) noexcept {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+}
+
+inline uint16_t get_u16(const uint8_t* p) noexcept {
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+inline uint32_t get_u32(const uint8_t* p) noexcept {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+inline uint32_t float_bits(float f) noexcept {
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    return u;
+}
+
+inline float bits_float(uint32_t u) noexcept {
+    float f;
+    std::memcpy(&f, &u, 4);
+    return f;
+}
+
+inline bool has_magic(const void* data, size_t size) noexcept {
+    return size >= 4 && std::memcmp(data, "BLST", 4) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Encode: returns bytes written, or 0 if capacity < kMaxEncodedSize
+// -----------------------------------------------------------------------------
+inline size_t encode(const PluginState& s, uint8_t* out, size_t capacity) noexcept {
+    if (capacity < kMaxEncodedSize)
+        return 0;
+
+    uint8_t* p = out + kHeaderSize;
+    const auto record = [&p](Tag tag, uint32_t bits) {
+        put_u16(p, tag);
+        put_u16(p + 2, 4);
+        put_u32(p + 4, bits);
+        p += 8;
+    };
+
+    record(kTagAir, float_bits(s.air));
+    record(kTagTone, float_bits(s.tone));
+    record(kTagFormant, float_bits(s.formant));
+    record(kTagResistance, float_bits(s.resistance));
+    record(kTagVibrato, float_bits(s.vibrato));
+    record(kTagMasterGain, float_bits(s.masterGain));
+    record(kTagProgram, uint32_t(s.program));
+    record(kTagInputMode, uint32_t(s.inputMode));
+    record(kTagInputSensitivity, float_bits(s.inputSensitivity));
+    record(kTagMorphOn, uint32_t(s.morphOn));
+    record(kTagMorphPosition, float_bits(s.morphPosition));
+    record(kTagMorphA, uint32_t(s.morphA));
+    record(kTagMorphB, uint32_t(s.morphB));
+    record(kTagMorphC, uint32_t(s.morphC));
+    record(kTagEngine, uint32_t(s.engine));
+    record(kTagRoomMix, float_bits(s.roomMix));
+    record(kTagRoomSize, float_bits(s.roomSize));
+    record(kTagAttack, float_bits(s.attack));
+    record(kTagSwell, float_bits(s.swell));
+    record(kTagSustain, float_bits(s.sustain));
+    record(kTagRelease, float_bits(s.release));
+    record(kTagAttackCurve, float_bits(s.attackCurve));
+    record(kTagSwellCurve, float_bits(s.swellCurve));
+    record(kTagReleaseCurve, float_bits(s.releaseCurve));
+    record(kTagMpe, uint32_t(s.mpe));
+    record(kTagBreathSources, uint32_t(s.breathSources));
+
+    const uint32_t payloadSize = uint32_t(p - out - kHeaderSize);
+
+    std::memcpy(out, "BLST", 4);
+    put_u16(out + 4, kVersion);
+    put_u16(out + 6, kMinReaderVersion);
+    put_u32(out + 8, payloadSize);
+    put_u32(out + 12, crc32(out + kHeaderSize, payloadSize));
+
+    return kHeaderSize + payloadSize;
+}
+
+// Stores a decoded float clamped to [lo, hi]; NaN and infinities are dropped
+inline void set_real(float& field, uint32_t bits, float lo, float hi) noexcept {
+    const float v = bits_float(bits);
+    if (std::isfinite(v))
+        field = std::clamp(v, lo, hi);
+}
+
+inline void set_int(int32_t& field, uint32_t bits, int32_t lo, int32_t hi) noexcept {
+    field = std::clamp(int32_t(bits), lo, hi);
+}
+
+// -----------------------------------------------------------------------------
+// Decode: fills `s` (fields not present keep their current values), each
+// value validated as above.
+// Returns false on bad magic, size, checksum or an incompatible writer.
+// -----------------------------------------------------------------------------
+inline bool decode(const void* data, size_t size, PluginState& s) noexcept {
+    const auto* in = static_cast<const uint8_t*>(data);
+
+    if (size < kHeaderSize || !has_magic(in, size))
+        return false;
+
+    const uint16_t minReader = get_u16(in + 6);
+    const uint32_t payloadSize = get_u32(in + 8);
+
+    if (minReader > kVersion || payloadSize > size - kHeaderSize)
+        return false;
+
+    const uint8_t* p = in + kHeaderSize;
+    if (crc32(p, payloadSize) != get_u32(in + 12))
+        return false;
+
+    const uint8_t* end = p + payloadSize;
+    while (end - p >= 4) {
+        const uint16_t tag = get_u16(p);
+        const uint16_t length = get_u16(p + 2);
+        p += 4;
+
+        if (length > end - p)
+            return false;
+
+        if (length == 4) {
+            const uint32_t v = get_u32(p);
+            switch (tag) {
+                case kTagAir:              set_real(s.air, v, 0.f, 1.f); break;
+                case kTagTone:             set_real(s.tone, v, 0.f, 1.f); break;
+                case kTagFormant:          set_real(s.formant, v, 0.f, 1.f); break;
+                case kTagResistance:       set_real(s.resistance, v, 0.f, 1.f); break;
+                case kTagVibrato:          set_real(s.vibrato, v, 0.f, 1.f); break;
+                case kTagMasterGain:       set_real(s.masterGain, v, 0.f, 1.f); break;
+                case kTagProgram:          set_int(s.program, v, 0, INT32_MAX); break;
+                case kTagInputMode:        set_int(s.inputMode, v, 0, 2); break;
+                case kTagInputSensitivity: set_real(s.inputSensitivity, v, 0.f, 1.f); break;
+                case kTagMorphOn:          set_int(s.morphOn, v, 0, 1); break;
+                case kTagMorphPosition:    set_real(s.morphPosition, v, 0.f, 1.f); break;
+                case kTagMorphA:           set_int(s.morphA, v, 1, 128); break;
+                case kTagMorphB:           set_int(s.morphB, v, 1, 128); break;
+                case kTagMorphC:           set_int(s.morphC, v, 0, 128); break;
+                case kTagEngine:           set_int(s.engine, v, 0, 2); break;
+                case kTagRoomMix:          set_real(s.roomMix, v, 0.f, 1.f); break;
+                case kTagRoomSize:         set_real(s.roomSize, v, 0.f, 1.f); break;
+                case kTagAttack:           set_real(s.attack, v, 1.f, 1000.f); break;
+                case kTagSwell:            set_real(s.swell, v, 0.f, 2000.f); break;
+                case kTagSustain:          set_real(s.sustain, v, 0.25f, 1.5f); break;
+                case kTagRelease:          set_real(s.release, v, 10.f, 3000.f); break;
+                case kTagAttackCurve:      set_real(s.attackCurve, v, -1.f, 1.f); break;
+                case kTagSwellCurve:       set_real(s.swellCurve, v, -1.f, 1.f); break;
+                case kTagReleaseCurve:     set_real(s.releaseCurve, v, -1.f, 1.f); break;
+                case kTagMpe:              set_int(s.mpe, v, 0, 1); break;
+                case kTagBreathSources:    set_int(s.breathSources, v, 0, 2); break;
+                default:                   break; // Newer writer: skip
+            }
+        }
+
+        p += length;
+    }
+
+    return true;
+}
+
+} // namespace state
+} // namespace breath
@@ -0,0 +1,84 @@
+/*
+  PresetLibrary.h - Indexed preset library with background scanning
+
+  Scans preset folders (XML, as written by presets/generate_presets.py) on a
+  background thread and keeps a compact binary index cache next to the user
+  presets. On later startups the cache is published immediately and only
+  files whose size or modification time changed are parsed again.
+
+  Each entry holds a preparsed breath::PresetSnapshot, so selecting a preset
+  is a POD copy. The audio thread never touches the library itself, except
+  for getNumPresets(), which is lock-free.
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include "../dsp/PresetSnapshot.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class PresetLibrary  : private juce::Thread,
+                       private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    // One preset in the index (POD; written to the cache file as-is)
+    struct Entry
+    {
+        juce::uint64 pathHash = 0;
+        juce::int64 modificationTime = 0;
+        juce::int64 fileSize = 0;
+        char name[64] = {};
+        char category[32] = {};
+        breath::PresetSnapshot values;
+    };
+
+    //==============================================================================
+    PresetLibrary(juce::Array<juce::File> searchRoots, juce::File cacheFile);
+    ~PresetLibrary() override;
+
+    // Default folders: bundled, common (factory) + user presets; cache in
+    // user data
+    static juce::Array<juce::File> getDefaultSearchRoots();
+    static juce::File getDefaultCacheFile();
+
+    //==============================================================================
+    void startScan();
+
+    int getNumPresets() const;      // Any thread, lock-free
+    bool getPreset(int index, breath::PresetSnapshot& out) const;
+    juce::String getPresetName(int index) const;
+    juce::String getPresetCategory(int index) const;
+
+    // Called on the message thread whenever a new index is published
+    std::function<void()> onIndexChanged;
+
+private:
+    //==============================================================================
+    using Index = std::vector<Entry>;
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    void publish(std::shared_ptr<const Index> index);
+    std::shared_ptr<const Index> getIndex() const;
+
+    std::shared_ptr<Index> loadCache() const;
+    void saveCache(const Index& index) const;
+    static bool parsePresetFile(const juce::File& file, Entry& entry);
+
+    //==============================================================================
+    juce::Array<juce::File> searchRoots_;
+    juce::File cacheFile_;
+
+    mutable juce::SpinLock indexLock_;
+    std::shared_ptr<const Index> index_;
+    std::atomic<int> numPresets_ { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetLibrary)
+};
@@ -0,0 +1,106 @@
+/*
+  PresetPreviewCache.h - Pre-rendered preset previews in a memory-mapped file
+
+  A background thread renders a short phrase for every preset with the DSP
+  core (BreathLeadSynth, fixed 48 kHz) and stores all previews in one cache
+  file. The file is memory-mapped and previews are handed out as pointers
+  into the mapping, so auditioning copies nothing and never waits.
+
+  Entries are keyed by a hash of the preset values plus
+  breath::kEngineVersion, so only presets whose sound changed (edited
+  values, or a new engine version) are rendered again.
+
+  A rebuild writes a new file and maps it. Mappings live in a few fixed
+  slots: acquirePreview() pins the current one (lock-free, fine on the
+  audio thread) and releasePreview() unpins it. A rebuild reuses a slot
+  that is neither current nor pinned, so only the current mapping and
+  those still being played stay mapped.
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include "../dsp/PresetSnapshot.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class PresetPreviewCache  : private juce::Thread,
+                            private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kNoteFrames = 14400;      // 300 ms per phrase note
+    static constexpr int kTailFrames = 24000;      // 500 ms release tail
+    static constexpr int kNumPhraseNotes = 5;
+    static constexpr int kNumFrames = kNoteFrames * kNumPhraseNotes + kTailFrames;
+
+    // Mono samples at kSampleRate, pointing into the mapped cache file.
+    // Valid until passed to releasePreview().
+    struct Preview
+    {
+        const float* samples = nullptr;
+        int numFrames = 0;
+        int slot = -1;          // Pinned mapping
+
+        bool isValid() const noexcept { return samples != nullptr; }
+    };
+
+    //==============================================================================
+    explicit PresetPreviewCache(juce::File cacheFile);
+    ~PresetPreviewCache() override;
+
+    static juce::File getDefaultCacheFile();
+
+    // Message thread. Presets to keep previews for; starts the render job.
+    void setPresets(std::vector<breath::PresetSnapshot> presets);
+
+    // Any thread, lock-free. Invalid (and nothing pinned) until this
+    // preset has been rendered; release every valid preview.
+    Preview acquirePreview(juce::uint64 key) const noexcept;
+    void releasePreview(Preview& preview) const noexcept;
+
+    // Any thread, lock-free
+    bool hasPreview(const breath::PresetSnapshot& preset) const noexcept;
+
+    static juce::uint64 makeKey(const breath::PresetSnapshot& preset) noexcept;
+
+    // Renders the preview phrase (kNumFrames samples)
+    static void renderPreview(const breath::PresetSnapshot& preset, float* out);
+
+    // Called on the message thread whenever new previews are available
+    std::function<void()> onPreviewsChanged;
+
+private:
+    //==============================================================================
+    struct Mapping;
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    bool rebuild(const std::vector<breath::PresetSnapshot>& presets);
+    std::unique_ptr<Mapping> openMapping(const juce::File& file) const;
+    bool publish(std::unique_ptr<Mapping> mapping);
+    int pinCurrent() const noexcept;
+
+    //==============================================================================
+    juce::File cacheFile_;
+
+    // Pending preset list from the message thread
+    juce::SpinLock pendingLock_;
+    std::vector<breath::PresetSnapshot> pending_;
+    bool hasPending_ = false;
+
+    // Published mappings (render thread writes slots); readers pin
+    // currentSlot_ and only then read its mapping
+    static constexpr int kNumSlots = 4;
+    std::unique_ptr<Mapping> mappings_[kNumSlots];
+    mutable std::atomic<int> pins_[kNumSlots] {};
+    std::atomic<int> currentSlot_ { -1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetPreviewCache)
+};
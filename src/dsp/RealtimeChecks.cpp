@@ -0,0 +1,267 @@
+/*
+  RealtimeChecks.cpp - Allocation / lock hooks behind RealtimeGuard.h
+
+  Replaces the global operator new / delete (portable) and, on glibc,
+  malloc & co. and pthread_mutex_lock. Outside a ScopedRealtimeSection the
+  hooks only forward. Compiles to nothing unless BREATHLEAD_RT_CHECKS.
+
+  In a shared library (plugin) the library's own calls only reach these
+  definitions when it is linked with -Bsymbolic-functions on ELF; the
+  BREATHLEAD_ENABLE_RT_CHECKS CMake option does that.
+*/
+
+#include "dsp/RealtimeGuard.h"
+
+#if BREATHLEAD_RT_CHECKS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+#elif defined(_WIN32)
+ #include <malloc.h>
+#endif
+
+namespace breath::realtime {
+
+namespace {
+
+thread_local int sectionDepth = 0;
+
+std::atomic<bool> trapping { true };
+std::atomic<uint64_t> violations[kNumViolations] = {};
+
+void check(Violation kind) noexcept {
+    if (sectionDepth == 0)
+        return;
+
+    // Reporting may allocate itself
+    const int depth = sectionDepth;
+    sectionDepth = 0;
+
+    violations[int(kind)].fetch_add(1, std::memory_order_relaxed);
+    if (trapping.load(std::memory_order_relaxed)) {
+        std::fprintf(stderr, "BreathLead: %s on the audio thread\n", violation_name(kind));
+        std::abort();
+    }
+
+    sectionDepth = depth;
+}
+
+// -----------------------------------------------------------------------------
+// Underlying allocator (bypasses the malloc hooks on glibc)
+// -----------------------------------------------------------------------------
+void* raw_alloc(size_t size) noexcept {
+#if defined(__GLIBC__)
+    return __libc_malloc(size != 0 ? size : 1);
+#else
+    return std::malloc(size != 0 ? size : 1);
+#endif
+}
+
+void raw_free(void* ptr) noexcept {
+#if defined(__GLIBC__)
+    __libc_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* raw_aligned_alloc(size_t size, size_t alignment) noexcept {
+    if (size == 0)
+        size = 1;
+#if defined(__GLIBC__)
+    return __libc_memalign(alignment, size);
+#elif defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void raw_aligned_free(void* ptr) noexcept {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    raw_free(ptr);
+#endif
+}
+
+} // namespace
+
+void enter_section() noexcept { ++sectionDepth; }
+void leave_section() noexcept { --sectionDepth; }
+bool is_in_section() noexcept { return sectionDepth > 0; }
+
+void set_trapping(bool shouldAbort) noexcept { trapping.store(shouldAbort, std::memory_order_relaxed); }
+
+uint64_t get_violation_count(Violation kind) noexcept {
+    return violations[int(kind)].load(std::memory_order_relaxed);
+}
+
+const char* violation_name(Violation kind) noexcept {
+    switch (kind) {
+        case Violation::Allocation:   return "allocation";
+        case Violation::Deallocation: return "deallocation";
+        case Violation::Lock:         return "mutex lock";
+    }
+    return "?";
+}
+
+// -----------------------------------------------------------------------------
+// operator new / delete
+// -----------------------------------------------------------------------------
+namespace {
+
+void* checked_new(size_t size) {
+    check(Violation::Allocation);
+    if (void* ptr = raw_alloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* checked_new(size_t size, std::align_val_t alignment) {
+    check(Violation::Allocation);
+    if (void* ptr = raw_aligned_alloc(size, size_t(alignment)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void checked_delete(void* ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+    check(Violation::Deallocation);
+    raw_free(ptr);
+}
+
+void checked_aligned_delete(void* ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+    check(Violation::Deallocation);
+    raw_aligned_free(ptr);
+}
+
+} // namespace
+
+} // namespace breath::realtime
+
+using namespace breath::realtime;
+
+void* operator new(size_t size) { return checked_new(size); }
+void* operator new[](size_t size) { return checked_new(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return checked_new(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return checked_new(size, alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    check(Violation::Allocation);
+    return raw_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    check(Violation::Allocation);
+    return raw_alloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    check(Violation::Allocation);
+    return raw_aligned_alloc(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    check(Violation::Allocation);
+    return raw_aligned_alloc(size, size_t(alignment));
+}
+
+void operator delete(void* ptr) noexcept { checked_delete(ptr); }
+void operator delete[](void* ptr) noexcept { checked_delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { checked_delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { checked_delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { checked_delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { checked_delete(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { checked_aligned_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { checked_aligned_delete(ptr); }
+
+// -----------------------------------------------------------------------------
+// C allocator and mutexes (glibc)
+// -----------------------------------------------------------------------------
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    check(Violation::Allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    check(Violation::Allocation);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    check(Violation::Allocation);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    check(Violation::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    check(Violation::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) noexcept {
+    check(Violation::Allocation);
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr != nullptr ? 0 : ENOMEM;
+}
+
+void free(void* ptr) noexcept {
+    if (ptr != nullptr)
+        check(Violation::Deallocation);
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    using LockFn = int (*)(pthread_mutex_t*);
+    static std::atomic<LockFn> next { nullptr };
+
+    check(Violation::Lock);
+
+    LockFn lock = next.load(std::memory_order_acquire);
+    if (lock == nullptr) {
+        lock = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        next.store(lock, std::memory_order_release);
+    }
+    return lock(mutex);
+}
+
+} // extern "C"
+
+#endif
+
+#endif
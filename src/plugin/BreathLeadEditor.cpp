@@ -51,12 +51,36 @@ BreathLeadEditor::BreathLeadEditor(BreathLeadProcessor& p)
         params, "vibrato", *vibratoSlider_);
 
     setSize(400, 200);
+
+    startTimerHz(4);
 }
 
 BreathLeadEditor::~BreathLeadEditor()
 {
 }
 
+void BreathLeadEditor::timerCallback()
+{
+    juce::String text;
+
+#if BREATHLEAD_PROFILING
+    const auto report = processorRef.getProfiler().getReport();
+    text = juce::String::formatted("DSP %.1f%%  peak %.1f%%  xruns %llu  voices %d",
+                                   report.lastLoad * 100.f, report.peakLoad * 100.f,
+                                   (unsigned long long) report.xruns, report.maxVoices);
+#endif
+
+    // Only shown while the governor has reduced quality
+    const auto tier = processorRef.getQualityTier();
+    if (tier != breath::QualityTier::Full)
+        text << (text.isEmpty() ? "" : "  ") << "Quality: " << breath::quality_tier_name(tier);
+
+    if (text != profileText_) {
+        profileText_ = text;
+        repaint(getLocalBounds().removeFromBottom(20));
+    }
+}
+
 //==============================================================================
 void BreathLeadEditor::paint(juce::Graphics& g)
 {
@@ -68,6 +92,13 @@ void BreathLeadEditor::paint(juce::Graphics& g)
     g.setFont(juce::FontOptions(16.0f));
     g.drawText("BREATH LEAD", getLocalBounds().removeFromTop(30),
                juce::Justification::centred, false);
+
+    if (profileText_.isNotEmpty()) {
+        g.setColour(juce::Colour(120, 120, 130));
+        g.setFont(juce::FontOptions(11.0f));
+        g.drawText(profileText_, getLocalBounds().removeFromBottom(20),
+                   juce::Justification::centred, false);
+    }
 }
 
 void BreathLeadEditor::resized()
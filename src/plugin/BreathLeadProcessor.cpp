@@ -7,107 +7,595 @@
 
 //==============================================================================
 BreathLeadProcessor::BreathLeadProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(BusesProperties()
-#if !JucePlugin_IsMidiEffect
-#if !JucePlugin_IsSynth
+        // Audio input drives air / pitch (see the "input" parameter)
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
-#endif
-        .withOutput("Output", juce::AudioChannelSet::stereo(), true)
-#endif
-    ),
-      parameters_(*this, nullptr, juce::Identifier("BreathLead"), createParameterLayout())
-#endif
+        .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+      parameters_(*this, nullptr, juce::Identifier("BreathLead"), createParameterLayout()),
+      presetLibrary_(PresetLibrary::getDefaultSearchRoots(), PresetLibrary::getDefaultCacheFile()),
+      previewCache_(PresetPreviewCache::getDefaultCacheFile())
 {
+    airParam_ = parameters_.getRawParameterValue("air");
+    toneParam_ = parameters_.getRawParameterValue("tone");
+    formantParam_ = parameters_.getRawParameterValue("formant");
+    resistanceParam_ = parameters_.getRawParameterValue("resistance");
+    vibratoParam_ = parameters_.getRawParameterValue("vibrato");
+    masterParam_ = parameters_.getRawParameterValue("master");
+    mpeParam_ = parameters_.getRawParameterValue("mpe");
+    breathInParam_ = parameters_.getRawParameterValue("breathIn");
+    engineParam_ = parameters_.getRawParameterValue("engine");
+    inputModeParam_ = parameters_.getRawParameterValue("input");
+    inputSensParam_ = parameters_.getRawParameterValue("inputSens");
+    roomParam_ = parameters_.getRawParameterValue("room");
+    roomSizeParam_ = parameters_.getRawParameterValue("roomSize");
+    attackParam_ = parameters_.getRawParameterValue("attack");
+    swellParam_ = parameters_.getRawParameterValue("swell");
+    sustainParam_ = parameters_.getRawParameterValue("sustain");
+    releaseParam_ = parameters_.getRawParameterValue("release");
+    attackCurveParam_ = parameters_.getRawParameterValue("attackCurve");
+    swellCurveParam_ = parameters_.getRawParameterValue("swellCurve");
+    releaseCurveParam_ = parameters_.getRawParameterValue("releaseCurve");
+    morphOnParam_ = parameters_.getRawParameterValue("morphOn");
+    morphParam_ = parameters_.getRawParameterValue("morph");
+    morphAParam_ = parameters_.getRawParameterValue("morphA");
+    morphBParam_ = parameters_.getRawParameterValue("morphB");
+    morphCParam_ = parameters_.getRawParameterValue("morphC");
 
-    // Initialize voice
-    voice_.prepare(48000.0);
-
-    // Default parameter values (Golden Init Patch)
+    // Initialize voices (Golden Init Patch defaults live in SynthParameters)
     // Soft breath, clear pitch, no vibrato, slight warmth, medium release
-    voice_.air = 0.5f;
-    voice_.tone = 0.6f;         // Slightly bright
-    voice_.formantParam = 0.5f; // Neutral vowel
-    voice_.resistance = 0.4f;   // Medium-tight
-    voice_.vibratoDepth = 0.f;  // No vibrato
+    prepareBuffers(48000.0);
+
+    // Start on the first factory program
+    loadFactoryPresets();
+    syncHostParameters(factoryPresets_.front().values);
+    publishProgram(factoryPresets_.front().values);
+
+    // Preset folders are scanned in the background; library presets
+    // follow the factory programs once the index is published
+    presetLibrary_.onIndexChanged = [this]
+    {
+        std::fill(std::begin(loadedMorphPrograms_), std::end(loadedMorphPrograms_), -1);
+        loadMorphEndpoints();
+        updatePreviewCache();
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    };
+    presetLibrary_.startScan();
+
+    // Previews render in the background; cached ones are ready at once
+    updatePreviewCache();
+
+    // Morph endpoints are (re)loaded off the audio thread
+    loadMorphEndpoints();
+    startTimerHz(20);
 }
 
 BreathLeadProcessor::~BreathLeadProcessor()
 {
+    stopTimer();
+    presetLibrary_.onIndexChanged = nullptr;
 }
 
 //==============================================================================
 void BreathLeadProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    voice_.prepare(sampleRate);
+    juce::ignoreUnused(samplesPerBlock);
+
+    // Out of memory: renderBlock() outputs silence until a prepare succeeds
+    if (!prepareBuffers(sampleRate))
+        return;
+
+    governor_.prepare(sampleRate);
+    applyQualityTier();
+
+#if BREATHLEAD_PROFILING
+    profiler_.prepare(sampleRate);
+#endif
 }
 
 void BreathLeadProcessor::releaseResources()
 {
+#if BREATHLEAD_PROFILING
+    // Standalone: leave a report behind when audio stops
+    if (wrapperType == wrapperType_Standalone)
+        dumpProfile(juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                        .getChildFile("BreathLead Profile.txt"));
+#endif
+
+    arena_.release();
+    detachBuffers();
+    previewCache_.releasePreview(audition_);
+}
+
+bool BreathLeadProcessor::prepareBuffers(double sampleRate)
+{
+    // One allocation for the voices of the precision in use, the room and
+    // the input pitch tracker, sized for this rate (the host picks the
+    // precision before preparing)
+    const bool useDouble = isUsingDoublePrecision();
+    const size_t synthBytes = useDouble ? breath::BreathLeadSynthDouble::arenaBytes(sampleRate)
+                                        : breath::BreathLeadSynth::arenaBytes(sampleRate);
+    if (!arena_.reserve(synthBytes + breath::FdnAmbience::arenaBytes(sampleRate)
+                            + breath::AudioBreathFollower::arenaBytes(sampleRate)))
+    {
+        // The old block went with the failed reserve
+        detachBuffers();
+        return false;
+    }
+
+    preparedRate_ = sampleRate;
+    if (useDouble)
+        synthDouble_.prepare(sampleRate, arena_);
+    else
+        synth_.prepare(sampleRate, arena_);
+    ambience_.prepare(sampleRate, arena_);
+
+    blocks_.setLatency(blockLatency_);
+    blocksDouble_.setLatency(blockLatency_);
+    numPendingMidi_ = 0;
+
+    inputFollower_.prepare(sampleRate, arena_);
+    std::fill(std::begin(inputAir_), std::end(inputAir_), 0.0f);
+    std::fill(std::begin(inputPitch_), std::end(inputPitch_), 0.0f);
+    inputClock_ = 0;
+    inputDelay_ = getInputDelay();
+    morphSmoother_.prepare(static_cast<float>(sampleRate));
+
+    // Fixed blocks, plus the pitch tracker's hop in Air + Pitch
+    latencySamples_ = blocks_.getLatencySamples() + inputDelay_;
+    setLatencySamples(latencySamples_);
+    return true;
+}
+
+void BreathLeadProcessor::detachBuffers()
+{
+    // Carving from the released (empty) arena hands every component null
+    // lines, so nothing keeps pointing into the freed block
+    synth_.prepare(preparedRate_, arena_);
+    synthDouble_.prepare(preparedRate_, arena_);
+    ambience_.prepare(preparedRate_, arena_);
+    inputFollower_.prepare(preparedRate_, arena_);
+}
+
+size_t BreathLeadProcessor::getMemoryFootprint() const
+{
+    return sizeof(*this) + arena_.capacity() + inputFollower_.getHeapBytes();
 }
 
+//==============================================================================
+juce::MemoryBlock BreathLeadProcessor::saveDspCheckpoint() const
+{
+    // Released: there is no engine state to save
+    if (!arena_.isAllocated())
+        return {};
+
+    const auto write = [this](breath::CheckpointWriter& w) {
+        breath::checkpoint::write_header(w, getSampleRate());
+        if (isUsingDoublePrecision())
+            synthDouble_.saveState(w);
+        else
+            synth_.saveState(w);
+        ambience_.saveState(w);
+
+        if (isUsingDoublePrecision())
+            blocksDouble_.saveState(w);
+        else
+            blocks_.saveState(w);
+        w.put(numPendingMidi_);
+        w.putBytes(pendingMidi_, sizeof(PendingMidi) * size_t(numPendingMidi_));
+        w.put(inputDelay_);
+
+        w.put(sound_); w.put(lastHostValues_);
+        w.put(morphSmoother_); w.put(morphPosition_); w.put(lastMorphParam_); w.put(morphing_);
+    };
+
+    // Measure, then fill
+    breath::CheckpointWriter measure(nullptr, 0);
+    write(measure);
+
+    juce::MemoryBlock block(measure.size());
+    breath::CheckpointWriter writer(static_cast<uint8_t*>(block.getData()), block.getSize());
+    write(writer);
+    return block;
+}
+
+bool BreathLeadProcessor::restoreDspCheckpoint(const void* data, size_t size)
+{
+    if (!arena_.isAllocated())
+        return false;
+
+    breath::CheckpointReader reader(static_cast<const uint8_t*>(data), size);
+
+    const bool useDouble = isUsingDoublePrecision();
+    bool restored = breath::checkpoint::read_header(reader, getSampleRate())
+                 && (useDouble ? synthDouble_.restoreState(reader) : synth_.restoreState(reader))
+                 && ambience_.restoreState(reader)
+                 && (useDouble ? blocksDouble_.restoreState(reader) : blocks_.restoreState(reader));
+
+    int numPending = 0;
+    restored = restored && reader.get(numPending) && numPending >= 0 && numPending <= kMaxPendingMidi
+            && reader.getBytes(pendingMidi_, sizeof(PendingMidi) * size_t(numPending))
+            && reader.get(inputDelay_) && inputDelay_ >= 0 && inputDelay_ <= kInputRingSize / 2
+            && reader.get(sound_) && reader.get(lastHostValues_)
+            && reader.get(morphSmoother_) && reader.get(morphPosition_)
+            && reader.get(lastMorphParam_) && reader.get(morphing_)
+            && reader.atEnd();
+    numPendingMidi_ = restored ? numPending : 0;
+    if (!restored)
+        inputDelay_ = getInputDelay();
+
+    // The MPE parameter only acts on changes; match the restored zone
+    if (useDouble)
+        mpeSwitchDouble_ = synthDouble_.isMpeEnabled();
+    else
+        mpeSwitch_ = synth_.isMpeEnabled();
+    return restored;
+}
+
+#if BREATHLEAD_PROFILING
+bool BreathLeadProcessor::dumpProfile(const juce::File& file) const
+{
+    char text[2048];
+    const int length = breath::BlockProfiler::formatReport(profiler_.getReport(), text, sizeof(text));
+    return file.replaceWithText(juce::String::fromUTF8(text, length));
+}
+#endif
+
 void BreathLeadProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                        juce::MidiBuffer& midiMessages)
 {
+    renderBlock(synth_, buffer, midiMessages);
+}
+
+void BreathLeadProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                       juce::MidiBuffer& midiMessages)
+{
+    renderBlock(synthDouble_, buffer, midiMessages);
+}
+
+template <typename Synth, typename Sample>
+void BreathLeadProcessor::renderBlock(Synth& synth, juce::AudioBuffer<Sample>& buffer,
+                                      juce::MidiBuffer& midiMessages)
+{
+    const breath::ScopedRealtimeSection realtimeSection;
     juce::ScopedNoDenormals noDenormals;
 
+    // Released (or the allocation failed), or a precision this synth was
+    // not prepared for: nothing to render into
+    if (!arena_.isAllocated() || isUsingDoublePrecision() != std::is_same_v<Sample, double>) {
+        buffer.clear();
+        return;
+    }
+
+#if BREATHLEAD_PROFILING
+    const auto profileStart = profiler_.beginBlock();
+#endif
+
+    const auto governorStart = governor_.beginBlock();
+
     const int numSamples = buffer.getNumSamples();
     const int numChannels = buffer.getNumChannels();
 
-    // Clear output
-    for (int ch = 0; ch < numChannels; ++ch)
+    // Program changes arrive preparsed through the mailbox
+    breath::PresetSnapshot program;
+    if (pendingProgram_.consume(program))
+        sound_ = program;
+
+    applyQualityTier();
+    updateSynthParameters(synth);
+
+    Sample* outL = buffer.getWritePointer(0);
+    Sample* outR = numChannels > 1 ? buffer.getWritePointer(1) : outL;
+
+    // Air + Pitch delays MIDI and air by the tracker's hop; queued MIDI
+    // moves with the delay (clamped, so it stays in order)
+    const int inputDelay = getInputDelay();
+    if (inputDelay != inputDelay_) {
+        for (int i = 0; i < numPendingMidi_; ++i)
+            pendingMidi_[i].position = juce::jmax(0, pendingMidi_[i].position + inputDelay - inputDelay_);
+        inputDelay_ = inputDelay;
+        latencySamples_ = getBlockRenderer<Sample>().getLatencySamples() + inputDelay;
+    }
+
+    // Queue this block's MIDI behind what the last one carried over
+    // (longer messages mean nothing to the synth; with morph on, CC16
+    // sweeps it, otherwise CC16 goes to the synth like any controller)
+    const bool morphing = morphOnParam_->load() >= 0.5f;
+    for (const auto metadata : midiMessages)
+    {
+        if (morphing && metadata.numBytes == 3 && (metadata.data[0] & 0xF0) == 0xB0
+            && metadata.data[1] == kMorphController) {
+            morphPosition_ = metadata.data[2] / 127.0f;
+            continue;
+        }
+
+        if (metadata.numBytes > 3)
+            continue;
+
+        if (numPendingMidi_ == kMaxPendingMidi) {
+            midiDropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto& pending = pendingMidi_[numPendingMidi_++];
+        pending.position = juce::jlimit(0, numSamples, metadata.samplePosition) + inputDelay_;
+        pending.numBytes = metadata.numBytes;
+        std::copy(metadata.data, metadata.data + metadata.numBytes, pending.data);
+    }
+
+    // Morph: macro moves win over an earlier CC, and vice versa
+    const float morphParam = morphParam_->load();
+    if (morphParam != lastMorphParam_)
+        morphPosition_ = lastMorphParam_ = morphParam;
+
+    if (morphing && !morphing_)
+        morphSmoother_.reset(sound_);
+    morphing_ = morphing;
+
+    // Audio input: followed a span at a time, before the engine writes
+    // the span (the input shares the buffer)
+    const int numInputs = juce::jmin(getTotalNumInputChannels(), numChannels);
+    inputMode_ = juce::roundToInt(inputModeParam_->load());
+    followInput_ = inputMode_ != InputOff && numInputs > 0;
+    inputFollower_.setSensitivity(inputSensParam_->load());
+
+    // Fixed blocks on the engine's grid; each takes the MIDI due in it
+    int next = 0;
+    for (int spanStart = 0; spanStart < numSamples; spanStart += kMaxSpan)
+    {
+        const int span = juce::jmin(kMaxSpan, numSamples - spanStart);
+        if (followInput_)
+            followInput(buffer, numInputs, spanStart, span);
+
+        getBlockRenderer<Sample>().process(outL + spanStart, outR + spanStart, span,
+                                           [&](int start, Sample* left, Sample* right, int n) {
+                                               next = renderInternalBlock(synth, next, spanStart + start,
+                                                                          left, right, n);
+                                           });
+    }
+    inputClock_ += numSamples;
+
+    // Carry the rest into the next block
+    const int carried = numPendingMidi_ - next;
+    for (int i = 0; i < carried; ++i)
+    {
+        pendingMidi_[i] = pendingMidi_[next + i];
+        pendingMidi_[i].position -= numSamples;
+    }
+    numPendingMidi_ = carried;
+
+    // Preset audition, read straight from the mapped preview cache
+    juce::uint64 auditionKey = 0;
+    if (pendingAudition_.consume(auditionKey)) {
+        previewCache_.releasePreview(audition_);
+        if (auditionKey != 0)
+            audition_ = previewCache_.acquirePreview(auditionKey);
+        auditionPosition_ = 0.0;
+    }
+
+    if (audition_.isValid())
+        playAudition(outL, outR != outL ? outR : nullptr, numSamples);
+
+    for (int ch = 2; ch < numChannels; ++ch)
         buffer.clear(ch, 0, numSamples);
 
-    // Process MIDI
-    for (const auto metadata : midiMessages) {
-        if (metadata.numBytes < 3) continue;
+    // Offline renders are not time-critical; keep them at Full and repeatable
+    if (!isNonRealtime())
+        governor_.endBlock(governorStart, numSamples);
 
-        const auto message = metadata.getMessage();
+#if BREATHLEAD_PROFILING
+    profiler_.endBlock(profileStart, numSamples, midiMessages.getNumEvents(),
+                       synth.getActiveVoiceCount());
+#endif
+}
 
-        if (message.isNoteOn()) {
-            const int noteNumber = message.getNoteNumber();
-            const float velocity = message.getVelocity() / 127.f;
+// One piece of a grid block starting at host offset `start`. MIDI due
+// before its end is applied on its sample; breath controllers are
+// timestamped into the synth's queue instead, so dense controller streams
+// don't fragment the block.
+template <typename Synth, typename Sample>
+int BreathLeadProcessor::renderInternalBlock(Synth& synth, int next, int start,
+                                             Sample* left, Sample* right, int numSamples)
+{
+    synth.beginBlock();
 
-            voice_.noteOn(440.f * std::pow(2.f, (noteNumber - 69) / 12.f), velocity);
-            lastNoteNumber_ = noteNumber;
-            lastVelocity_ = velocity;
-            noteIsOn_ = true;
+    // Control block: interpolate the morph endpoints, glide the sound there
+    if (morphing_) {
+        morphSmoother_.setTarget(morpher_.evaluate(morphPosition_));
+        sound_ = morphSmoother_.tick();
+        synth.setParameters(makeSynthParameters());
+    }
+
+    // Input level replaces note velocity as breath pressure, and plays a
+    // voice by itself while no note is held; the tracked pitch (once there
+    // is one) replaces the notes' pitch. Air is read inputDelay_ samples
+    // back; the pitch read now has analysed that far.
+    float inputAir[breath::kProcessBlock];
+    const float* pressure = nullptr;
+    float pitch = 0.0f;
+    if (followInput_) {
+        const juce::int64 airStart = inputClock_ + start - inputDelay_;
+        for (int i = 0; i < numSamples; ++i)
+            inputAir[i] = inputAir_[size_t(airStart + i) & (kInputRingSize - 1)];
+        pressure = inputAir;
+        if (inputMode_ == InputAirPitch)
+            pitch = inputPitch_[size_t(inputClock_ + start) & (kInputRingSize - 1)];
+    }
+    synth.setPitchOverride(pitch);
+
+    int rendered = 0;
+    for (; next < numPendingMidi_ && pendingMidi_[next].position < start + numSamples; ++next)
+    {
+        const auto& midi = pendingMidi_[next];
+        const int position = juce::jmax(0, midi.position - start);
+
+        if (midi.numBytes == 3 && (midi.data[0] & 0xF0) == 0xB0
+            && synth.getBreathInput().accepts(midi.data[1])) {
+            synth.queueBreathController(position, midi.data[1], midi.data[2]);
+            continue;
         }
-        else if (message.isNoteOff()) {
-            voice_.noteOff();
-            noteIsOn_ = false;
+
+        if (position > rendered) {
+            synth.render(left + rendered, right + rendered, position - rendered,
+                         pressure != nullptr ? pressure + rendered : nullptr);
+            rendered = position;
         }
-        else if (message.isPitchWheel()) {
-            // Pitch bend ±2 semitones (expressive, not synthy)
-            const float bend = message.getPitchWheelValue() / 8192.f - 1.f; // -1 to 1
-            const float semitones = bend * 2.f;
-            if (lastNoteNumber_ >= 0) {
-                const float baseFreq = 440.f * std::pow(2.f, (lastNoteNumber_ - 69) / 12.f);
-                voice_.freq = baseFreq * std::pow(2.f, semitones / 12.f);
-            }
+        synth.handleMidi(midi.data, midi.numBytes);
+    }
+
+    if (rendered < numSamples)
+        synth.render(left + rendered, right + rendered, numSamples - rendered,
+                     pressure != nullptr ? pressure + rendered : nullptr);
+
+    const auto gain = static_cast<Sample>(sound_.masterGain);
+    for (int i = 0; i < numSamples; ++i) {
+        left[i] *= gain;
+        right[i] *= gain;
+    }
+
+    ambience_.process(left, right, numSamples);
+    return next;
+}
+
+// Mono mix of the input span → per-sample air and pitch in the input rings
+template <typename Sample>
+void BreathLeadProcessor::followInput(const juce::AudioBuffer<Sample>& buffer, int numInputs,
+                                      int start, int numSamples)
+{
+    constexpr int kChunk = breath::AudioBreathFollower::kMaxChunk;
+    const float inputScale = 1.0f / float(numInputs);
+
+    for (int pos = 0; pos < numSamples; pos += kChunk)
+    {
+        const int n = juce::jmin(kChunk, numSamples - pos);
+        float mono[kChunk] = {};
+        for (int channel = 0; channel < numInputs; ++channel) {
+            const Sample* in = buffer.getReadPointer(channel, start + pos);
+            for (int i = 0; i < n; ++i)
+                mono[i] += float(in[i]) * inputScale;
         }
-        else if (message.isControllerOfType(0x01)) { // Mod wheel
-            // Mod wheel → air pressure
-            const float modValue = message.getControllerValue() / 127.f;
-            voice_.envelope.target = modValue * voice_.air;
+
+        float air[kChunk];
+        inputFollower_.process(mono, air, n, inputMode_ == InputAirPitch);
+        const float pitch = inputFollower_.getFrequency();
+
+        for (int i = 0; i < n; ++i) {
+            const size_t index = size_t(inputClock_ + start + pos + i) & (kInputRingSize - 1);
+            inputAir_[index] = air[i];
+            inputPitch_[index] = pitch;
         }
-        else if (message.isChannelPressure()) {
-            // Aftertouch → resistance / brightness
-            const float pressure = message.getChannelPressureValue() / 127.f;
-            voice_.resistance = 0.3f + pressure * 0.5f; // 0.3 to 0.8
-            voice_.tone = 0.3f + pressure * 0.4f;      // 0.3 to 0.7 (brighter with more pressure)
+    }
+}
+
+// Adds the audition preview to the output. Previews are mono at
+// PresetPreviewCache::kSampleRate; read with linear interpolation.
+template <typename Sample>
+void BreathLeadProcessor::playAudition(Sample* left, Sample* right, int numSamples)
+{
+    const double step = PresetPreviewCache::kSampleRate / preparedRate_;
+    const float* samples = audition_.samples;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int index = static_cast<int>(auditionPosition_);
+        if (index + 1 >= audition_.numFrames) {
+            previewCache_.releasePreview(audition_);
+            return;
         }
+
+        const float frac = static_cast<float>(auditionPosition_ - index);
+        const float sample = samples[index] + (samples[index + 1] - samples[index]) * frac;
+
+        left[i] += sample;
+        if (right != nullptr)
+            right[i] += sample;
+
+        auditionPosition_ += step;
     }
+}
+
+template <typename Sample>
+breath::FixedBlockRenderer<Sample>& BreathLeadProcessor::getBlockRenderer()
+{
+    if constexpr (std::is_same_v<Sample, double>)
+        return blocksDouble_;
+    else
+        return blocks_;
+}
 
-    // Process audio
-    float* outL = buffer.getWritePointer(0);
-    float* outR = numChannels > 1 ? buffer.getWritePointer(1) : outL;
+// Only host values that moved since the last block are forwarded, so a
+// program applied from the mailbox isn't immediately overwritten by the
+// unchanged knob positions
+template <typename Synth>
+void BreathLeadProcessor::updateSynthParameters(Synth& synth)
+{
+    const auto host = getHostSnapshot();
+    if (host.air != lastHostValues_.air)                sound_.air = host.air;
+    if (host.tone != lastHostValues_.tone)              sound_.tone = host.tone;
+    if (host.formant != lastHostValues_.formant)        sound_.formant = host.formant;
+    if (host.resistance != lastHostValues_.resistance)  sound_.resistance = host.resistance;
+    if (host.vibrato != lastHostValues_.vibrato)        sound_.vibrato = host.vibrato;
+    if (host.masterGain != lastHostValues_.masterGain)  sound_.masterGain = host.masterGain;
+    if (host.engine != lastHostValues_.engine)          sound_.engine = host.engine;
+    lastHostValues_ = host;
 
-    for (int i = 0; i < numSamples; ++i) {
-        voice_.process(outL[i], outR[i]);
+    synth.setParameters(makeSynthParameters());
+
+    ambience_.setMix(ambienceEnabled_ ? roomParam_->load() : 0.0f);
+    ambience_.setSize(roomSizeParam_->load());
+
+    // Breath, + expression, + mod wheel; a change releases the stream
+    using Input = breath::BreathControllerInput;
+    static constexpr int kBreathSources[] = {
+        Input::kBreath,
+        Input::kBreath | Input::kExpression,
+        Input::kBreath | Input::kExpression | Input::kModWheel
+    };
+    synth.setBreathSources(kBreathSources[juce::jlimit(0, 2, juce::roundToInt(breathInParam_->load()))]);
+
+    // Only follow the switch when it moves, so an MPE Configuration
+    // Message from the controller is not overridden every block
+    bool& mpeSwitch = std::is_same_v<Synth, breath::BreathLeadSynthDouble> ? mpeSwitchDouble_ : mpeSwitch_;
+    const bool mpe = mpeParam_->load() >= 0.5f;
+    if (mpe != mpeSwitch) {
+        mpeSwitch = mpe;
+        synth.setMpeEnabled(mpe);
     }
 }
 
+breath::SynthParameters BreathLeadProcessor::makeSynthParameters() const
+{
+    breath::SynthParameters params;
+    params.air = sound_.air;
+    params.tone = sound_.tone;
+    params.formant = sound_.formant;
+    params.resistance = sound_.resistance;
+    params.vibrato = sound_.vibrato;
+    params.engine = static_cast<breath::ResonanceEngine>(juce::jlimit(0, 2, sound_.engine));
+    params.envelope.attackMs = attackParam_->load();
+    params.envelope.swellMs = swellParam_->load();
+    params.envelope.sustain = sustainParam_->load();
+    params.envelope.releaseMs = releaseParam_->load();
+    params.envelope.attackCurve = attackCurveParam_->load();
+    params.envelope.swellCurve = swellCurveParam_->load();
+    params.envelope.releaseCurve = releaseCurveParam_->load();
+    return params;
+}
+
+void BreathLeadProcessor::applyQualityTier()
+{
+    const auto& quality = isNonRealtime() ? breath::quality_settings(breath::QualityTier::Full)
+                                          : governor_.getSettings();
+
+    // All three are click-free: the synth re-times its smoothers at the next
+    // control tick, the voice limit only affects new notes, and the room
+    // fades over its mix smoother
+    synth_.setControlInterval(quality.controlInterval);
+    synth_.setVoiceLimit(quality.voiceLimit);
+    synthDouble_.setControlInterval(quality.controlInterval);
+    synthDouble_.setVoiceLimit(quality.voiceLimit);
+    ambienceEnabled_ = quality.ambience;
+}
+
 //==============================================================================
 juce::AudioProcessorEditor* BreathLeadProcessor::createEditor()
 {
@@ -115,39 +603,313 @@ juce::AudioProcessorEditor* BreathLeadProcessor::createEditor()
 }
 
 //==============================================================================
-void BreathLeadProcessor::getStateInformation(juce::MemoryBlock& destData)
+int BreathLeadProcessor::getNumPrograms()
 {
-    // Save parameters
-    auto state = parameters_.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    return static_cast<int>(factoryPresets_.size()) + presetLibrary_.getNumPresets();
 }
 
-void BreathLeadProcessor::setStateInformation(const void* data, int sizeInBytes)
+void BreathLeadProcessor::setCurrentProgram(int index)
+{
+    if (index < 0 || index >= getNumPrograms())
+        return;
+
+    currentProgram_ = index;
+
+    // The host may call this from the audio thread. Reading the library
+    // there would take its lock, and could drop the last reference to an
+    // index it just replaced (freeing it), so the timer applies it instead
+    if (!juce::MessageManager::existsAndIsCurrentThread()) {
+        requestedProgram_ = index;
+        return;
+    }
+
+    requestedProgram_ = -1;
+    applyProgram(index);
+}
+
+// Message thread
+void BreathLeadProcessor::applyProgram(int index)
+{
+    breath::PresetSnapshot snapshot;
+    if (!getProgramSnapshot(index, snapshot))
+        return;
+
+    syncHostParameters(snapshot);
+    publishProgram(snapshot);
+}
+
+void BreathLeadProcessor::publishProgram(const breath::PresetSnapshot& snapshot)
 {
-    // Restore parameters
-    std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
+    const juce::SpinLock::ScopedLockType lock(programPublishLock_);
+    pendingProgram_.publish(snapshot);
+}
+
+const juce::String BreathLeadProcessor::getProgramName(int index)
+{
+    const int numFactory = static_cast<int>(factoryPresets_.size());
+
+    if (index >= 0 && index < numFactory)
+        return factoryPresets_[static_cast<size_t>(index)].name;
+
+    return presetLibrary_.getPresetName(index - numFactory);
+}
+
+void BreathLeadProcessor::changeProgramName(int index, const juce::String& name)
+{
+    if (index >= 0 && index < static_cast<int>(factoryPresets_.size()))
+        factoryPresets_[static_cast<size_t>(index)].name = name;
+}
+
+bool BreathLeadProcessor::getProgramSnapshot(int index, breath::PresetSnapshot& out) const
+{
+    const int numFactory = static_cast<int>(factoryPresets_.size());
 
-    if (xml != nullptr && xml->hasTagName(parameters_.state.getType())) {
-        parameters_.replaceState(juce::ValueTree::fromXml(*xml));
+    if (index >= 0 && index < numFactory) {
+        out = factoryPresets_[static_cast<size_t>(index)].values;
+        return true;
     }
+
+    return presetLibrary_.getPreset(index - numFactory, out);
+}
+
+void BreathLeadProcessor::loadFactoryPresets()
+{
+    //                 air   tone  formant resist vibrato master
+    factoryPresets_ = {
+        { "Soft Flute",          { 0.4f, 0.3f, 0.5f, 0.3f, 0.2f, 0.6f, 0 } },
+        { "Expressive Clarinet", { 0.6f, 0.5f, 0.6f, 0.5f, 0.3f, 0.7f, 0 } },
+        { "Breathy Vocal",       { 0.7f, 0.6f, 0.4f, 0.4f, 0.4f, 0.7f, 0 } },
+        { "Wind Chime",          { 0.3f, 0.8f, 0.7f, 0.2f, 0.0f, 0.5f, 0 } },
+        { "Ambient Pad",         { 0.8f, 0.4f, 0.3f, 0.6f, 0.1f, 0.7f, 0 } },
+        { "Ethereal",            { 0.5f, 0.7f, 0.5f, 0.3f, 0.5f, 0.6f, 0 } },
+        { "Classical Flute",     { 0.5f, 0.5f, 0.6f, 0.4f, 0.3f, 0.7f, 0 } },
+        { "Saxophone",           { 0.7f, 0.4f, 0.5f, 0.6f, 0.4f, 0.8f, 0 } },
+        { "Oboe",                { 0.6f, 0.6f, 0.7f, 0.5f, 0.3f, 0.7f, 0 } },
+        { "Breath Controller",   { 1.0f, 0.5f, 0.5f, 0.5f, 0.2f, 0.7f, 0 } },
+    };
+}
+
+breath::PresetSnapshot BreathLeadProcessor::getHostSnapshot() const
+{
+    return { airParam_->load(), toneParam_->load(), formantParam_->load(),
+             resistanceParam_->load(), vibratoParam_->load(), masterParam_->load(),
+             juce::roundToInt(engineParam_->load()) };
+}
+
+void BreathLeadProcessor::syncHostParameters(const breath::PresetSnapshot& snapshot)
+{
+    setParameterValue("air", snapshot.air);
+    setParameterValue("tone", snapshot.tone);
+    setParameterValue("formant", snapshot.formant);
+    setParameterValue("resistance", snapshot.resistance);
+    setParameterValue("vibrato", snapshot.vibrato);
+    setParameterValue("master", snapshot.masterGain);
+    setParameterValue("engine", static_cast<float>(snapshot.engine));
+}
+
+void BreathLeadProcessor::setParameterValue(const juce::String& parameterID, float value)
+{
+    if (auto* parameter = parameters_.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Endpoints selected by the Morph A/B/C parameters (programs are 1-based,
+// Morph C = 0 is unused)
+void BreathLeadProcessor::loadMorphEndpoints()
+{
+    const int programs[] = { juce::roundToInt(morphAParam_->load()),
+                             juce::roundToInt(morphBParam_->load()),
+                             juce::roundToInt(morphCParam_->load()) };
+    int numEndpoints = 0;
+
+    for (int program : programs)
+    {
+        if (program <= 0)
+            continue;
+
+        if (program != loadedMorphPrograms_[numEndpoints]) {
+            breath::PresetSnapshot snapshot;
+            if (!getProgramSnapshot(program - 1, snapshot))
+                continue; // Not indexed (yet)
+
+            morpher_.loadEndpoint(numEndpoints, snapshot);
+            loadedMorphPrograms_[numEndpoints] = program;
+        }
+
+        ++numEndpoints;
+    }
+
+    morpher_.setNumEndpoints(numEndpoints);
+}
+
+void BreathLeadProcessor::timerCallback()
+{
+    // A program change the host made off the message thread
+    const int requested = requestedProgram_.exchange(-1);
+    if (requested >= 0)
+        applyProgram(requested);
+
+    loadMorphEndpoints();
+
+    // Latency changes with the input mode; report it from here
+    const int latency = latencySamples_.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+// Samples MIDI and air run late for the input mode: one tracker hop in
+// Air + Pitch, none otherwise
+int BreathLeadProcessor::getInputDelay() const
+{
+    return juce::roundToInt(inputModeParam_->load()) == InputAirPitch
+        ? inputFollower_.getLatencySamples() : 0;
+}
+
+// Every program goes to the preview cache; only programs whose values
+// changed are rendered again
+void BreathLeadProcessor::updatePreviewCache()
+{
+    std::vector<breath::PresetSnapshot> programs;
+    programs.reserve(static_cast<size_t>(getNumPrograms()));
+
+    for (int i = 0; i < getNumPrograms(); ++i) {
+        breath::PresetSnapshot snapshot;
+        if (getProgramSnapshot(i, snapshot))
+            programs.push_back(snapshot);
+    }
+
+    previewCache_.setPresets(std::move(programs));
 }
 
 //==============================================================================
-void BreathLeadProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+bool BreathLeadProcessor::auditionProgram(int index)
+{
+    breath::PresetSnapshot snapshot;
+    if (!getProgramSnapshot(index, snapshot))
+        return false;
+
+    if (!previewCache_.hasPreview(snapshot))
+        return false;
+
+    publishAudition(PresetPreviewCache::makeKey(snapshot));
+    return true;
+}
+
+void BreathLeadProcessor::stopAudition()
+{
+    publishAudition(0);
+}
+
+bool BreathLeadProcessor::isPreviewReady(int index) const
+{
+    breath::PresetSnapshot snapshot;
+    return getProgramSnapshot(index, snapshot) && previewCache_.hasPreview(snapshot);
+}
+
+void BreathLeadProcessor::publishAudition(juce::uint64 key)
 {
-    // Update voice parameters
-    if (parameterID == "air") {
-        voice_.air = newValue;
-    } else if (parameterID == "tone") {
-        voice_.tone = newValue;
-    } else if (parameterID == "formant") {
-        voice_.formantParam = newValue;
-    } else if (parameterID == "resistance") {
-        voice_.resistance = newValue;
-    } else if (parameterID == "vibrato") {
-        voice_.vibratoDepth = newValue;
+    const juce::SpinLock::ScopedLockType lock(auditionPublishLock_);
+    pendingAudition_.publish(key);
+}
+
+//==============================================================================
+void BreathLeadProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    // Current program and parameters (compact binary, see PluginState.h)
+    breath::PluginState state;
+    state.air = airParam_->load();
+    state.tone = toneParam_->load();
+    state.formant = formantParam_->load();
+    state.resistance = resistanceParam_->load();
+    state.vibrato = vibratoParam_->load();
+    state.masterGain = masterParam_->load();
+    state.engine = juce::roundToInt(engineParam_->load());
+    state.program = currentProgram_;
+    state.inputMode = juce::roundToInt(inputModeParam_->load());
+    state.inputSensitivity = inputSensParam_->load();
+    state.morphOn = morphOnParam_->load() >= 0.5f ? 1 : 0;
+    state.morphPosition = morphParam_->load();
+    state.morphA = juce::roundToInt(morphAParam_->load());
+    state.morphB = juce::roundToInt(morphBParam_->load());
+    state.morphC = juce::roundToInt(morphCParam_->load());
+    state.roomMix = roomParam_->load();
+    state.roomSize = roomSizeParam_->load();
+    state.attack = attackParam_->load();
+    state.swell = swellParam_->load();
+    state.sustain = sustainParam_->load();
+    state.release = releaseParam_->load();
+    state.attackCurve = attackCurveParam_->load();
+    state.swellCurve = swellCurveParam_->load();
+    state.releaseCurve = releaseCurveParam_->load();
+    state.mpe = mpeParam_->load() >= 0.5f ? 1 : 0;
+    state.breathSources = juce::roundToInt(breathInParam_->load());
+
+    juce::uint8 encoded[breath::state::kMaxEncodedSize];
+    const auto size = breath::state::encode(state, encoded, sizeof(encoded));
+    destData.replaceAll(encoded, size);
+}
+
+void BreathLeadProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    breath::PluginState state;
+
+    if (breath::state::has_magic(data, size_t(sizeInBytes))) {
+        if (!breath::state::decode(data, size_t(sizeInBytes), state))
+            return; // Corrupt or from an incompatible future version
+    } else if (!readLegacyState(data, sizeInBytes, state)) {
+        return;
     }
+
+    // Values are clamped to each parameter's range by convertTo0to1()
+    setParameterValue("air", state.air);
+    setParameterValue("tone", state.tone);
+    setParameterValue("formant", state.formant);
+    setParameterValue("resistance", state.resistance);
+    setParameterValue("vibrato", state.vibrato);
+    setParameterValue("master", state.masterGain);
+    setParameterValue("engine", static_cast<float>(state.engine));
+    setParameterValue("input", static_cast<float>(state.inputMode));
+    setParameterValue("inputSens", state.inputSensitivity);
+    setParameterValue("morphOn", state.morphOn != 0 ? 1.0f : 0.0f);
+    setParameterValue("morph", state.morphPosition);
+    setParameterValue("morphA", static_cast<float>(state.morphA));
+    setParameterValue("morphB", static_cast<float>(state.morphB));
+    setParameterValue("morphC", static_cast<float>(state.morphC));
+    setParameterValue("room", state.roomMix);
+    setParameterValue("roomSize", state.roomSize);
+    setParameterValue("attack", state.attack);
+    setParameterValue("swell", state.swell);
+    setParameterValue("sustain", state.sustain);
+    setParameterValue("release", state.release);
+    setParameterValue("attackCurve", state.attackCurve);
+    setParameterValue("swellCurve", state.swellCurve);
+    setParameterValue("releaseCurve", state.releaseCurve);
+    setParameterValue("mpe", state.mpe != 0 ? 1.0f : 0.0f);
+    setParameterValue("breathIn", static_cast<float>(state.breathSources));
+
+    // The library may hold fewer presets than when the state was saved
+    currentProgram_ = juce::jlimit(0, getNumPrograms() - 1, state.program);
+
+    // The restored parameter values (not the program) define the sound
+    publishProgram(getHostSnapshot());
+}
+
+// States saved before the binary format (ValueTree stream, version 0).
+// Missing properties keep the PluginState defaults.
+bool BreathLeadProcessor::readLegacyState(const void* data, int sizeInBytes, breath::PluginState& state)
+{
+    const auto tree = juce::ValueTree::readFromData(data, size_t(sizeInBytes));
+    if (!tree.isValid())
+        return false;
+
+    state.air = tree.getProperty("air", state.air);
+    state.tone = tree.getProperty("tone", state.tone);
+    state.formant = tree.getProperty("formant", state.formant);
+    state.resistance = tree.getProperty("resistance", state.resistance);
+    state.vibrato = tree.getProperty("vibrato", state.vibrato);
+    state.masterGain = tree.getProperty("master", state.masterGain);
+    state.program = tree.getProperty("preset", state.program);
+    return true;
 }
 
 //==============================================================================
@@ -160,16 +922,83 @@ juce::AudioProcessorValueTreeState::ParameterLayout BreathLeadProcessor::createP
         "air", "Air", 0.0f, 1.0f, 0.5f));
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        "tone", "Tone", 0.0f, 1.0f, 0.6f));
+        "tone", "Tone", 0.0f, 1.0f, 0.5f));
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "formant", "Formant", 0.0f, 1.0f, 0.5f));
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        "resistance", "Resistance", 0.0f, 1.0f, 0.4f));
+        "resistance", "Resistance", 0.0f, 1.0f, 0.5f));
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "vibrato", "Vibrato", 0.0f, 1.0f, 0.0f));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "master", "Master", 0.0f, 1.0f, 0.7f));
+
+    // Resonance engine (per preset)
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "engine", "Engine", juce::StringArray { "Formant", "Flute Bore", "Clarinet Bore" }, 0));
+
+    // Audio input (mic breath follower)
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "input", "Audio Input", juce::StringArray { "Off", "Air", "Air + Pitch" }, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "inputSens", "Input Sensitivity", 0.0f, 1.0f, 0.5f));
+
+    // Room / body ambience (shared by all voices)
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "room", "Room", 0.0f, 1.0f, 0.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "roomSize", "Room Size", 0.0f, 1.0f, 0.4f));
+
+    // Pressure envelope (attack → breath swell → sustain, release)
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "attack", "Attack", juce::NormalisableRange<float>(1.0f, 1000.0f, 0.0f, 0.4f), 90.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "swell", "Swell", juce::NormalisableRange<float>(0.0f, 2000.0f, 0.0f, 0.4f), 200.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "sustain", "Sustain", 0.25f, 1.5f, 1.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "release", "Release", juce::NormalisableRange<float>(10.0f, 3000.0f, 0.0f, 0.4f), 360.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "attackCurve", "Attack Curve", -1.0f, 1.0f, 0.6f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "swellCurve", "Swell Curve", -1.0f, 1.0f, 0.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "releaseCurve", "Release Curve", -1.0f, 1.0f, 0.6f));
+
+    // Preset morph (macro + CC16 sweep across up to three programs)
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "morphOn", "Morph", false));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "morph", "Morph Position", 0.0f, 1.0f, 0.0f));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        "morphA", "Morph A", 1, 128, 1));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        "morphB", "Morph B", 1, 128, 8));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        "morphC", "Morph C", 0, 128, 0));
+
+    // Performance (not on the front panel)
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "mpe", "MPE", false));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "breathIn", "Breath Input",
+        juce::StringArray { "Breath (CC2)", "Breath + Expression", "Breath + Expression + Mod Wheel" }, 0));
+
     return { params.begin(), params.end() };
 }
@@ -0,0 +1,303 @@
+/*
+  PresetLibrary.cpp - Background preset scanning + binary index cache
+*/
+
+#include "plugin/PresetLibrary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+namespace
+{
+    static_assert(std::is_trivially_copyable_v<PresetLibrary::Entry>);
+
+    //==============================================================================
+    // Cache file layout (native endian, machine-local):
+    //   CacheHeader, then `count` raw Entry records
+    struct CacheHeader
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::uint32 entrySize;
+        juce::uint32 count;
+    };
+
+    constexpr char kCacheMagic[4] = { 'B', 'L', 'P', 'I' };
+    constexpr juce::uint32 kCacheVersion = 2;
+
+    // FNV-1a over the full path
+    juce::uint64 hashPath(const juce::String& path)
+    {
+        juce::uint64 hash = 14695981039346656037ULL;
+        for (auto* p = path.toRawUTF8(); *p != 0; ++p)
+        {
+            hash ^= static_cast<juce::uint8>(*p);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void copyName(char* dest, size_t destSize, const juce::String& text)
+    {
+        text.copyToUTF8(dest, destSize);
+    }
+}
+
+//==============================================================================
+PresetLibrary::PresetLibrary(juce::Array<juce::File> searchRoots, juce::File cacheFile)
+    : juce::Thread("BreathLead preset scan"),
+      searchRoots_(std::move(searchRoots)),
+      cacheFile_(std::move(cacheFile)),
+      index_(std::make_shared<const Index>())
+{
+}
+
+PresetLibrary::~PresetLibrary()
+{
+    stopThread(2000);
+    cancelPendingUpdate();
+}
+
+juce::Array<juce::File> PresetLibrary::getDefaultSearchRoots()
+{
+    const auto vendorPath = juce::String("SchillingerEcosystem/BreathLead/Presets");
+
+    // Presets shipped with the plugin: Contents/Resources/presets inside
+    // the bundle, else the source tree's presets/presets (local builds)
+    auto bundled = juce::File::getSpecialLocation(juce::File::currentExecutableFile)
+                       .getParentDirectory().getSiblingFile("Resources").getChildFile("presets");
+#ifdef BREATHLEAD_BUNDLED_PRESET_DIR
+    if (!bundled.isDirectory())
+        bundled = juce::File(BREATHLEAD_BUNDLED_PRESET_DIR);
+#endif
+
+    return {
+        bundled,
+        juce::File::getSpecialLocation(juce::File::commonApplicationDataDirectory).getChildFile(vendorPath),
+        juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile(vendorPath)
+    };
+}
+
+juce::File PresetLibrary::getDefaultCacheFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("SchillingerEcosystem/BreathLead/PresetIndex.bin");
+}
+
+//==============================================================================
+void PresetLibrary::startScan()
+{
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+}
+
+int PresetLibrary::getNumPresets() const
+{
+    return numPresets_.load(std::memory_order_acquire);
+}
+
+bool PresetLibrary::getPreset(int index, breath::PresetSnapshot& out) const
+{
+    const auto current = getIndex();
+    if (index < 0 || index >= static_cast<int>(current->size()))
+        return false;
+
+    out = (*current)[static_cast<size_t>(index)].values;
+    return true;
+}
+
+juce::String PresetLibrary::getPresetName(int index) const
+{
+    const auto current = getIndex();
+    if (index < 0 || index >= static_cast<int>(current->size()))
+        return {};
+
+    return juce::String::fromUTF8((*current)[static_cast<size_t>(index)].name);
+}
+
+juce::String PresetLibrary::getPresetCategory(int index) const
+{
+    const auto current = getIndex();
+    if (index < 0 || index >= static_cast<int>(current->size()))
+        return {};
+
+    return juce::String::fromUTF8((*current)[static_cast<size_t>(index)].category);
+}
+
+//==============================================================================
+void PresetLibrary::run()
+{
+    // 1. Publish the cached index straight away so browsing is instant
+    auto cached = loadCache();
+    if (cached != nullptr && !cached->empty())
+        publish(cached);
+
+    std::unordered_map<juce::uint64, const Entry*> cachedByPath;
+    if (cached != nullptr)
+        for (const auto& entry : *cached)
+            cachedByPath.emplace(entry.pathHash, &entry);
+
+    // 2. Walk the folders; only parse files the cache doesn't vouch for
+    auto fresh = std::make_shared<Index>();
+    bool changed = cached == nullptr;
+
+    for (const auto& root : searchRoots_)
+    {
+        if (!root.isDirectory())
+            continue;
+
+        for (const auto& item : juce::RangedDirectoryIterator(root, true, "*.xml", juce::File::findFiles))
+        {
+            if (threadShouldExit())
+                return;
+
+            const auto& file = item.getFile();
+
+            Entry entry;
+            entry.pathHash = hashPath(file.getFullPathName());
+            entry.modificationTime = item.getModificationTime().toMilliseconds();
+            entry.fileSize = item.getFileSize();
+
+            const auto hit = cachedByPath.find(entry.pathHash);
+            if (hit != cachedByPath.end()
+                && hit->second->modificationTime == entry.modificationTime
+                && hit->second->fileSize == entry.fileSize)
+            {
+                fresh->push_back(*hit->second);
+                continue;
+            }
+
+            if (parsePresetFile(file, entry))
+            {
+                copyName(entry.category, sizeof(entry.category), file.getParentDirectory().getFileName());
+                fresh->push_back(entry);
+            }
+            changed = true;
+        }
+    }
+
+    if (cached != nullptr && fresh->size() != cached->size())
+        changed = true;
+
+    if (!changed)
+        return;
+
+    // Stable program order: category, then name
+    std::sort(fresh->begin(), fresh->end(), [](const Entry& a, const Entry& b)
+    {
+        if (const int c = std::strcmp(a.category, b.category); c != 0)
+            return c < 0;
+        return std::strcmp(a.name, b.name) < 0;
+    });
+
+    saveCache(*fresh);
+    publish(fresh);
+}
+
+void PresetLibrary::handleAsyncUpdate()
+{
+    if (onIndexChanged)
+        onIndexChanged();
+}
+
+//==============================================================================
+void PresetLibrary::publish(std::shared_ptr<const Index> index)
+{
+    const int size = static_cast<int>(index->size());
+    {
+        const juce::SpinLock::ScopedLockType lock(indexLock_);
+        index_.swap(index);
+    }
+    numPresets_.store(size, std::memory_order_release);
+
+    // Old index (now in `index`) is released here, outside the lock
+    triggerAsyncUpdate();
+}
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::getIndex() const
+{
+    const juce::SpinLock::ScopedLockType lock(indexLock_);
+    return index_;
+}
+
+//==============================================================================
+std::shared_ptr<PresetLibrary::Index> PresetLibrary::loadCache() const
+{
+    juce::MemoryBlock data;
+    if (!cacheFile_.loadFileAsData(data) || data.getSize() < sizeof(CacheHeader))
+        return nullptr;
+
+    CacheHeader header;
+    std::memcpy(&header, data.getData(), sizeof(header));
+
+    if (std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0
+        || header.version != kCacheVersion
+        || header.entrySize != sizeof(Entry)
+        || data.getSize() != sizeof(CacheHeader) + size_t(header.count) * sizeof(Entry))
+        return nullptr; // Stale layout: rebuild from the XML files
+
+    auto index = std::make_shared<Index>(header.count);
+    std::memcpy(index->data(), static_cast<const char*>(data.getData()) + sizeof(CacheHeader),
+                size_t(header.count) * sizeof(Entry));
+
+    // Entries are sanitised when parsed, so anything else is a damaged file
+    for (auto& entry : *index)
+    {
+        if (!breath::sanitise(entry.values)
+            || entry.name[sizeof(entry.name) - 1] != 0
+            || entry.category[sizeof(entry.category) - 1] != 0)
+            return nullptr;
+    }
+
+    return index;
+}
+
+void PresetLibrary::saveCache(const Index& index) const
+{
+    CacheHeader header;
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.entrySize = sizeof(Entry);
+    header.count = static_cast<juce::uint32>(index.size());
+
+    juce::MemoryBlock data;
+    data.append(&header, sizeof(header));
+    data.append(index.data(), index.size() * sizeof(Entry));
+
+    cacheFile_.getParentDirectory().createDirectory();
+    cacheFile_.replaceWithData(data.getData(), data.getSize());
+}
+
+bool PresetLibrary::parsePresetFile(const juce::File& file, Entry& entry)
+{
+    const auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr || !xml->hasTagName("PRESET"))
+        return false;
+
+    copyName(entry.name, sizeof(entry.name),
+             xml->getStringAttribute("name", file.getFileNameWithoutExtension()));
+
+    auto& v = entry.values;
+    if (const auto* values = xml->getChildByName("VALUES"))
+    {
+        for (const auto* param : values->getChildWithTagNameIterator("PARAM"))
+        {
+            const auto id = param->getStringAttribute("id");
+            const auto value = static_cast<float>(param->getDoubleAttribute("value"));
+
+            if (id == "air")             v.air = value;
+            else if (id == "tone")       v.tone = value;
+            else if (id == "formant")    v.formant = value;
+            else if (id == "resistance") v.resistance = value;
+            else if (id == "vibrato")    v.vibrato = value;
+            else if (id == "master")     v.masterGain = value;
+            else if (id == "engine")     v.engine = juce::jlimit (0, 2, juce::roundToInt (value));
+        }
+    }
+
+    // Out-of-range or NaN values never reach the voices
+    breath::sanitise(v);
+    return true;
+}
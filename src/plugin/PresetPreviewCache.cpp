@@ -0,0 +1,413 @@
+/*
+  PresetPreviewCache.cpp - Background preview rendering + mapped cache file
+*/
+
+#include "plugin/PresetPreviewCache.h"
+#include "dsp/BreathLeadSynth.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    //==============================================================================
+    // Cache file layout (native endian, machine-local):
+    //   FileHeader, `count` TableEntry records sorted by key, then each
+    //   preview's kNumFrames floats at its (64-byte aligned) offset
+    struct FileHeader
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::uint32 engineVersion;
+        juce::uint32 sampleRate;
+        juce::uint32 numFrames;
+        juce::uint32 count;
+    };
+
+    struct TableEntry
+    {
+        juce::uint64 key;
+        juce::uint64 offset;    // Bytes from the start of the file
+    };
+
+    constexpr char kPreviewMagic[4] = { 'B', 'L', 'P', 'V' };
+    constexpr juce::uint32 kPreviewVersion = 1;
+    constexpr size_t kPreviewBytes = size_t(PresetPreviewCache::kNumFrames) * sizeof(float);
+
+    constexpr size_t alignUp(size_t bytes)
+    {
+        return (bytes + 63) & ~size_t(63);
+    }
+
+    // Phrase: A3 C4 E4 G4 A4, legato
+    constexpr int kPhraseNotes[PresetPreviewCache::kNumPhraseNotes] = { 57, 60, 64, 67, 69 };
+}
+
+//==============================================================================
+struct PresetPreviewCache::Mapping
+{
+    explicit Mapping(const juce::File& file)
+        : mapped(file, juce::MemoryMappedFile::readOnly)
+    {
+    }
+
+    juce::MemoryMappedFile mapped;
+    const TableEntry* table = nullptr;
+    juce::uint32 count = 0;
+
+    const char* base() const { return static_cast<const char*>(mapped.getData()); }
+
+    const float* find(juce::uint64 key) const noexcept
+    {
+        const auto* end = table + count;
+        const auto* hit = std::lower_bound(table, end, key, [](const TableEntry& e, juce::uint64 k)
+        {
+            return e.key < k;
+        });
+
+        if (hit == end || hit->key != key)
+            return nullptr;
+        return reinterpret_cast<const float*>(base() + hit->offset);
+    }
+};
+
+//==============================================================================
+PresetPreviewCache::PresetPreviewCache(juce::File cacheFile)
+    : juce::Thread("BreathLead preview render"),
+      cacheFile_(std::move(cacheFile))
+{
+}
+
+PresetPreviewCache::~PresetPreviewCache()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+    cancelPendingUpdate();
+}
+
+juce::File PresetPreviewCache::getDefaultCacheFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("SchillingerEcosystem/BreathLead/PresetPreviews.bin");
+}
+
+//==============================================================================
+void PresetPreviewCache::setPresets(std::vector<breath::PresetSnapshot> presets)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(pendingLock_);
+        pending_.swap(presets);
+        hasPending_ = true;
+    }
+
+    // Previous list (now in `presets`) is released here, outside the lock
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+    else
+        notify();
+}
+
+// Pins the current slot, or returns -1 if nothing is published. The pin is
+// taken before the slot is confirmed as current, so the render thread
+// (which moves currentSlot_, then checks pins) never frees a slot in use.
+int PresetPreviewCache::pinCurrent() const noexcept
+{
+    for (;;)
+    {
+        const int slot = currentSlot_.load();
+        if (slot < 0)
+            return -1;
+
+        pins_[slot].fetch_add(1);
+        if (currentSlot_.load() == slot)
+            return slot;
+        pins_[slot].fetch_sub(1);
+    }
+}
+
+PresetPreviewCache::Preview PresetPreviewCache::acquirePreview(juce::uint64 key) const noexcept
+{
+    const int slot = pinCurrent();
+    if (slot < 0)
+        return {};
+
+    if (const auto* samples = mappings_[slot]->find(key))
+        return { samples, kNumFrames, slot };
+
+    pins_[slot].fetch_sub(1);
+    return {};
+}
+
+void PresetPreviewCache::releasePreview(Preview& preview) const noexcept
+{
+    if (preview.isValid())
+        pins_[preview.slot].fetch_sub(1);
+    preview = {};
+}
+
+bool PresetPreviewCache::hasPreview(const breath::PresetSnapshot& preset) const noexcept
+{
+    auto preview = acquirePreview(makeKey(preset));
+    const bool found = preview.isValid();
+    releasePreview(preview);
+    return found;
+}
+
+juce::uint64 PresetPreviewCache::makeKey(const breath::PresetSnapshot& preset) noexcept
+{
+    // FNV-1a over the engine version, then the preset values
+    juce::uint64 hash = 14695981039346656037ULL;
+    const auto mix = [&hash](const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const juce::uint8*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    const juce::uint32 engineVersion = breath::kEngineVersion;
+    mix(&engineVersion, sizeof(engineVersion));
+    mix(&preset, sizeof(preset));
+    return hash;
+}
+
+void PresetPreviewCache::renderPreview(const breath::PresetSnapshot& preset, float* out)
+{
+    // Large (delay lines for every voice); this runs on the render thread
+    auto synth = std::make_unique<breath::BreathLeadSynth>();
+    breath::DspArena arena;
+    if (!arena.reserve(breath::BreathLeadSynth::arenaBytes(kSampleRate)))
+    {
+        std::fill(out, out + kNumFrames, 0.f);
+        return;
+    }
+    synth->prepare(kSampleRate, arena);
+
+    breath::SynthParameters params;
+    params.air = preset.air;
+    params.tone = preset.tone;
+    params.formant = preset.formant;
+    params.resistance = preset.resistance;
+    params.vibrato = preset.vibrato;
+    params.engine = static_cast<breath::ResonanceEngine>(juce::jlimit(0, 2, preset.engine));
+    synth->setParameters(params);
+
+    int position = 0;
+    for (int i = 0; i < kNumPhraseNotes; ++i)
+    {
+        if (i > 0)
+        {
+            const juce::uint8 noteOff[3] = { 0x80, juce::uint8(kPhraseNotes[i - 1]), 0 };
+            synth->handleMidi(noteOff, 3);
+        }
+
+        const juce::uint8 noteOn[3] = { 0x90, juce::uint8(kPhraseNotes[i]), 100 };
+        synth->handleMidi(noteOn, 3);
+
+        synth->render(out + position, out + position, kNoteFrames);
+        position += kNoteFrames;
+    }
+
+    const juce::uint8 noteOff[3] = { 0x80, juce::uint8(kPhraseNotes[kNumPhraseNotes - 1]), 0 };
+    synth->handleMidi(noteOff, 3);
+    synth->render(out + position, out + position, kTailFrames);
+
+    juce::FloatVectorOperations::multiply(out, preset.masterGain, kNumFrames);
+}
+
+//==============================================================================
+void PresetPreviewCache::run()
+{
+    // 1. Publish what is on disk straight away so previews are instant
+    if (auto mapping = openMapping(cacheFile_))
+        publish(std::move(mapping));
+
+    // 2. Render whatever the current preset list is missing
+    while (!threadShouldExit())
+    {
+        std::vector<breath::PresetSnapshot> presets;
+        bool hasWork = false;
+        {
+            const juce::SpinLock::ScopedLockType lock(pendingLock_);
+            presets.swap(pending_);
+            hasWork = hasPending_;
+            hasPending_ = false;
+        }
+
+        if (!hasWork)
+        {
+            wait(-1);
+            continue;
+        }
+
+        if (rebuild(presets))
+            triggerAsyncUpdate();
+    }
+}
+
+void PresetPreviewCache::handleAsyncUpdate()
+{
+    if (onPreviewsChanged)
+        onPreviewsChanged();
+}
+
+//==============================================================================
+bool PresetPreviewCache::rebuild(const std::vector<breath::PresetSnapshot>& presets)
+{
+    struct Item
+    {
+        juce::uint64 key;
+        const breath::PresetSnapshot* preset;
+        const float* cached;
+    };
+
+    // Only this thread replaces the current slot
+    const int currentSlot = currentSlot_.load();
+    const auto* current = currentSlot >= 0 ? mappings_[currentSlot].get() : nullptr;
+
+    std::vector<Item> items;
+    items.reserve(presets.size());
+    for (const auto& preset : presets)
+        items.push_back({ makeKey(preset), &preset, nullptr });
+
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+    items.erase(std::unique(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.key == b.key; }),
+                items.end());
+
+    int missing = 0;
+    for (auto& item : items)
+    {
+        item.cached = current != nullptr ? current->find(item.key) : nullptr;
+        if (item.cached == nullptr)
+            ++missing;
+    }
+
+    // Everything already rendered (extra entries for removed presets are harmless)
+    if (missing == 0)
+        return false;
+
+    // Write the complete new file next to the cache, then move it into place
+    const auto tempFile = cacheFile_.getSiblingFile(cacheFile_.getFileName() + ".tmp");
+    tempFile.deleteFile();
+    cacheFile_.getParentDirectory().createDirectory();
+
+    bool written = false;
+    {
+        juce::FileOutputStream out(tempFile);
+        if (!out.openedOk())
+            return false;
+
+        FileHeader header;
+        std::memcpy(header.magic, kPreviewMagic, sizeof(kPreviewMagic));
+        header.version = kPreviewVersion;
+        header.engineVersion = breath::kEngineVersion;
+        header.sampleRate = juce::uint32(kSampleRate);
+        header.numFrames = juce::uint32(kNumFrames);
+        header.count = juce::uint32(items.size());
+        out.write(&header, sizeof(header));
+
+        const size_t dataStart = alignUp(sizeof(FileHeader) + items.size() * sizeof(TableEntry));
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const TableEntry entry { items[i].key, juce::uint64(dataStart + i * alignUp(kPreviewBytes)) };
+            out.write(&entry, sizeof(entry));
+        }
+
+        std::vector<float> rendered(static_cast<size_t>(kNumFrames));
+        const char padding[64] = {};
+        out.write(padding, dataStart - size_t(out.getPosition()));
+
+        for (const auto& item : items)
+        {
+            if (threadShouldExit())
+                break;
+
+            const float* samples = item.cached;
+            if (samples == nullptr)
+            {
+                renderPreview(*item.preset, rendered.data());
+                samples = rendered.data();
+            }
+
+            out.write(samples, kPreviewBytes);
+            out.write(padding, alignUp(kPreviewBytes) - kPreviewBytes);
+        }
+
+        out.flush();
+        written = !threadShouldExit() && out.getStatus().wasOk();
+    }
+
+    if (!written)
+    {
+        tempFile.deleteFile();
+        return false;
+    }
+
+    // POSIX keeps the old mapping's data alive across the rename; where the
+    // OS refuses to replace a mapped file, serve the new file from its
+    // temporary name until the next start
+    const bool moved = tempFile.moveFileTo(cacheFile_);
+    auto mapping = openMapping(moved ? cacheFile_ : tempFile);
+    if (mapping == nullptr)
+        return false;
+
+    return publish(std::move(mapping));
+}
+
+std::unique_ptr<PresetPreviewCache::Mapping> PresetPreviewCache::openMapping(const juce::File& file) const
+{
+    if (!file.existsAsFile())
+        return nullptr;
+
+    auto mapping = std::make_unique<Mapping>(file);
+    const auto size = mapping->mapped.getSize();
+    if (mapping->mapped.getData() == nullptr || size < sizeof(FileHeader))
+        return nullptr;
+
+    FileHeader header;
+    std::memcpy(&header, mapping->base(), sizeof(header));
+
+    if (std::memcmp(header.magic, kPreviewMagic, sizeof(kPreviewMagic)) != 0
+        || header.version != kPreviewVersion
+        || header.engineVersion != breath::kEngineVersion
+        || header.sampleRate != juce::uint32(kSampleRate)
+        || header.numFrames != juce::uint32(kNumFrames)
+        || size < sizeof(FileHeader) + size_t(header.count) * sizeof(TableEntry))
+        return nullptr; // Stale layout or engine: everything renders again
+
+    mapping->table = reinterpret_cast<const TableEntry*>(mapping->base() + sizeof(FileHeader));
+    mapping->count = header.count;
+
+    for (juce::uint32 i = 0; i < header.count; ++i)
+    {
+        const auto& entry = mapping->table[i];
+        if (entry.offset % alignof(float) != 0 || entry.offset > size || size - entry.offset < kPreviewBytes
+            || (i > 0 && mapping->table[i - 1].key >= entry.key))
+            return nullptr;
+    }
+
+    return mapping;
+}
+
+bool PresetPreviewCache::publish(std::unique_ptr<Mapping> mapping)
+{
+    // Any slot that is not current and not pinned: its mapping is unmapped
+    // here. Pinned previews keep theirs until released.
+    const int currentSlot = currentSlot_.load();
+    for (int slot = 0; slot < kNumSlots; ++slot)
+    {
+        if (slot == currentSlot || pins_[slot].load() != 0)
+            continue;
+
+        mappings_[slot] = std::move(mapping);
+        currentSlot_.store(slot);
+        return true;
+    }
+
+    // Every older mapping is still playing; keep the current one and
+    // pick the new file up on the next rebuild
+    return false;
+}
@@ -0,0 +1,77 @@
+/*
+  bench_breath_lead_json.cpp - Preset JSON save / load for undo and A/B
+
+  Undo and A/B snapshot the preset thousands of times per session, so this
+  times BreathLeadDSP savePreset() and loadPreset() over a history of
+  snapshots, each with its own values, into and out of one caller-owned
+  buffer per snapshot. Prints the best of a few runs per history and per
+  snapshot.
+
+    bench_breath_lead_json [snapshots] [runs]
+*/
+
+#include "dsp/BreathLeadDSP.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kPresetBufferSize = 1024;
+
+double microseconds(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int numSnapshots = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5000;
+    const int numRuns = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    auto dsp = std::make_unique<BreathLeadDSP>();
+    std::vector<char> history(static_cast<size_t>(numSnapshots) * kPresetBufferSize);
+
+    double bestSave = 1e30, bestLoad = 1e30;
+    size_t bytes = 0;
+    int failed = 0;
+
+    for (int run = 0; run < numRuns; ++run) {
+        // Each snapshot after one parameter move, as an edit history
+        const auto t0 = Clock::now();
+        bytes = 0;
+        for (int i = 0; i < numSnapshots; ++i) {
+            const auto& info = BreathLeadDSP::kParameters[i % BreathLeadDSP::kNumParameters];
+            dsp->setParameter(info.id, info.minValue + (info.maxValue - info.minValue) * float(i % 101) / 100.f);
+            char* slot = history.data() + size_t(i) * kPresetBufferSize;
+            failed += dsp->savePreset(slot, kPresetBufferSize) ? 0 : 1;
+            bytes += std::strlen(slot);
+        }
+        const auto t1 = Clock::now();
+        for (int i = numSnapshots - 1; i >= 0; --i)
+            failed += dsp->loadPreset(history.data() + size_t(i) * kPresetBufferSize) ? 0 : 1;
+        const auto t2 = Clock::now();
+
+        bestSave = std::min(bestSave, microseconds(t1 - t0));
+        bestLoad = std::min(bestLoad, microseconds(t2 - t1));
+    }
+
+    std::printf("%d snapshots, %zu bytes, best of %d runs\n", numSnapshots, bytes, numRuns);
+    std::printf("  save  %9.1f us/history  %7.1f ns/snapshot\n", bestSave, bestSave * 1000.0 / numSnapshots);
+    std::printf("  load  %9.1f us/history  %7.1f ns/snapshot\n", bestLoad, bestLoad * 1000.0 / numSnapshots);
+
+    if (failed != 0) {
+        std::printf("Save / load FAILED (%d)\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+  bench_breath_lead_state.cpp - Plugin state save / load for a large session
+
+  Opening a session restores every instance's state, so this times
+  PluginState encode() and decode() for 500 instances, each with its own
+  values, as a host would save and reopen them. Prints the best of a few
+  runs per session and per instance.
+
+    bench_breath_lead_state [instances] [runs]
+*/
+
+#include "plugin/PluginState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double microseconds(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int numInstances = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int numRuns = argc > 2 ? std::max(1, std::atoi(argv[2])) : 50;
+
+    std::vector<PluginState> session(static_cast<size_t>(numInstances));
+    for (int i = 0; i < numInstances; ++i) {
+        auto& s = session[size_t(i)];
+        s.air = float(i % 100) / 100.f;
+        s.tone = float(i % 37) / 37.f;
+        s.engine = i % 3;
+        s.program = i % 21;
+        s.release = 10.f + float(i % 290) * 10.f;
+        s.breathSources = i % 3;
+    }
+
+    // One blob per instance, as the host stores them
+    std::vector<std::vector<uint8_t>> blobs(session.size(), std::vector<uint8_t>(state::kMaxEncodedSize));
+    std::vector<PluginState> restored(session.size());
+
+    double bestSave = 1e30, bestLoad = 1e30;
+    size_t bytes = 0;
+    int failed = 0;
+
+    for (int run = 0; run < numRuns; ++run) {
+        const auto t0 = Clock::now();
+        bytes = 0;
+        for (size_t i = 0; i < session.size(); ++i)
+            bytes += state::encode(session[i], blobs[i].data(), blobs[i].size());
+        const auto t1 = Clock::now();
+        for (size_t i = 0; i < session.size(); ++i)
+            failed += state::decode(blobs[i].data(), blobs[i].size(), restored[i]) ? 0 : 1;
+        const auto t2 = Clock::now();
+
+        bestSave = std::min(bestSave, microseconds(t1 - t0));
+        bestLoad = std::min(bestLoad, microseconds(t2 - t1));
+    }
+
+    std::printf("%d instances, %zu bytes, best of %d runs\n", numInstances, bytes, numRuns);
+    std::printf("  save  %9.1f us/session  %7.1f ns/instance\n", bestSave, bestSave * 1000.0 / numInstances);
+    std::printf("  load  %9.1f us/session  %7.1f ns/instance\n", bestLoad, bestLoad * 1000.0 / numInstances);
+
+    if (failed != 0 || std::memcmp(restored.data(), session.data(), session.size() * sizeof(PluginState)) != 0) {
+        std::printf("Round trip FAILED\n");
+        return 1;
+    }
+    return 0;
+}
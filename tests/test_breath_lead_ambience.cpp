@@ -0,0 +1,222 @@
+/*
+  test_breath_lead_ambience.cpp - The shared FDN room
+
+  FdnAmbience on its own, at 48 kHz:
+  - Mix 0 passes the input through untouched and bypasses the network
+  - an impulse rings out and decays, longer with Size, different left and
+    right, and stays finite at the largest, least damped setting
+  - the output does not depend on how the caller slices its blocks
+  - sweeping Size while a tone plays adds no step where the lengths change
+  - after a bypass the network wakes up empty, without the old tail
+*/
+
+#include "dsp/FdnAmbience.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// An ambience with its own arena
+struct Room {
+    DspArena arena;
+    FdnAmbience fdn;
+
+    Room(float mix, float size, float damping = 0.4f) {
+        arena.reserve(FdnAmbience::arenaBytes(kRate));
+        fdn.setMix(mix);
+        fdn.setSize(size);
+        fdn.setDamping(damping);
+        fdn.prepare(kRate, arena);
+    }
+
+    void process(std::vector<float>& left, std::vector<float>& right, int blockSize) {
+        for (size_t pos = 0; pos < left.size(); pos += size_t(blockSize)) {
+            const int n = int(std::min(left.size() - pos, size_t(blockSize)));
+            fdn.process(left.data() + pos, right.data() + pos, n);
+        }
+    }
+};
+
+double energy(const std::vector<float>& x, size_t from, size_t to) {
+    double sum = 0.0;
+    for (size_t i = from; i < to; ++i)
+        sum += double(x[i]) * double(x[i]);
+    return sum;
+}
+
+// Left and right after a unit impulse, `seconds` long
+struct Response {
+    std::vector<float> left, right;
+};
+
+Response impulse(float size, float damping, float seconds) {
+    Room room(1.f, size, damping);
+    Response r { std::vector<float>(size_t(seconds * kRate)), std::vector<float>(size_t(seconds * kRate)) };
+    r.left[0] = r.right[0] = 1.f;
+    room.process(r.left, r.right, 256);
+    return r;
+}
+
+void testBypass() {
+    std::printf("Mix 0\n");
+
+    Room room(0.f, 0.5f);
+    check(room.arena.used() == room.arena.capacity(), "the lines take exactly arenaBytes()");
+
+    std::vector<float> left(4800), right(4800);
+    for (size_t i = 0; i < left.size(); ++i) {
+        left[i] = float(std::sin(0.01 * double(i)));
+        right[i] = -0.5f * left[i];
+    }
+    const auto dryL = left, dryR = right;
+    room.process(left, right, 480);
+
+    check(left == dryL && right == dryR, "the input passes through untouched");
+    check(!room.fdn.isActive(), "and the network is bypassed");
+}
+
+void testDecay() {
+    std::printf("Impulse response\n");
+
+    const auto small = impulse(0.f, 0.4f, 3.f), large = impulse(1.f, 0.4f, 3.f);
+    const size_t second = size_t(kRate);
+
+    const double early = energy(small.left, 0, second / 10);
+    const double late = energy(small.left, 2 * second, 3 * second);
+    std::printf("  small room: %.2e in the first 100 ms, %.2e after 2 s\n", early, late);
+    check(early > 1e-3 && late < early * 1e-6, "rings, then decays");
+
+    std::printf("  after 1 s: small %.2e, large %.2e\n", energy(small.left, second, 2 * second),
+                energy(large.left, second, 2 * second));
+    check(energy(large.left, second, 2 * second) > 100.0 * energy(small.left, second, 2 * second),
+          "a larger room rings longer");
+
+    check(std::memcmp(large.left.data(), large.right.data(), large.left.size() * sizeof(float)) != 0,
+          "left and right take different lines");
+
+    const auto open = impulse(1.f, 0.f, 10.f);
+    bool finite = true;
+    for (const float x : open.left)
+        finite = finite && std::isfinite(x);
+    const double tail = energy(open.left, size_t(9 * kRate), open.left.size());
+    check(finite && tail < energy(open.left, 0, second) * 1e-4, "largest and brightest still decays");
+}
+
+void testBlockSlicing() {
+    std::printf("Block slicing\n");
+
+    auto render = [](int blockSize) {
+        Room room(0.6f, 0.7f);
+        std::vector<float> left(48000), right(48000);
+        for (size_t i = 0; i < left.size(); ++i) {
+            left[i] = i % 4800 < 200 ? float(std::sin(0.07 * double(i))) : 0.f;
+            right[i] = 0.5f * left[i];
+        }
+
+        // Mix and Size move halfway through, inside a control tick for most sizes
+        const size_t half = left.size() / 2 + 13;
+        std::vector<float> l2(left.begin() + long(half), left.end()), r2(right.begin() + long(half), right.end());
+        left.resize(half);
+        right.resize(half);
+        room.process(left, right, blockSize);
+        room.fdn.setSize(0.2f);
+        room.fdn.setMix(0.3f);
+        room.process(l2, r2, blockSize);
+
+        left.insert(left.end(), l2.begin(), l2.end());
+        return left;
+    };
+
+    const auto reference = render(1);
+    check(render(17) == reference && render(64) == reference && render(4096) == reference,
+          "1, 17, 64 and 4096-sample blocks render alike");
+}
+
+void testSizeSweep() {
+    std::printf("Size automation\n");
+
+    // A tone through the room while Size swings back and forth every block.
+    // The delays glide, which bends the tail's pitch but must not step: the
+    // sample-to-sample change on a control tick (where new lengths are
+    // set) should look like the change anywhere else.
+    Room room(0.8f, 0.5f);
+    std::vector<float> left(480), right(480);
+    double phase = 0.0, onTick = 0.0, elsewhere = 0.0;
+    float last = 0.f;
+    long sample = 0;
+    for (int b = 0; b < 400; ++b) {
+        for (size_t i = 0; i < left.size(); ++i) {
+            left[i] = right[i] = 0.3f * float(std::sin(phase));
+            phase += 2.0 * std::numbers::pi * 220.0 / kRate;
+        }
+        room.fdn.setSize(0.5f + 0.5f * float(std::sin(0.05 * b)));
+        room.process(left, right, 480);
+
+        for (const float x : left) {
+            if (b >= 100)   // After the room has filled
+                (sample % kControlInterval == 0 ? onTick : elsewhere) += std::abs(x - last);
+            last = x;
+            ++sample;
+        }
+    }
+
+    const double ticks = 300.0 * 480.0 / kControlInterval;
+    const double ratio = (onTick / ticks) / (elsewhere / (300.0 * 480.0 - ticks));
+    char what[96];
+    std::snprintf(what, sizeof(what), "mean step on a tick / elsewhere: %.3f", ratio);
+    check(ratio < 1.1, what);
+}
+
+void testWakeUp() {
+    std::printf("Bypass and wake\n");
+
+    Room room(1.f, 1.f);
+    std::vector<float> left(4800), right(4800);
+    left[0] = right[0] = 1.f;
+    room.process(left, right, 480);
+
+    // The mix smoother (30 ms) needs about 300 ms to reach the bypass level
+    room.fdn.setMix(0.f);
+    for (int b = 0; b < 5; ++b) {
+        std::fill(left.begin(), left.end(), 0.f);
+        std::fill(right.begin(), right.end(), 0.f);
+        room.process(left, right, 480);
+    }
+    check(!room.fdn.isActive(), "Mix 0 bypasses once the level has faded");
+
+    room.fdn.setMix(1.f);
+    std::fill(left.begin(), left.end(), 0.f);
+    std::fill(right.begin(), right.end(), 0.f);
+    room.process(left, right, 480);
+    check(room.fdn.isActive() && energy(left, 0, left.size()) == 0.0, "woken, it starts from silence");
+}
+
+} // namespace
+
+int main() {
+    testBypass();
+    testDecay();
+    testBlockSlicing();
+    testSizeSweep();
+    testWakeUp();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/*
+  test_breath_lead_arena.cpp - Engine buffers live in the arena
+
+  Each component carves exactly the arenaBytes() it asks for, works from
+  those buffers, and lets go of them when prepared against a released
+  arena. getMemoryFootprint() and the follower's getHeapBytes() follow the
+  memory the instance actually holds.
+*/
+
+#include "dsp/AudioBreathFollower.h"
+#include "dsp/BreathLeadDSP.h"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numbers>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Sine through the follower, a chunk at a time; returns the tracked pitch
+float track(AudioBreathFollower& follower, double rate, float hz, int chunks) {
+    float in[AudioBreathFollower::kMaxChunk], air[AudioBreathFollower::kMaxChunk];
+    double phase = 0.0;
+    for (int c = 0; c < chunks; ++c) {
+        for (float& x : in) {
+            x = 0.5f * float(std::sin(phase));
+            phase += 2.0 * std::numbers::pi * hz / rate;
+        }
+        follower.process(in, air, AudioBreathFollower::kMaxChunk, true);
+    }
+    return follower.getFrequency();
+}
+
+void testFollower() {
+    std::printf("Audio breath follower\n");
+
+    for (const double rate : { 44100.0, 48000.0, 96000.0, 192000.0 }) {
+        DspArena arena;
+        arena.reserve(AudioBreathFollower::arenaBytes(rate));
+        AudioBreathFollower follower;
+        follower.prepare(rate, arena);
+
+        char what[96];
+        std::snprintf(what, sizeof(what), "%.0f Hz: carves exactly arenaBytes()", rate);
+        check(arena.used() == arena.capacity(), what);
+        std::snprintf(what, sizeof(what), "%.0f Hz: tracks 220 Hz from the arena buffers", rate);
+        check(std::abs(track(follower, rate, 220.f, 200) - 220.f) < 1.f, what);
+    }
+
+    DspArena arena;
+    arena.reserve(AudioBreathFollower::arenaBytes(48000.0));
+    AudioBreathFollower follower;
+    follower.prepare(48000.0, arena);
+    check(follower.getHeapBytes() > 0, "the FFT is counted outside the arena");
+
+    arena.release();
+    follower.prepare(48000.0, arena);
+    check(follower.getHeapBytes() == 0, "prepared against a released arena, the FFT is freed");
+    check(track(follower, 48000.0, 220.f, 50) == 0.f, "and process() does nothing");
+
+    arena.reserve(AudioBreathFollower::arenaBytes(48000.0));
+    follower.prepare(48000.0, arena);
+    check(std::abs(track(follower, 48000.0, 330.f, 200) - 330.f) < 1.f, "prepared again, it tracks again");
+}
+
+void testEngineFootprint() {
+    std::printf("BreathLeadDSP footprint\n");
+
+    auto engine = std::make_unique<BreathLeadDSP>();
+    engine->prepare(48000.0, 256);
+    const size_t at48 = engine->getMemoryFootprint();
+    check(at48 > sizeof(BreathLeadDSP), "prepared: the object plus its arena");
+
+    engine->prepare(96000.0, 256);
+    check(engine->getMemoryFootprint() > at48, "grows with the sample rate");
+
+    engine->releaseResources();
+    check(engine->getMemoryFootprint() == sizeof(BreathLeadDSP), "released: the object alone");
+}
+
+} // namespace
+
+int main() {
+    testFollower();
+    testEngineFootprint();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*
+  test_breath_lead_audio_input.cpp - Audio breath plays without a note
+
+  An external pressure (what the plugin's Audio Input derives from a mic)
+  drives BreathLeadSynth::render() with no MIDI at all. It must sound on its
+  own at the tracked pitch, stay silent on a silent input, fall silent when
+  the input stops, and hand over to a note played on top.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr int kBlockSize = 128;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+struct Rig {
+    DspArena arena;
+    std::unique_ptr<BreathLeadSynth> synth = std::make_unique<BreathLeadSynth>();
+
+    Rig() {
+        arena.reserve(BreathLeadSynth::arenaBytes(kRate));
+        synth->prepare(kRate, arena);
+    }
+
+    // Renders `blocks` blocks at a steady input level (or without one);
+    // returns the output peak
+    float play(int blocks, const float* level) {
+        float left[kBlockSize], right[kBlockSize], pressure[kBlockSize];
+        float peak = 0.f;
+        for (int b = 0; b < blocks; ++b) {
+            if (level != nullptr)
+                std::fill(pressure, pressure + kBlockSize, *level);
+            synth->beginBlock();
+            synth->render(left, right, kBlockSize, level != nullptr ? pressure : nullptr);
+            for (float x : left)
+                peak = std::max(peak, std::abs(x));
+        }
+        return peak;
+    }
+};
+
+void testBreathAlone() {
+    std::printf("Breath with no note\n");
+
+    Rig rig;
+    const float silent = 0.f, blowing = 0.8f;
+
+    check(rig.play(200, &silent) == 0.f && rig.synth->getActiveVoiceCount() == 0,
+          "silent input stays silent");
+
+    rig.synth->setPitchOverride(220.f);
+    check(rig.play(200, &blowing) > 0.01f, "input alone sounds");
+    const auto& slot = rig.synth->getVoiceSlot(0);
+    check(rig.synth->getActiveVoiceCount() == 1 && slot.note < 0, "on voice 0, no note held");
+    check(std::abs(slot.voice.freq - 220.f) < 0.01f, "at the tracked pitch");
+
+    rig.play(800, &silent);
+    check(rig.play(10, &silent) == 0.f && rig.synth->getActiveVoiceCount() == 0, "a silent input fades it out");
+
+    rig.play(200, &blowing);
+    const bool stillSounding = rig.play(1, nullptr) > 0.f;
+    rig.play(800, nullptr);
+    check(stillSounding && rig.play(10, nullptr) == 0.f && rig.synth->getActiveVoiceCount() == 0,
+          "turning the input off releases it");
+}
+
+void testNoteOnTop() {
+    std::printf("A note played over the breath\n");
+
+    Rig rig;
+    const float blowing = 0.5f;
+    rig.play(200, &blowing);
+
+    const uint8_t on[] = { 0x90, 69, 127 };
+    rig.synth->handleMidi(on, 3);
+    rig.play(200, &blowing);
+    const auto& slot = rig.synth->getVoiceSlot(0);
+    check(slot.note == 69 && slot.voice.envelope.stage == PressureEnvelope::Stage::Follow,
+          "the note takes voice 0 and follows the breath");
+    check(std::abs(slot.voice.envelope.level - blowing * rig.synth->getParameters().air) < 1e-3f,
+          "at the input's pressure, not the velocity");
+
+    const uint8_t off[] = { 0x80, 69, 0 };
+    rig.synth->handleMidi(off, 3);
+    check(rig.play(200, &blowing) > 0.01f && slot.voice.envelope.stage == PressureEnvelope::Stage::Follow,
+          "after note-off the breath keeps playing");
+}
+
+} // namespace
+
+int main() {
+    testBreathAlone();
+    testNoteOnTop();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
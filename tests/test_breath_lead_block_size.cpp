@@ -0,0 +1,198 @@
+/*
+  test_breath_lead_block_size.cpp - Output does not depend on the host block
+
+  One performance (notes, a breath controller stream, bends, a mod wheel
+  move) is timed in absolute samples and fed to BreathLeadDSP at host
+  blocks of 32, 64 and 512 samples, plus 17 and a varying size, in both
+  latency modes. Every render must match the 32-sample one bit for bit.
+  The same holds for audio breath (an external pressure) straight into
+  the synth. Then the event queue and the carry-over buffer are overfilled
+  and every refused event must show up in getDroppedEventCount().
+*/
+
+#include "dsp/BreathLeadDSP.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr int kLength = 48000;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+struct TimedEvent {
+    int time;       // Absolute sample
+    DSP::ScheduledEvent event;
+};
+
+std::vector<TimedEvent> makePerformance() {
+    std::vector<TimedEvent> events;
+    auto add = [&](int time, DSP::ScheduledEvent::Type type, int number, float value) {
+        DSP::ScheduledEvent e;
+        e.type = type;
+        e.noteNumber = e.controllerNumber = number;
+        e.velocity = e.value = value;
+        events.push_back({ time, e });
+    };
+
+    add(100, DSP::ScheduledEvent::NoteOn, 60, 0.8f);
+    for (int t = 500; t < 20000; t += 777)      // Lands all over the grid
+        add(t, DSP::ScheduledEvent::CC, 2, float(t % 1000) / 1000.f);
+    add(7001, DSP::ScheduledEvent::PitchBend, 0, 0.3f);
+    add(15013, DSP::ScheduledEvent::NoteOff, 60, 0.f);
+    add(15013, DSP::ScheduledEvent::NoteOn, 64, 0.6f);
+    add(16005, DSP::ScheduledEvent::CC, 1, 0.5f);
+    add(33333, DSP::ScheduledEvent::PitchBend, 0, -0.5f);
+    add(40001, DSP::ScheduledEvent::NoteOff, 64, 0.f);
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const TimedEvent& a, const TimedEvent& b) { return a.time < b.time; });
+    return events;
+}
+
+// Host block sizes: a fixed size, or (0) a different size every call
+int blockSizeAt(int fixed, int call) {
+    static constexpr int kVarying[] = { 1, 480, 17, 256, 3, 1024, 96, 31 };
+    return fixed > 0 ? fixed : kVarying[call % 8];
+}
+
+std::vector<float> render(const std::vector<TimedEvent>& events, int blockSize, BlockLatency latency) {
+    auto engine = std::make_unique<BreathLeadDSP>();
+    engine->setBlockLatency(latency);
+    engine->prepare(kRate, 1024);
+
+    std::vector<float> left(kLength), right(kLength);
+    size_t e = 0;
+    for (int pos = 0, call = 0; pos < kLength; ++call) {
+        const int n = std::min(blockSizeAt(blockSize, call), kLength - pos);
+        for (; e < events.size() && events[e].time < pos + n; ++e) {
+            auto event = events[e].event;
+            event.sampleOffset = events[e].time - pos;
+            engine->handleEvent(event);
+        }
+
+        float* outputs[] = { left.data() + pos, right.data() + pos };
+        engine->process(outputs, 2, n);
+        pos += n;
+    }
+    return left;
+}
+
+bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+void testEngine(BlockLatency latency, const char* name) {
+    std::printf("BreathLeadDSP, %s\n", name);
+
+    const auto events = makePerformance();
+    const auto reference = render(events, 32, latency);
+
+    float peak = 0.f;
+    for (float x : reference)
+        peak = std::max(peak, std::abs(x));
+    check(peak > 0.01f, "the performance is audible");
+
+    char what[64];
+    for (const int blockSize : { 64, 512, 17, 0 }) {
+        if (blockSize > 0)
+            std::snprintf(what, sizeof(what), "%d-sample blocks match 32", blockSize);
+        else
+            std::snprintf(what, sizeof(what), "varying blocks match 32");
+        check(identical(render(events, blockSize, latency), reference), what);
+    }
+}
+
+void testAudioBreath() {
+    std::printf("Audio breath into the synth\n");
+
+    // Silence, a swell, then silence again
+    std::vector<float> pressure(kLength);
+    for (int i = 0; i < kLength; ++i)
+        pressure[size_t(i)] = i < 1000 || i >= 30000 ? 0.f : std::min(1.f, float(i - 1000) / 5000.f);
+
+    auto play = [&](int blockSize) {
+        DspArena arena;
+        arena.reserve(BreathLeadSynth::arenaBytes(kRate));
+        auto synth = std::make_unique<BreathLeadSynth>();
+        synth->prepare(kRate, arena);
+        synth->setPitchOverride(220.f);
+
+        std::vector<float> left(kLength), right(kLength);
+        for (int pos = 0; pos < kLength; pos += blockSize) {
+            const int n = std::min(blockSize, kLength - pos);
+            synth->beginBlock();
+            synth->render(left.data() + pos, right.data() + pos, n, pressure.data() + pos);
+        }
+        return left;
+    };
+
+    const auto reference = play(32);
+    check(identical(play(64), reference) && identical(play(512), reference),
+          "64- and 512-sample blocks match 32");
+    check(identical(play(17), reference), "17-sample blocks match 32 (the voice starts on the same sample)");
+}
+
+void testOverflow() {
+    std::printf("Overflow\n");
+
+    constexpr int kCapacity = BreathLeadDSP::kEventQueueSize;
+    auto engine = std::make_unique<BreathLeadDSP>();
+    engine->prepare(kRate, 64);
+
+    float left[64], right[64];
+    float* outputs[] = { left, right };
+    auto cc = [](int offset) {
+        DSP::ScheduledEvent e;
+        e.type = DSP::ScheduledEvent::CC;
+        e.controllerNumber = 7;
+        e.value = 0.5f;
+        e.sampleOffset = offset;
+        return e;
+    };
+
+    // The queue refuses what does not fit before the next process()
+    for (int i = 0; i < kCapacity + 10; ++i)
+        engine->handleEvent(cc(0));
+    check(engine->getDroppedEventCount() == 10, "a full queue counts the events it refuses");
+    engine->process(outputs, 2, 64);
+    check(engine->getDroppedEventCount() == 10, "what was queued is applied, not dropped");
+
+    // Events for later blocks wait in the carry-over buffer, which holds
+    // kCapacity; what arrives on top of a full one is dropped and counted
+    for (int i = 0; i < kCapacity - 24; ++i)
+        engine->handleEvent(cc(1000000));
+    engine->process(outputs, 2, 64);
+    check(engine->getDroppedEventCount() == 10, "events due later are carried, not dropped");
+
+    for (int i = 0; i < 100; ++i)
+        engine->handleEvent(cc(1000000));
+    engine->process(outputs, 2, 64);
+    check(engine->getDroppedEventCount() == 10 + 76, "a full carry-over buffer counts the rest");
+}
+
+} // namespace
+
+int main() {
+    testEngine(BlockLatency::Zero, "zero latency");
+    testEngine(BlockLatency::Buffered, "buffered");
+    testAudioBreath();
+    testOverflow();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+/*
+  test_breath_lead_breath_input.cpp - Breath controller scaling and release
+
+  A 7-bit controller (MSB only) must reach full pressure at 127, and a
+  14-bit one must keep its LSB. Switching the breath sources releases the
+  stream: a held note stops following the last breath value and returns to
+  its own note pressure.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Where the stream settles after the messages pushed so far
+float settle(BreathControllerInput& input) {
+    float out[480];
+    for (int b = 0; b < 20; ++b) {
+        input.beginBlock();
+        input.render(out, 480);
+    }
+    return input.getPressure();
+}
+
+void testSevenBit() {
+    std::printf("MSB only\n");
+
+    BreathControllerInput input;
+    input.prepare(48000.0);
+
+    input.pushController(0, 2, 127);
+    check(std::abs(settle(input) - 1.f) < 1e-5f, "CC2 127 is full pressure");
+
+    input.pushController(0, 2, 64);
+    check(std::abs(settle(input) - 64.f / 127.f) < 1e-5f, "CC2 64 is 64/127");
+
+    input.pushController(0, 2, 0);
+    check(settle(input) < 1e-5f, "CC2 0 is silence");
+}
+
+void testFourteenBit() {
+    std::printf("MSB + LSB\n");
+
+    BreathControllerInput input;
+    input.prepare(48000.0);
+
+    input.pushController(0, 2, 127);
+    input.pushController(0, 34, 127);
+    check(std::abs(settle(input) - 1.f) < 1e-5f, "CC2 / CC34 127 / 127 is full pressure");
+
+    input.pushController(0, 2, 64);
+    input.pushController(0, 34, 0);
+    const float coarse = settle(input);
+    input.pushController(0, 34, 1);
+    const float fine = settle(input);
+    check(std::abs(coarse - 8192.f / 16383.f) < 1e-5f, "CC2 / CC34 64 / 0 is 8192/16383");
+    // (The smoother settles to within a few float ulps of each value)
+    check(std::abs((fine - coarse) * 16383.f - 1.f) < 0.1f, "one LSB step moves the pressure by 1/16383");
+
+    // A lone MSB after the LSB has been seen stays on the 14-bit scale
+    input.pushController(0, 2, 127);
+    check(std::abs(settle(input) - 127.f * 128.f / 16383.f) < 1e-5f, "later MSB keeps the 14-bit scale");
+
+    input.reset();
+    input.pushController(0, 2, 127);
+    check(std::abs(settle(input) - 1.f) < 1e-5f, "reset() forgets the LSB");
+}
+
+void testSourceChangeReleasesHeldNote() {
+    std::printf("Source change under a held note\n");
+
+    constexpr double kRate = 48000.0;
+    DspArena arena;
+    arena.reserve(BreathLeadSynth::arenaBytes(kRate));
+    auto synth = std::make_unique<BreathLeadSynth>();
+    synth->prepare(kRate, arena);
+
+    float left[256], right[256];
+    auto run = [&](int blocks) {
+        for (int b = 0; b < blocks; ++b) {
+            synth->beginBlock();
+            synth->render(left, right, 256);
+        }
+    };
+
+    const uint8_t on[] = { 0x90, 62, 100 };
+    const uint8_t breath[] = { 0xB0, 2, 20 };
+    synth->handleMidi(on, 3);
+    run(40);
+    synth->handleMidi(breath, 3);
+    run(200);
+
+    const auto& envelope = synth->getVoiceSlot(0).voice.envelope;
+    const float air = synth->getParameters().air;
+    const float breathLevel = 20.f / 127.f * air;
+    const float noteLevel = 100.f / 127.f * air * envelope.shape.sustain;
+    check(envelope.stage == PressureEnvelope::Stage::Follow && std::abs(envelope.level - breathLevel) < 1e-3f,
+          "held note follows CC2");
+
+    synth->setBreathSources(BreathControllerInput::kExpression);
+    run(200);
+    check(envelope.stage != PressureEnvelope::Stage::Follow, "envelope leaves Follow");
+    check(std::abs(envelope.level - noteLevel) < 1e-3f, "held note returns to its note pressure");
+    check(synth->getVoiceSlot(0).voice.isActive(), "and keeps sounding");
+
+    // The stale CC2 is gone; expression now drives the note
+    const uint8_t expression[] = { 0xB0, 11, 127 };
+    synth->handleMidi(expression, 3);
+    run(200);
+    check(envelope.stage == PressureEnvelope::Stage::Follow && std::abs(envelope.level - air) < 1e-3f,
+          "CC11 takes over at full scale");
+}
+
+} // namespace
+
+int main() {
+    testSevenBit();
+    testFourteenBit();
+    testSourceChangeReleasesHeldNote();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
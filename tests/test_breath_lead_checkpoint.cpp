@@ -0,0 +1,189 @@
+/*
+  test_breath_lead_checkpoint.cpp - Restored checkpoints render bit-identically
+
+  A synth and room play a phrase, laid out as the plugin saves them (header,
+  synth, ambience). A checkpoint taken mid-phrase and restored into a fresh
+  pair must render the rest exactly as the straight render did, for every
+  resonance engine, at 48 and 96 kHz, in float and double. Checkpoints for
+  another sample rate, or cut short, must be refused.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+#include "dsp/FdnAmbience.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kNumBlocks = 400;
+constexpr int kCheckpointBlock = 157;   // Inside a note, room tail running
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+const char* name(ResonanceEngine engine) {
+    switch (engine) {
+        case ResonanceEngine::Formant:  return "formant";
+        case ResonanceEngine::Flute:    return "flute";
+        case ResonanceEngine::Clarinet: return "clarinet";
+    }
+    return "?";
+}
+
+template <typename Synth>
+struct Engine {
+    using Sample = typename Synth::Sample;
+
+    DspArena arena;
+    Synth synth;
+    FdnAmbience ambience;
+    double sampleRate;
+
+    Engine(double sr, ResonanceEngine engine) : sampleRate(sr) {
+        arena.reserve(Synth::arenaBytes(sr) + FdnAmbience::arenaBytes(sr));
+        synth.prepare(sr, arena);
+        ambience.prepare(sr, arena);
+
+        SynthParameters params;
+        params.engine = engine;
+        params.vibrato = 0.3f;
+        synth.setParameters(params);
+        ambience.setMix(0.4f);
+        ambience.setSize(0.6f);
+    }
+
+    // Block b of the phrase into out (interleaved L/R)
+    void renderBlock(int b, std::vector<Sample>& out) {
+        const uint8_t notes[] = { 57, 60, 64, 67, 69 };
+        const uint8_t note = notes[(b / 80) % 5];
+        if (b % 80 == 0) {
+            const uint8_t on[] = { 0x90, note, 100 };
+            synth.handleMidi(on, 3);
+        }
+        if (b % 80 == 60) {
+            const uint8_t off[] = { 0x80, note, 0 };
+            synth.handleMidi(off, 3);
+        }
+        if (b % 7 == 0) {
+            const uint8_t bend[] = { 0xE0, 0, uint8_t(64 + (b % 21) - 10) };
+            synth.handleMidi(bend, 3);
+        }
+
+        Sample left[kBlockSize], right[kBlockSize];
+        synth.beginBlock();
+        synth.render(left, right, kBlockSize);
+        ambience.process(left, right, kBlockSize);
+
+        Sample* dst = out.data() + size_t(b) * kBlockSize * 2;
+        for (int i = 0; i < kBlockSize; ++i) {
+            dst[2 * i] = left[i];
+            dst[2 * i + 1] = right[i];
+        }
+    }
+
+    void write(CheckpointWriter& w) const {
+        checkpoint::write_header(w, sampleRate);
+        synth.saveState(w);
+        ambience.saveState(w);
+    }
+
+    bool read(CheckpointReader& r) {
+        return checkpoint::read_header(r, sampleRate) && synth.restoreState(r) && ambience.restoreState(r)
+            && r.atEnd();
+    }
+
+    std::vector<uint8_t> save() const {
+        CheckpointWriter measure(nullptr, 0);
+        write(measure);
+        std::vector<uint8_t> blob(measure.size());
+        CheckpointWriter w(blob.data(), blob.size());
+        write(w);
+        return w.ok() ? blob : std::vector<uint8_t>();
+    }
+};
+
+template <typename Synth>
+void testRoundTrip(double sr, ResonanceEngine engine, const char* precision) {
+    using Sample = typename Synth::Sample;
+    std::vector<Sample> straight(size_t(kNumBlocks) * kBlockSize * 2), resumed(straight.size());
+
+    auto a = std::make_unique<Engine<Synth>>(sr, engine);
+    std::vector<uint8_t> blob;
+    for (int b = 0; b < kNumBlocks; ++b) {
+        if (b == kCheckpointBlock)
+            blob = a->save();
+        a->renderBlock(b, straight);
+    }
+
+    // A fresh pair that played something else first
+    auto b = std::make_unique<Engine<Synth>>(sr, engine);
+    for (int i = 0; i < 40; ++i)
+        b->renderBlock(i + 3, resumed);
+    CheckpointReader r(blob.data(), blob.size());
+    const bool restored = !blob.empty() && b->read(r);
+    for (int i = kCheckpointBlock; i < kNumBlocks; ++i)
+        b->renderBlock(i, resumed);
+
+    const size_t offset = size_t(kCheckpointBlock) * kBlockSize * 2;
+    const bool same = std::memcmp(straight.data() + offset, resumed.data() + offset,
+                                  (straight.size() - offset) * sizeof(Sample)) == 0;
+
+    char what[128];
+    std::snprintf(what, sizeof(what), "%s, %.0f kHz, %s: restores and renders bit-identically",
+                  name(engine), sr / 1000.0, precision);
+    check(restored && same, what);
+}
+
+void testRejected() {
+    std::printf("Unusable checkpoints\n");
+
+    Engine<BreathLeadSynth> source(48000.0, ResonanceEngine::Flute);
+    std::vector<float> out(size_t(kNumBlocks) * kBlockSize * 2);
+    for (int b = 0; b < 20; ++b)
+        source.renderBlock(b, out);
+    const auto blob = source.save();
+
+    Engine<BreathLeadSynth> other(96000.0, ResonanceEngine::Flute);
+    CheckpointReader wrongRate(blob.data(), blob.size());
+    check(!other.read(wrongRate), "another sample rate refused");
+
+    Engine<BreathLeadSynth> same(48000.0, ResonanceEngine::Flute);
+    CheckpointReader truncated(blob.data(), blob.size() - 5);
+    check(!same.read(truncated), "truncated checkpoint refused");
+
+    auto future = blob;
+    const uint32_t version = checkpoint::kVersion + 1;
+    std::memcpy(future.data() + 4, &version, sizeof(version));
+    CheckpointReader newer(future.data(), future.size());
+    check(!same.read(newer), "other checkpoint version refused");
+}
+
+} // namespace
+
+int main() {
+    const ResonanceEngine engines[] = { ResonanceEngine::Formant, ResonanceEngine::Flute, ResonanceEngine::Clarinet };
+
+    std::printf("Save, restore into a fresh synth, render the rest\n");
+    for (double sr : { 48000.0, 96000.0 }) {
+        for (auto engine : engines) {
+            testRoundTrip<BreathLeadSynth>(sr, engine, "float");
+            testRoundTrip<BreathLeadSynthDouble>(sr, engine, "double");
+        }
+    }
+
+    testRejected();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/*
+  test_breath_lead_engine_switch.cpp - Engine changes crossfade
+
+  A held note switches between every pair of resonance engines. Around the
+  switch no sample may step further than the two engines do on their own
+  (a cut used to jump several times that). A checkpoint taken in the
+  middle of a fade must replay it exactly, and a note that starts on a
+  silent voice takes the new engine without a fade.
+*/
+
+#include "dsp/BreathLeadVoice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr float kRate = 48000.f;
+constexpr int kSwitchAt = 24000;
+constexpr int kLength = 48000;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+const char* name(ResonanceEngine engine) {
+    switch (engine) {
+        case ResonanceEngine::Formant:  return "formant";
+        case ResonanceEngine::Flute:    return "flute";
+        case ResonanceEngine::Clarinet: return "clarinet";
+    }
+    return "?";
+}
+
+struct Player {
+    DspArena arena;
+    BreathLeadVoice voice;
+
+    explicit Player(ResonanceEngine engine) {
+        arena.reserve(BreathLeadVoice::arenaBytes(kRate));
+        voice.prepare(kRate, arena);
+        voice.engine = engine;
+    }
+
+    void render(std::vector<float>& out, int from, int to) {
+        for (int i = from; i < to; ++i) {
+            float right = 0.f;
+            voice.process(out[size_t(i)], right);
+        }
+    }
+};
+
+// Largest step between neighbouring samples in [from, to)
+float largestStep(const std::vector<float>& x, int from, int to) {
+    float step = 0.f;
+    for (int i = from; i < to; ++i)
+        step = std::max(step, std::abs(x[size_t(i)] - x[size_t(i) - 1]));
+    return step;
+}
+
+void testSwitch(ResonanceEngine from, ResonanceEngine to) {
+    Player player(from);
+    player.voice.noteOn(330.f, 0.9f);
+
+    std::vector<float> out(kLength);
+    player.render(out, 0, kSwitchAt);
+    player.voice.engine = to;
+    player.render(out, kSwitchAt, kLength);
+
+    // Both engines settled: before the switch, and once the fade is over
+    const int fadeLength = player.voice.shaper.get<Resonator>().fadeLength;
+    const float steady = std::max(largestStep(out, kSwitchAt / 2, kSwitchAt),
+                                  largestStep(out, kSwitchAt + 2 * fadeLength, kLength));
+    const float around = largestStep(out, kSwitchAt - 10, kSwitchAt + 2 * fadeLength);
+
+    char what[96];
+    std::snprintf(what, sizeof(what), "%s -> %s: step %.4f around the switch, %.4f steady",
+                  name(from), name(to), around, steady);
+    check(around <= steady * 1.25f, what);
+}
+
+void testCheckpointMidFade() {
+    std::printf("Checkpoint in the middle of a fade\n");
+
+    Player a(ResonanceEngine::Formant);
+    a.voice.noteOn(330.f, 0.9f);
+    std::vector<float> straight(kLength), resumed(kLength);
+    a.render(straight, 0, kSwitchAt);
+    a.voice.engine = ResonanceEngine::Clarinet;
+    a.render(straight, kSwitchAt, kSwitchAt + 300);
+
+    std::vector<uint8_t> blob(65536);
+    CheckpointWriter w(blob.data(), blob.size());
+    a.voice.saveState(w);
+    a.render(straight, kSwitchAt + 300, kLength);
+
+    Player b(ResonanceEngine::Formant);
+    CheckpointReader r(blob.data(), w.size());
+    check(w.ok() && b.voice.restoreState(r), "fade state restores");
+    b.render(resumed, kSwitchAt + 300, kLength);
+
+    const size_t offset = size_t(kSwitchAt + 300);
+    check(std::memcmp(straight.data() + offset, resumed.data() + offset, (kLength - offset) * sizeof(float)) == 0,
+          "resumed render is bit-identical");
+}
+
+void testSilentVoiceSnaps() {
+    std::printf("Note on a silent voice\n");
+
+    Player player(ResonanceEngine::Formant);
+    std::vector<float> out(kLength);
+    player.voice.noteOn(330.f, 0.9f);
+    player.render(out, 0, 4800);
+    player.voice.noteOff();
+    int pos = 4800;
+    while (player.voice.isActive() && pos < kLength - 1) {
+        player.render(out, pos, pos + 1);
+        ++pos;
+    }
+    check(!player.voice.isActive(), "voice went silent");
+
+    player.voice.engine = ResonanceEngine::Flute;
+    player.voice.noteOn(330.f, 0.9f);
+    player.render(out, pos, pos + 1);
+
+    const auto& resonator = player.voice.shaper.get<Resonator>();
+    check(resonator.current == ResonanceEngine::Flute && resonator.fadeRemaining == 0,
+          "new engine taken at once");
+}
+
+} // namespace
+
+int main() {
+    std::printf("Switches on a held note\n");
+    const ResonanceEngine engines[] = { ResonanceEngine::Formant, ResonanceEngine::Flute, ResonanceEngine::Clarinet };
+    for (auto from : engines)
+        for (auto to : engines)
+            if (from != to)
+                testSwitch(from, to);
+
+    testCheckpointMidFade();
+    testSilentVoiceSnaps();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
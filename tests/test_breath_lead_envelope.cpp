@@ -0,0 +1,99 @@
+/*
+  test_breath_lead_envelope.cpp - Pressure envelope segments land on target
+
+  Long segments at every curve shape, rendered in odd-sized blocks: each
+  segment must stay between its start and its target, and meet the target
+  without a jump at the end (the levels used to drift in a float
+  recurrence and snap back on the last sample).
+*/
+
+#include "dsp/BreathLeadVoice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+constexpr float kRate = 48000.f;
+
+// Renders numSamples levels in blocks of 1..97 samples
+std::vector<float> render(PressureEnvelope& envelope, int numSamples) {
+    std::vector<float> out(size_t(numSamples), 0.f);
+    for (int pos = 0, block = 1; pos < numSamples; block = block % 97 + 1) {
+        const int n = std::min(block, numSamples - pos);
+        envelope.render(out.data() + pos, n);
+        pos += n;
+    }
+    return out;
+}
+
+// Largest step between neighbouring levels, including from `start`
+float largestStep(const std::vector<float>& levels, float start) {
+    float step = 0.f, previous = start;
+    for (float v : levels) {
+        step = std::max(step, std::abs(v - previous));
+        previous = v;
+    }
+    return step;
+}
+
+void testCurve(float curve) {
+    std::printf("Curve %+.1f, 1 s attack, 2 s swell, 3 s release\n", curve);
+
+    EnvelopeShape shape;
+    shape.attackMs = 1000.f;
+    shape.swellMs = 2000.f;
+    shape.releaseMs = 3000.f;
+    shape.sustain = 0.25f;
+    shape.attackCurve = shape.swellCurve = shape.releaseCurve = curve;
+
+    PressureEnvelope envelope;
+    envelope.setShape(shape, kRate);
+    envelope.prepare(kRate);
+
+    constexpr float kPressure = 0.9f;
+    const int attack = int(kRate), swell = int(2.f * kRate), release = int(3.f * kRate);
+
+    envelope.noteOn(kPressure);
+    const auto rise = render(envelope, attack);
+    const auto fall = render(envelope, swell);
+
+    // Linear segments step by span / length; curved ones at most kCurveDepth times that
+    const float riseStep = kPressure / float(attack) * 5.5f;
+    check(*std::max_element(rise.begin(), rise.end()) <= kPressure && rise.back() == kPressure,
+          "attack ends on the note pressure, no overshoot");
+    check(largestStep(rise, 0.f) <= riseStep, "attack has no jump");
+
+    const float sustain = kPressure * shape.sustain;
+    check(*std::min_element(fall.begin(), fall.end()) >= sustain && fall.back() == sustain,
+          "swell ends on the sustain level, no undershoot");
+    check(largestStep(fall, kPressure) <= (kPressure - sustain) / float(swell) * 5.5f, "swell has no jump");
+
+    envelope.noteOff();
+    const auto tail = render(envelope, release + 64);
+    check(*std::min_element(tail.begin(), tail.end()) >= 0.f, "release never goes below zero");
+    check(tail[size_t(release) - 1] == 0.f && !envelope.isActive(), "release ends at zero");
+    check(largestStep(tail, sustain) <= sustain / float(release) * 5.5f, "release has no jump");
+}
+
+} // namespace
+
+int main() {
+    for (float curve : { -1.f, -0.6f, 0.f, 0.6f, 1.f })
+        testCurve(curve);
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
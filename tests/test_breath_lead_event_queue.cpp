@@ -0,0 +1,139 @@
+/*
+  test_breath_lead_event_queue.cpp - EventQueue under concurrent producers
+
+  Several threads push numbered events into a small queue while the
+  consumer drains it. Every event must arrive once, whole, and in its
+  producer's order, or be counted as dropped: received + dropped must
+  equal pushed. Run under -fsanitize=thread for the memory-order side.
+
+    test_breath_lead_event_queue [producers] [events per producer]
+*/
+
+#include "dsp/EventQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Numbered {
+    uint32_t producer;
+    uint32_t sequence;
+    uint64_t check;     // Derived from both; a torn slot fails it
+};
+
+uint64_t checkOf(uint32_t producer, uint32_t sequence) {
+    return (uint64_t(producer) << 32 | sequence) * 0x9E3779B97F4A7C15ull;
+}
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Consumer-side bookkeeping
+struct Tally {
+    std::vector<int64_t> last;      // Last sequence seen per producer
+    uint64_t received = 0;
+    uint64_t torn = 0;
+    uint64_t outOfOrder = 0;
+
+    explicit Tally(int producers) : last(size_t(producers), -1) {}
+
+    void operator()(const Numbered& e) {
+        ++received;
+        if (e.producer >= last.size() || e.check != checkOf(e.producer, e.sequence)) {
+            ++torn;
+            return;
+        }
+        if (int64_t(e.sequence) <= last[e.producer])
+            ++outOfOrder;
+        last[e.producer] = e.sequence;
+    }
+};
+
+template <int Capacity>
+void testConcurrent(int producers, int perProducer, bool slowConsumer) {
+    DSP::EventQueue<Numbered, Capacity> queue;
+    std::atomic<int> running { producers };
+    std::atomic<uint64_t> accepted { 0 };
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            // Against the fast consumer, back off when refused so most
+            // events get through; against the slow one, keep pushing
+            uint64_t ok = 0;
+            for (int s = 0; s < perProducer; ++s) {
+                const bool pushed = queue.push({ uint32_t(p), uint32_t(s), checkOf(uint32_t(p), uint32_t(s)) });
+                ok += pushed ? 1 : 0;
+                if (!pushed && !slowConsumer)
+                    std::this_thread::yield();
+            }
+            accepted.fetch_add(ok);
+            running.fetch_sub(1);
+        });
+    }
+
+    Tally tally(producers);
+    while (running.load() > 0) {
+        queue.drain(tally, slowConsumer ? 16 : Capacity);
+        if (slowConsumer)
+            std::this_thread::yield();
+    }
+    for (auto& t : threads)
+        t.join();
+    while (queue.drain(tally) > 0) {}
+
+    const uint64_t pushed = uint64_t(producers) * uint64_t(perProducer);
+    const uint64_t dropped = queue.getDroppedCount();
+
+    std::printf("%d producers x %d, capacity %d, %s consumer: %llu received, %llu dropped\n",
+                producers, perProducer, Capacity, slowConsumer ? "slow" : "fast",
+                (unsigned long long)tally.received, (unsigned long long)dropped);
+    check(tally.torn == 0, "no torn events");
+    check(tally.outOfOrder == 0, "each producer's events in push order");
+    check(tally.received == accepted.load(), "every accepted event received once");
+    check(tally.received + dropped == pushed, "received + dropped == pushed");
+    if (!slowConsumer)
+        check(tally.received > pushed / 2, "most events delivered");
+    check(queue.getNumPending() == 0, "queue empty at the end");
+}
+
+void testFullQueue() {
+    std::printf("Full queue, no consumer\n");
+
+    DSP::EventQueue<Numbered, 64> queue;
+    int refused = 0;
+    for (uint32_t s = 0; s < 64 + 10; ++s)
+        refused += queue.push({ 0, s, checkOf(0, s) }) ? 0 : 1;
+    check(refused == 10 && queue.getDroppedCount() == 10, "the 10 events past capacity are refused and counted");
+
+    Tally tally(1);
+    check(queue.drain(tally) == 64 && tally.outOfOrder == 0 && tally.last[0] == 63,
+          "the first 64 drain in order");
+    check(queue.push({ 0, 100, checkOf(0, 100) }), "room again after the drain");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    const int producers = argc > 1 ? std::max(1, std::atoi(argv[1])) : int(std::min(hardware, 8u));
+    const int perProducer = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200000;
+
+    testFullQueue();
+    testConcurrent<1024>(producers, perProducer, false);
+    testConcurrent<64>(producers, perProducer, true);
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/*
+  test_breath_lead_formant_filter.cpp - The TPT bandpass behind the formant
+
+  BasicBandpassFilter peaks at its cutoff with a gain of Q, at every sample
+  rate, and follows the prewarped analog response around it. It stays
+  bounded at the highest Q with the cutoff pushed against Nyquist, keeps
+  its coefficients while the pitch moves by less than kPitchTolerance, and
+  the block entry point produces exactly what the per-sample one does.
+*/
+
+#include "dsp/BreathLeadVoice.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Steady-state gain for a unit sine: the filter settles for a second, then
+// output RMS over the next 100 ms against the input's
+template <typename T>
+double gainAt(BasicBandpassFilter<T>& filter, double hz, double rate) {
+    filter.reset();
+    double in2 = 0.0, out2 = 0.0, phase = 0.0;
+    const int settle = int(rate), measure = int(rate / 10);
+    for (int i = 0; i < settle + measure; ++i) {
+        const double x = std::sin(phase);
+        const T y = filter.process(T(x));
+        phase += 2.0 * std::numbers::pi * hz / rate;
+        if (i >= settle) {
+            in2 += x * x;
+            out2 += double(y) * double(y);
+        }
+    }
+    return std::sqrt(out2 / in2);
+}
+
+// The analog bandpass Q / sqrt(1 + Q^2 (x - 1/x)^2), on the bilinear
+// transform's prewarped frequency axis
+double expectedGain(double hz, double cutoff, double q, double rate) {
+    const double x = std::tan(std::numbers::pi * hz / rate) / std::tan(std::numbers::pi * cutoff / rate);
+    return q / std::sqrt(1.0 + q * q * (x - 1.0 / x) * (x - 1.0 / x));
+}
+
+void testResponse() {
+    std::printf("Peak at the cutoff, gain Q, prewarped skirts\n");
+
+    struct Case {
+        double rate;
+        float cutoff, q;
+    };
+    const Case cases[] = {
+        { 44100.0, 220.f, 1.f }, { 48000.0, 440.f, 3.f }, { 96000.0, 880.f, 5.f },
+        { 192000.0, 1760.f, 5.f }, { 48000.0, 8000.f, 2.f },
+    };
+
+    for (const auto& c : cases) {
+        BandpassFilter filter;
+        filter.setFrequency(c.cutoff, float(c.rate));
+        filter.setQ(c.q);
+
+        bool matches = true;
+        double atCutoff = 0.0;
+        for (const double ratio : { 1.0, 0.5, 2.0, 0.9 }) {
+            const double hz = c.cutoff * ratio;
+            const double gain = gainAt(filter, hz, c.rate);
+            matches = matches && std::abs(gain - expectedGain(hz, c.cutoff, c.q, c.rate)) < 0.005 * c.q;
+            if (ratio == 1.0)
+                atCutoff = gain;
+        }
+
+        char what[96];
+        std::snprintf(what, sizeof(what), "%6.0f Hz, %4.0f Hz, Q %.0f: gain %.3f at the cutoff",
+                      c.rate, c.cutoff, c.q, atCutoff);
+        check(matches && std::abs(atCutoff - c.q) < 0.005 * c.q, what);
+    }
+}
+
+void testStability() {
+    std::printf("Stability\n");
+
+    for (const double rate : { 44100.0, 192000.0 }) {
+        BandpassFilter filter;
+        filter.setFrequency(float(rate), float(rate));     // Clamped just below Nyquist
+        filter.setQ(100.f);                                 // Clamped to 10
+
+        std::minstd_rand random(7);
+        std::uniform_real_distribution<float> noise(-1.f, 1.f);
+        float peak = 0.f;
+        bool finite = true;
+        for (int i = 0; i < 10 * int(rate); ++i) {
+            const float y = filter.process(noise(random));
+            finite = finite && std::isfinite(y);
+            peak = std::max(peak, std::abs(y));
+        }
+
+        char what[96];
+        std::snprintf(what, sizeof(what), "%.0f Hz, Q 10 at Nyquist, 10 s of noise: peak %.2f", rate, peak);
+        check(finite && peak < 50.f, what);
+    }
+}
+
+void testCoefficientCache() {
+    std::printf("Coefficient cache\n");
+
+    BandpassFilter filter;
+    filter.setQ(2.f);
+    filter.setFrequency(440.f, 48000.f);
+    const float g = filter.g;
+
+    filter.setFrequency(440.f * (1.f + 0.5f * BandpassFilter::kPitchTolerance), 48000.f);
+    check(filter.g == g && filter.freq == 440.f, "a move inside the tolerance keeps the coefficients");
+
+    filter.setFrequency(440.f * 1.001f, 48000.f);
+    check(filter.g > g, "a larger move recomputes them");
+
+    const float g2 = filter.g;
+    filter.setFrequency(filter.freq, 96000.f);
+    check(filter.g < g2, "so does a new sample rate");
+
+    const float a1 = filter.a1;
+    filter.setQ(2.f);
+    check(filter.a1 == a1, "the same Q recomputes nothing");
+    filter.setQ(4.f);
+    check(filter.a1 != a1 && filter.k == 0.25f, "a new Q does");
+}
+
+void testBlockMatchesSamples() {
+    std::printf("Block processing\n");
+
+    std::vector<float> in(4096);
+    std::minstd_rand random(3);
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    for (float& x : in)
+        x = noise(random);
+
+    BandpassFilter perSample, block;
+    for (auto* f : { &perSample, &block }) {
+        f->setFrequency(660.f, 48000.f);
+        f->setQ(4.f);
+    }
+
+    std::vector<float> expected(in.size()), out(in);
+    for (size_t i = 0; i < in.size(); ++i)
+        expected[i] = perSample.process(in[i]);
+    for (size_t i = 0; i < in.size(); i += 100)                // 100-sample blocks, in place
+        block.process(out.data() + i, out.data() + i, int(std::min<size_t>(100, in.size() - i)));
+
+    check(std::memcmp(out.data(), expected.data(), out.size() * sizeof(float)) == 0,
+          "process(in, out, n) matches process(x), in place, across blocks");
+    check(block.ic1 == perSample.ic1 && block.ic2 == perSample.ic2, "and leaves the same state");
+}
+
+} // namespace
+
+int main() {
+    testResponse();
+    testStability();
+    testCoefficientCache();
+    testBlockMatchesSamples();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/*
+  test_breath_lead_json_fuzz.cpp - Preset JSON survives arbitrary input
+
+  Random mutations of valid presets and hand-written edge cases (escapes,
+  exponents, deep nesting, unknown members) go through
+  BreathLeadDSP::loadPreset() and a bare JsonReader. Every document sits
+  in a heap buffer of exactly its length, so a read past the terminator
+  shows up under -fsanitize=address. For each document:
+
+  - a rejected preset leaves every parameter as it was
+  - an accepted one leaves them finite and in range, and saves and loads
+    again to the same values
+  - JsonReader::skipValue() returns (no hang, no recursion)
+
+  Random parameter sets must also round-trip bit-exactly.
+
+    test_breath_lead_json_fuzz [documents] [seed]
+
+  With BREATHLEAD_LIBFUZZER defined (cmake -DBREATHLEAD_LIBFUZZER=ON, clang)
+  the same checks build as a libFuzzer target, fuzz_breath_lead_json.
+*/
+
+#include "dsp/BreathLeadDSP.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+using Values = float[BreathLeadDSP::kNumParameters];
+
+constexpr int kPresetBufferSize = 2048;
+
+void getValues(const BreathLeadDSP& dsp, Values& out) {
+    for (int i = 0; i < BreathLeadDSP::kNumParameters; ++i)
+        out[i] = dsp.getParameter(BreathLeadDSP::kParameters[i].id);
+}
+
+bool sameValues(const Values& a, const Values& b) {
+    return std::memcmp(a, b, sizeof(Values)) == 0;
+}
+
+// Off the defaults, so a partial load would show
+void setDistinctValues(BreathLeadDSP& dsp) {
+    for (int i = 0; i < BreathLeadDSP::kNumParameters; ++i) {
+        const auto& info = BreathLeadDSP::kParameters[i];
+        dsp.setParameter(info.id, info.minValue + (info.maxValue - info.minValue) * 0.37f);
+    }
+}
+
+// The checks on one null-terminated document; null when they all hold
+const char* checkDocument(const char* text, bool* accepted = nullptr) {
+    BreathLeadDSP dsp;
+    setDistinctValues(dsp);
+    Values before, after;
+    getValues(dsp, before);
+
+    const bool loaded = dsp.loadPreset(text);
+    getValues(dsp, after);
+    if (accepted != nullptr)
+        *accepted = loaded;
+
+    if (!loaded) {
+        if (!sameValues(before, after))
+            return "rejected preset changed parameters";
+    } else {
+        for (int i = 0; i < BreathLeadDSP::kNumParameters; ++i) {
+            const auto& info = BreathLeadDSP::kParameters[i];
+            if (!std::isfinite(after[i]) || after[i] < info.minValue || after[i] > info.maxValue)
+                return "accepted preset left a value out of range";
+        }
+
+        char saved[kPresetBufferSize];
+        BreathLeadDSP again;
+        Values reloaded;
+        if (!dsp.savePreset(saved, sizeof(saved)) || !again.loadPreset(saved))
+            return "accepted preset does not save and load again";
+        getValues(again, reloaded);
+        if (!sameValues(after, reloaded))
+            return "accepted preset does not round-trip";
+    }
+
+    JsonReader reader(text);
+    reader.skipValue();
+    return nullptr;
+}
+
+} // namespace
+
+#if BREATHLEAD_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::vector<char> text(data, data + size);
+    text.push_back('\0');
+    if (const char* error = checkDocument(text.data())) {
+        std::fprintf(stderr, "%s\n", error);
+        std::abort();
+    }
+    return 0;
+}
+
+#else
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    int below(int n) { return int(next() % uint64_t(n)); }
+    float unit() { return float(next() >> 40) / float(1 << 24); }
+};
+
+// Valid presets with random values, then edge cases
+std::vector<std::string> makeCorpus(Random& random) {
+    std::vector<std::string> corpus;
+
+    char buffer[kPresetBufferSize];
+    for (int n = 0; n < 16; ++n) {
+        BreathLeadDSP dsp;
+        for (const auto& info : BreathLeadDSP::kParameters)
+            dsp.setParameter(info.id, info.minValue + (info.maxValue - info.minValue) * random.unit());
+        if (dsp.savePreset(buffer, sizeof(buffer)))
+            corpus.emplace_back(buffer);
+    }
+
+    const char* edgeCases[] = {
+        R"({"schema":"breathlead.preset","version":1,"parameters":{}})",
+        R"( { "parameters" : { "air" : 1e-2 , "tone":-0.0,"release":3.0E+3 } ,"version":1.0,)"
+        R"("schema":"breathlead.preset" } )",
+        R"({"schema":"breathlead.preset","version":1,"parameters":{"air":0.5,"unknown":)"
+        R"({"a":[1,2,{"b":[true,false,null,"x\"y\\zA"]}],"c":{}},"tone":0.25},"extra":[[]]})",
+        R"({"schema":"breathlead.preset","version":1,"parameters":{"attack":123456789012345678901234567890,)"
+        R"("swell":0.000000000000000000000000000001,"sustain":1e400,"room":-1e-400}})",
+        R"({"schema":"breathlead.preset","version":2,"parameters":{}})",
+        R"({"schema":"other","version":1,"parameters":{}})",
+        R"({"schema":"breathlead.preset","version":1,"parameters":{"air":"0.5"}})",
+        R"({"schema":"breathlead.preset","version":1,"parameters":{"air":0.5}} trailing)",
+        R"([1,2,3])",
+        R"("just a string")",
+        R"({"schema":"breathlead.preset","version":1,"parameters":{"air":0.9,"air\n":0.1}})",
+    };
+    for (const char* text : edgeCases)
+        corpus.emplace_back(text);
+
+    // Unknown values nested around the parser's depth limits
+    for (int depth : { 62, 63, 64, 65, 200 }) {
+        std::string nested = R"({"schema":"breathlead.preset","version":1,"parameters":{"deep":)";
+        for (int i = 0; i < depth; ++i)
+            nested += i % 2 == 0 ? "[" : "{\"k\":";
+        nested += "0";
+        for (int i = depth - 1; i >= 0; --i)
+            nested += i % 2 == 0 ? "]" : "}";
+        nested += "}}";
+        corpus.push_back(nested);
+    }
+    return corpus;
+}
+
+// One to four edits biased toward bytes that matter to JSON
+std::string mutate(const std::vector<std::string>& corpus, Random& random) {
+    static const char kSignificant[] = "{}[]\":,.-+eE0123456789tfnul\\ \t\n";
+
+    std::string text = corpus[size_t(random.below(int(corpus.size())))];
+    const int edits = 1 + random.below(4);
+    for (int e = 0; e < edits; ++e) {
+        const size_t pos = text.empty() ? 0 : size_t(random.below(int(text.size())));
+        const char byte = random.below(4) == 0 ? char(1 + random.below(255))
+                                               : kSignificant[random.below(int(sizeof(kSignificant) - 1))];
+        switch (random.below(7)) {
+            case 0: if (!text.empty()) text[pos] = byte; break;
+            case 1: text.insert(pos, 1, byte); break;
+            case 2: text.erase(pos, size_t(1 + random.below(8))); break;
+            case 3: text.resize(pos); break;
+            case 4: if (!text.empty()) text[pos] = char(text[pos] ^ (1 << random.below(8))); break;
+            case 5: text.insert(pos, text.substr(size_t(random.below(int(text.size()) + 1)), size_t(random.below(32)))); break;
+            case 6: {
+                const auto& other = corpus[size_t(random.below(int(corpus.size())))];
+                const size_t from = size_t(random.below(int(other.size()) + 1));
+                text = text.substr(0, pos) + other.substr(from);
+                break;
+            }
+        }
+    }
+    // Documents end at the first NUL
+    text.resize(std::strlen(text.c_str()));
+    return text;
+}
+
+void testRoundTrip(Random& random) {
+    std::printf("Random parameter sets\n");
+
+    int matching = 0;
+    constexpr int kSets = 2000;
+    char buffer[kPresetBufferSize];
+    for (int n = 0; n < kSets; ++n) {
+        BreathLeadDSP source, target;
+        for (const auto& info : BreathLeadDSP::kParameters) {
+            const int pick = random.below(8);
+            const float v = pick == 0 ? info.minValue
+                          : pick == 1 ? info.maxValue
+                          : info.minValue + (info.maxValue - info.minValue) * random.unit();
+            source.setParameter(info.id, v);
+        }
+        Values a, b;
+        getValues(source, a);
+        if (source.savePreset(buffer, sizeof(buffer)) && target.loadPreset(buffer)) {
+            getValues(target, b);
+            matching += sameValues(a, b) ? 1 : 0;
+        }
+    }
+
+    char what[96];
+    std::snprintf(what, sizeof(what), "%d/%d saved and loaded bit-exactly", matching, kSets);
+    check(matching == kSets, what);
+}
+
+void testMutations(const std::vector<std::string>& corpus, Random& random, int numDocuments) {
+    std::printf("%d mutated documents\n", numDocuments);
+
+    int accepted = 0;
+    const char* firstError = nullptr;
+    std::string firstFailing;
+
+    for (int n = 0; n < numDocuments; ++n) {
+        const std::string text = n < int(corpus.size()) ? corpus[size_t(n)] : mutate(corpus, random);
+
+        // Exactly the document and its terminator, so overreads hit the redzone
+        std::vector<char> exact(text.begin(), text.end());
+        exact.push_back('\0');
+
+        bool loaded = false;
+        const char* error = checkDocument(exact.data(), &loaded);
+        accepted += loaded ? 1 : 0;
+        if (error != nullptr && firstError == nullptr) {
+            firstError = error;
+            firstFailing = text;
+        }
+    }
+
+    if (firstError != nullptr)
+        std::printf("  first failure: %s\n    %.200s\n", firstError, firstFailing.c_str());
+    check(firstError == nullptr, "every document handled");
+
+    char what[96];
+    std::snprintf(what, sizeof(what), "both outcomes exercised (%d accepted, %d rejected)",
+                  accepted, numDocuments - accepted);
+    check(accepted > 0 && accepted < numDocuments, what);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int numDocuments = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50000;
+    const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 0xB4EA7Dull;
+
+    Random random { seed };
+    const auto corpus = makeCorpus(random);
+
+    testRoundTrip(random);
+    testMutations(corpus, random, numDocuments);
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+#endif
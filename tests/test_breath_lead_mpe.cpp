@@ -0,0 +1,190 @@
+/*
+  test_breath_lead_mpe.cpp - MPE expression reaches the right voice
+
+  Three notes on three member channels of the default lower zone. Pitch
+  bend, channel pressure and CC74 sent on one channel must move that
+  channel's voice only; the same messages on the master channel move
+  every voice. Bend and timbre sent before a note-on seed the note (as
+  the MPE spec allows), and with MPE off a member-channel bend is global.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+
+using namespace breath;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr int kBlockSize = 256;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+bool near(float a, float b, float tolerance) { return std::abs(a - b) <= tolerance; }
+
+class MpeRig {
+public:
+    explicit MpeRig(bool mpe) {
+        arena_.reserve(BreathLeadSynth::arenaBytes(kRate));
+        synth_->prepare(kRate, arena_);
+        synth_->setMpeEnabled(mpe);
+    }
+
+    void send(std::initializer_list<uint8_t> bytes) {
+        synth_->handleMidi(bytes.begin(), int(bytes.size()));
+    }
+
+    // 14-bit bend, -1..+1 of the channel's range
+    void bend(int channel, float amount) {
+        const int value = int(std::lround((amount + 1.f) * 8192.f));
+        const int clamped = value > 16383 ? 16383 : value;
+        send({ uint8_t(0xE0 | channel), uint8_t(clamped & 0x7F), uint8_t(clamped >> 7) });
+    }
+
+    // Long enough for every expression smoother to settle
+    void settle() {
+        float left[kBlockSize], right[kBlockSize];
+        for (int b = 0; b < 40; ++b) {
+            synth_->beginBlock();
+            synth_->render(left, right, kBlockSize);
+        }
+    }
+
+    // The voice holding `note` on `channel`
+    const VoiceSlot<BreathLeadVoice>* voiceOf(int channel, int note) const {
+        for (int i = 0; i < kMaxVoices; ++i) {
+            const auto& slot = synth_->getVoiceSlot(i);
+            if (slot.channel == channel && slot.note == note)
+                return &slot;
+        }
+        return nullptr;
+    }
+
+    const SynthParameters& parameters() const { return synth_->getParameters(); }
+
+private:
+    DspArena arena_;
+    std::unique_ptr<BreathLeadSynth> synth_ = std::make_unique<BreathLeadSynth>();
+};
+
+struct Note { int channel; int note; };
+constexpr Note kNotes[] = { { 1, 60 }, { 2, 64 }, { 3, 67 } };
+
+void playChord(MpeRig& rig) {
+    for (const auto& n : kNotes)
+        rig.send({ uint8_t(0x90 | n.channel), uint8_t(n.note), 100 });
+    rig.settle();
+}
+
+void testPerChannelRouting() {
+    std::printf("Member-channel expression\n");
+
+    MpeRig rig(true);
+    playChord(rig);
+
+    const auto* a = rig.voiceOf(1, 60);
+    const auto* b = rig.voiceOf(2, 64);
+    const auto* c = rig.voiceOf(3, 67);
+    check(a != nullptr && b != nullptr && c != nullptr && a != b && b != c && a != c,
+          "each member-channel note has its own voice");
+    if (a == nullptr || b == nullptr || c == nullptr)
+        return;
+
+    const float baseA = a->voice.freq, baseB = b->voice.freq, baseC = c->voice.freq;
+
+    // +12 semitones of the 48 semitone member range on channel 2
+    rig.bend(2, 0.25f);
+    rig.settle();
+    check(near(b->voice.freq, baseB * 2.f, baseB * 0.002f), "bend on channel 2 raises its note an octave");
+    check(a->voice.freq == baseA && c->voice.freq == baseC, "the other notes keep their pitch");
+
+    rig.send({ 0xD1, 127 });
+    rig.settle();
+    check(a->hasPressure && near(a->voice.resistance, 0.8f, 1e-3f), "pressure on channel 1 reaches its voice");
+    check(!b->hasPressure && !c->hasPressure && b->voice.resistance == rig.parameters().resistance,
+          "the other voices keep the patch resistance");
+
+    rig.send({ 0xB3, 74, 0 });
+    rig.settle();
+    check(c->hasTimbre && near(c->voice.formantParam, 0.f, 1e-3f), "CC74 on channel 3 reaches its voice");
+    check(!a->hasTimbre && !b->hasTimbre && a->voice.formantParam == rig.parameters().formant,
+          "the other voices keep the patch formant");
+}
+
+void testMasterChannel() {
+    std::printf("Master-channel expression\n");
+
+    MpeRig rig(true);
+    playChord(rig);
+
+    rig.send({ 0xD0, 64 });
+    rig.send({ 0xB0, 74, 127 });
+    rig.settle();
+
+    int reached = 0;
+    for (const auto& n : kNotes) {
+        const auto* slot = rig.voiceOf(n.channel, n.note);
+        if (slot != nullptr && slot->hasPressure && slot->hasTimbre && near(slot->voice.formantParam, 1.f, 1e-3f))
+            ++reached;
+    }
+    check(reached == 3, "pressure and CC74 on the master channel reach every voice");
+}
+
+void testExpressionBeforeNoteOn() {
+    std::printf("Expression sent before the note-on\n");
+
+    MpeRig rig(true);
+    rig.send({ 0x94, 60, 100 });
+    rig.settle();
+    const float unbent = rig.voiceOf(4, 60)->voice.freq;
+    rig.send({ 0x84, 60, 0 });
+
+    rig.bend(5, -0.25f);
+    rig.send({ 0xB5, 74, 32 });
+    rig.send({ 0x95, 60, 100 });
+    rig.settle();
+
+    const auto* slot = rig.voiceOf(5, 60);
+    check(slot != nullptr && near(slot->voice.freq, unbent * 0.5f, unbent * 0.002f),
+          "a bend sent first starts the note bent");
+    check(slot != nullptr && slot->hasTimbre && near(slot->voice.formantParam, 32.f / 127.f, 1e-3f),
+          "a CC74 sent first starts the note with that timbre");
+}
+
+void testMpeOff() {
+    std::printf("MPE off\n");
+
+    MpeRig rig(false);
+    rig.send({ 0x92, 69, 100 });
+    rig.settle();
+    const auto* slot = rig.voiceOf(2, 69);
+    const float base = slot != nullptr ? slot->voice.freq : 0.f;
+
+    // The global 2 semitone range, whatever the channel
+    rig.bend(7, 1.f);
+    rig.settle();
+    check(slot != nullptr && near(slot->voice.freq, base * std::exp2(2.f * 8191.f / 8192.f / 12.f), base * 0.002f),
+          "bend on another channel bends the note by the master range");
+}
+
+} // namespace
+
+int main() {
+    testPerChannelRouting();
+    testMasterChannel();
+    testExpressionBeforeNoteOn();
+    testMpeOff();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
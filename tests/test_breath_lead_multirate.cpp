@@ -0,0 +1,208 @@
+/*
+  test_breath_lead_multirate.cpp - Slow voice stages at a decimated rate
+
+  PolyphaseInterpolator: factor 1 passes through; higher factors keep DC
+  and the passband at unity, push the image of a low-rate tone down, and
+  delay by getLatency().
+
+  The voice: the divider follows the host rate (1 up to 48 kHz, 2 at
+  88.2/96, 4 at 176.4/192), setMultirate(false) keeps it at 1, 48 kHz
+  output does not change with multirate on, a held note keeps its level
+  across rates, and the slow-stage phase carries over host blocks of any
+  size.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+#include "dsp/PolyphaseResampler.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Amplitude of the component at `cycles` per sample (Goertzel)
+double amplitudeAt(const std::vector<float>& x, double cycles) {
+    const double w = 2.0 * std::numbers::pi * cycles;
+    double s1 = 0.0, s2 = 0.0;
+    for (const float v : x) {
+        const double s = double(v) + 2.0 * std::cos(w) * s1 - s2;
+        s2 = s1;
+        s1 = s;
+    }
+    const double power = s1 * s1 + s2 * s2 - 2.0 * std::cos(w) * s1 * s2;
+    return 2.0 * std::sqrt(std::max(power, 0.0)) / double(x.size());
+}
+
+// A low-rate sine (cycles per low-rate sample) through the interpolator;
+// returns the high-rate output after the filter has filled
+std::vector<float> upsample(PolyphaseInterpolator& up, double cycles, int inputs) {
+    std::vector<float> out(size_t(inputs * up.getFactor()));
+    for (int n = 0; n < inputs; ++n)
+        up.process(float(std::sin(2.0 * std::numbers::pi * cycles * n)), out.data() + size_t(n * up.getFactor()));
+    out.erase(out.begin(), out.begin() + 64 * up.getFactor());
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Interpolator
+// -----------------------------------------------------------------------------
+void testInterpolator() {
+    std::printf("Polyphase interpolator\n");
+
+    PolyphaseInterpolator up;
+    up.prepare(1);
+    float out[PolyphaseInterpolator::kMaxFactor] = {};
+    up.process(0.625f, out);
+    check(out[0] == 0.625f && up.getLatency() == 0.f, "factor 1 passes through");
+
+    for (const int factor : { 2, 4 }) {
+        up.prepare(factor);
+        char what[128];
+
+        bool dc = true;
+        for (int n = 0; n < 64; ++n) {
+            up.process(1.f, out);
+            for (int p = 0; p < factor && n >= PolyphaseInterpolator::kTapsPerPhase; ++p)
+                dc = dc && std::abs(out[p] - 1.f) < 1e-5f;
+        }
+        std::snprintf(what, sizeof(what), "x%d: unity DC on every phase", factor);
+        check(dc, what);
+
+        // 0.1 of the low rate: passband. 0.3: its image at 0.7 of the low
+        // rate is what the filter is there to remove.
+        up.reset();
+        const auto pass = upsample(up, 0.1, 4096);
+        const double passGain = amplitudeAt(pass, 0.1 / factor);
+        up.reset();
+        const auto high = upsample(up, 0.3, 4096);
+        const double image = amplitudeAt(high, 0.7 / factor) / amplitudeAt(high, 0.3 / factor);
+
+        std::snprintf(what, sizeof(what), "x%d: passband gain %.3f, image of 0.3 fs at %.1f dB", factor, passGain,
+                      20.0 * std::log10(image));
+        check(std::abs(passGain - 1.0) < 0.02 && image < 0.03, what);
+
+        // The impulse response peaks at the group delay
+        up.reset();
+        std::vector<float> impulse;
+        for (int n = 0; n < 16; ++n) {
+            up.process(n == 0 ? 1.f : 0.f, out);
+            impulse.insert(impulse.end(), out, out + factor);
+        }
+        const double centre = up.getLatency() * factor;    // In high-rate samples
+        const auto peak = std::max_element(impulse.begin(), impulse.end()) - impulse.begin();
+        std::snprintf(what, sizeof(what), "x%d: impulse peaks at getLatency() (%.2f low-rate samples)", factor,
+                      up.getLatency());
+        check(std::abs(double(peak) - centre) <= 0.5, what);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Voice
+// -----------------------------------------------------------------------------
+struct Player {
+    DspArena arena;
+    std::unique_ptr<BreathLeadSynth> synth = std::make_unique<BreathLeadSynth>();
+
+    Player(double rate, bool multirate = true) {
+        synth->setMultirate(multirate);
+        arena.reserve(BreathLeadSynth::arenaBytes(rate));
+        synth->prepare(rate, arena);
+    }
+
+    int divider() const { return synth->getVoiceSlot(0).voice.rateDivider; }
+
+    // A held A3 at a steady breath, `seconds` long, in host blocks of
+    // `blockSize`
+    std::vector<float> play(double rate, double seconds, int blockSize) {
+        const uint8_t breath[] = { 0xB0, 2, 90 };
+        const uint8_t on[] = { 0x90, 57, 100 };
+        synth->handleMidi(breath, 3);
+        synth->handleMidi(on, 3);
+
+        std::vector<float> left(size_t(seconds * rate)), right(left.size());
+        for (size_t pos = 0; pos < left.size(); pos += size_t(blockSize)) {
+            const int n = int(std::min(left.size() - pos, size_t(blockSize)));
+            synth->beginBlock();
+            synth->render(left.data() + pos, right.data() + pos, n);
+        }
+        return left;
+    }
+};
+
+double rms(const std::vector<float>& x, size_t from) {
+    double sum = 0.0;
+    for (size_t i = from; i < x.size(); ++i)
+        sum += double(x[i]) * double(x[i]);
+    return std::sqrt(sum / double(x.size() - from));
+}
+
+void testDivider() {
+    std::printf("Rate divider\n");
+
+    struct Expect {
+        double rate;
+        int divider;
+    };
+    bool all = true;
+    for (const auto& e : { Expect { 44100.0, 1 }, Expect { 48000.0, 1 }, Expect { 88200.0, 2 },
+                           Expect { 96000.0, 2 }, Expect { 176400.0, 4 }, Expect { 192000.0, 4 } }) {
+        const int divider = Player(e.rate).divider();
+        std::printf("  %6.0f Hz: / %d\n", e.rate, divider);
+        all = all && divider == e.divider;
+    }
+    check(all, "the slow stages run near 48 kHz");
+    check(Player(192000.0, false).divider() == 1, "setMultirate(false) keeps them at host rate");
+}
+
+void testVoice() {
+    std::printf("Multirate voice\n");
+
+    {
+        Player on(48000.0, true), off(48000.0, false);
+        const auto a = on.play(48000.0, 1.0, 480), b = off.play(48000.0, 1.0, 480);
+        check(a == b, "48 kHz: the same output with multirate on or off");
+    }
+
+    const double reference = rms(Player(48000.0).play(48000.0, 1.0, 480), 4800);
+    for (const double rate : { 96000.0, 192000.0 }) {
+        const double level = rms(Player(rate).play(rate, 1.0, 480), size_t(rate / 10));
+        char what[96];
+        std::snprintf(what, sizeof(what), "%.0f Hz: level %+.2f dB against 48 kHz", rate,
+                      20.0 * std::log10(level / reference));
+        check(std::abs(20.0 * std::log10(level / reference)) < 0.5, what);
+    }
+
+    // Odd block sizes start and end inside a slow-stage sample
+    const auto blocks480 = Player(192000.0).play(192000.0, 0.5, 480);
+    const auto blocks17 = Player(192000.0).play(192000.0, 0.5, 17);
+    const auto blocks1023 = Player(192000.0).play(192000.0, 0.5, 1023);
+    check(blocks17.size() == blocks480.size()
+              && std::memcmp(blocks17.data(), blocks480.data(), blocks17.size() * sizeof(float)) == 0
+              && blocks1023 == blocks480,
+          "192 kHz: 17, 480 and 1023-sample blocks render alike");
+}
+
+} // namespace
+
+int main() {
+    testInterpolator();
+    testDivider();
+    testVoice();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
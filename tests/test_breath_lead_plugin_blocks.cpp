@@ -0,0 +1,138 @@
+/*
+  test_breath_lead_plugin_blocks.cpp - processBlock() output vs host block size
+
+  The same MIDI performance, timed in absolute samples, is played through a
+  fresh processor at host blocks of 32, 64 and 512 samples (offline, so the
+  quality governor stays out of it). The renders must match. A block
+  carrying more MIDI than the pending queue holds must count exactly the
+  excess in getDroppedMidiCount().
+*/
+
+#include "plugin/BreathLeadProcessor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr double kRate = 48000.0;
+    constexpr int kLength = 96000;
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+        if (!condition)
+            ++failures;
+    }
+
+    // Absolute sample position → message
+    juce::MidiBuffer makePerformance()
+    {
+        juce::MidiBuffer performance;
+        performance.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 100);
+        for (int t = 300; t < 40000; t += 613)
+            performance.addEvent(juce::MidiMessage::controllerEvent(1, 2, t / 613 * 5 % 128), t);
+        performance.addEvent(juce::MidiMessage::pitchWheel(1, 10000), 9001);
+        performance.addEvent(juce::MidiMessage::noteOff(1, 60), 30011);
+        performance.addEvent(juce::MidiMessage::noteOn(1, 67, 0.6f), 30011);
+        performance.addEvent(juce::MidiMessage::controllerEvent(1, 1, 90), 41007);
+        performance.addEvent(juce::MidiMessage::noteOff(1, 67), 70003);
+        return performance;
+    }
+
+    std::vector<float> render(const juce::MidiBuffer& performance, int blockSize)
+    {
+        BreathLeadProcessor processor;
+        processor.setNonRealtime(true);
+        processor.setPlayConfigDetails(2, 2, kRate, blockSize);
+        processor.prepareToPlay(kRate, blockSize);
+
+        std::vector<float> out(kLength);
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int pos = 0; pos < kLength; pos += blockSize)
+        {
+            const int n = juce::jmin(blockSize, kLength - pos);
+            buffer.setSize(2, n, false, false, true);
+            buffer.clear();
+
+            midi.clear();
+            midi.addEvents(performance, pos, n, -pos);
+
+            processor.processBlock(buffer, midi);
+            std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + n, out.begin() + pos);
+        }
+
+        processor.releaseResources();
+        return out;
+    }
+
+    void testBlockSizes()
+    {
+        std::printf("Host block sizes\n");
+
+        const auto performance = makePerformance();
+        const auto reference = render(performance, 32);
+
+        float peak = 0.0f;
+        for (float x : reference)
+            peak = juce::jmax(peak, std::abs(x));
+        check(peak > 0.01f, "the performance is audible");
+
+        for (const int blockSize : { 64, 512 })
+        {
+            const auto output = render(performance, blockSize);
+            char what[64];
+            std::snprintf(what, sizeof(what), "%d-sample blocks match 32", blockSize);
+            check(std::memcmp(output.data(), reference.data(), output.size() * sizeof(float)) == 0, what);
+        }
+    }
+
+    void testOverflow()
+    {
+        std::printf("MIDI overflow\n");
+
+        constexpr int kBlockSize = 256;
+        constexpr int kExcess = 37;
+
+        BreathLeadProcessor processor;
+        processor.setNonRealtime(true);
+        processor.setPlayConfigDetails(2, 2, kRate, kBlockSize);
+        processor.prepareToPlay(kRate, kBlockSize);
+
+        juce::AudioBuffer<float> buffer(2, kBlockSize);
+        juce::MidiBuffer midi;
+        const auto before = processor.getDroppedMidiCount();
+
+        for (int i = 0; i < BreathLeadProcessor::kMaxPendingMidi + kExcess; ++i)
+            midi.addEvent(juce::MidiMessage::controllerEvent(1, 2, i % 128), i % kBlockSize);
+        buffer.clear();
+        processor.processBlock(buffer, midi);
+        check(processor.getDroppedMidiCount() == before + kExcess, "the messages past the queue are counted");
+
+        midi.clear();
+        for (int i = 0; i < BreathLeadProcessor::kMaxPendingMidi; ++i)
+            midi.addEvent(juce::MidiMessage::controllerEvent(1, 2, i % 128), i % kBlockSize);
+        buffer.clear();
+        processor.processBlock(buffer, midi);
+        check(processor.getDroppedMidiCount() == before + kExcess, "a full queue is emptied by the block");
+
+        processor.releaseResources();
+    }
+}
+
+int main()
+{
+    const juce::ScopedJuceInitialiser_GUI juce;
+
+    testBlockSizes();
+    testOverflow();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*
+  test_breath_lead_plugin_rt.cpp - processBlock() never allocates or locks
+
+  The processor is compiled into this console app with BREATHLEAD_RT_CHECKS
+  and src/dsp/RealtimeChecks.cpp, so processBlock() runs inside a
+  ScopedRealtimeSection with the hooks live. Trapping is off: violations
+  are counted and the test fails if any happened while the plugin played
+  notes, controllers, program changes, morphs and audio input at odd block
+  sizes, in single and double precision.
+*/
+
+#include "plugin/BreathLeadProcessor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+        if (!condition)
+            ++failures;
+    }
+
+    juce::uint64 countViolations()
+    {
+        using namespace breath::realtime;
+        juce::uint64 total = 0;
+        for (int i = 0; i < kNumViolations; ++i)
+            total += get_violation_count(Violation(i));
+        return total;
+    }
+
+    void setParameter(BreathLeadProcessor& processor, const juce::String& id, float value)
+    {
+        auto* param = processor.getParameters().getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    template <typename Sample>
+    void testProcessBlock(BreathLeadProcessor& processor, const char* name)
+    {
+        std::printf("processBlock, %s\n", name);
+
+        constexpr int kMaxBlock = 2048;
+        processor.setPlayConfigDetails(2, 2, 48000.0, kMaxBlock);
+        processor.prepareToPlay(48000.0, kMaxBlock);
+
+        // Buffers and MIDI are filled outside the guarded section
+        const int blockSizes[] = { 1, 17, 32, 64, 441, 512, 2048 };
+        juce::AudioBuffer<Sample> buffer(2, kMaxBlock);
+        juce::MidiBuffer midi;
+        midi.ensureSize(4096);
+
+        const auto before = countViolations();
+
+        for (int b = 0; b < 1200; ++b)
+        {
+            const int n = blockSizes[b % std::size(blockSizes)];
+            buffer.setSize(2, n, false, false, true);
+
+            // A quiet input tone for the follower
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < n; ++i)
+                    buffer.setSample(ch, i, Sample(0.1 * std::sin(0.05 * double(b * n + i))));
+
+            midi.clear();
+            if (b % 30 == 0)  midi.addEvent(juce::MidiMessage::noteOn(1, 48 + b % 24, 0.8f), 0);
+            if (b % 30 == 20) midi.addEvent(juce::MidiMessage::noteOff(1, 48 + (b - 20) % 24), n - 1);
+            if (b % 3 == 0)   midi.addEvent(juce::MidiMessage::controllerEvent(1, 2, b % 128), n / 2);
+            if (b % 7 == 0)   midi.addEvent(juce::MidiMessage::pitchWheel(1, 8192 + (b % 64) * 64), 0);
+            if (b % 11 == 0)  midi.addEvent(juce::MidiMessage::controllerEvent(1, 16, b % 128), 0);
+
+            if (b % 50 == 0)  processor.setCurrentProgram(b / 50 % processor.getNumPrograms());
+            if (b % 13 == 0)  setParameter(processor, "engine", float(b % 3));
+            if (b % 17 == 0)  setParameter(processor, "input", float(b / 17 % 3));
+            if (b % 19 == 0)  setParameter(processor, "morphOn", float(b / 19 % 2));
+            if (b % 23 == 0)  setParameter(processor, "mpe", float(b / 23 % 2));
+            if (b == 600)     processor.auditionProgram(0);
+
+            processor.processBlock(buffer, midi);
+        }
+
+        check(countViolations() == before, "no allocation, free or lock in processBlock()");
+        processor.releaseResources();
+    }
+}
+
+int main()
+{
+    const juce::ScopedJuceInitialiser_GUI juce;
+    breath::realtime::set_trapping(false);
+
+    BreathLeadProcessor processor;
+
+    processor.setProcessingPrecision(juce::AudioProcessor::singlePrecision);
+    testProcessBlock<float>(processor, "single precision");
+
+    processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    testProcessBlock<double>(processor, "double precision");
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
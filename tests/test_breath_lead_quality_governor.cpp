@@ -0,0 +1,246 @@
+/*
+  test_breath_lead_quality_governor.cpp - Quality tiers under CPU pressure
+
+  The governor is fed blocks of a chosen load: each block's start time is
+  set that far before endBlock(), so no real work is timed. It must step
+  down under a high load with at least kDwellSeconds between changes,
+  hold between the two thresholds, step up only after kHoldSeconds of low
+  load, react to repeated (not single) missed deadlines, and sit at Full
+  while disabled.
+
+  On the synth side, the settings a tier changes must not click: a new
+  control interval starts at a tick boundary, and a lower voice limit
+  leaves sounding voices alone.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+#include "dsp/QualityGovernor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+constexpr double kRate = 48000.0;
+constexpr int kBlock = 480;                         // 10 ms
+constexpr float kBlockSeconds = float(kBlock / kRate);
+
+// Plays `seconds` of blocks at `load`; returns the audio time (s, from the
+// first of these blocks) of each tier change
+std::vector<float> play(QualityGovernor& governor, float seconds, float load) {
+    std::vector<float> changes;
+    const int64_t blockNanos = int64_t(double(kBlock) / kRate * 1.0e9);
+    for (int b = 0; b < int(seconds / kBlockSeconds); ++b) {
+        const auto before = governor.getTierChangeCount();
+        governor.endBlock(steady_nanos() - int64_t(double(load) * double(blockNanos)), kBlock);
+        if (governor.getTierChangeCount() != before)
+            changes.push_back(float(b + 1) * kBlockSeconds);
+    }
+    return changes;
+}
+
+void testStepDown() {
+    std::printf("Sustained load\n");
+
+    QualityGovernor governor;
+    governor.prepare(kRate);
+    play(governor, 5.f, 0.3f);
+    check(governor.getTier() == QualityTier::Full, "30%: stays at Full");
+
+    const auto changes = play(governor, 3.f, 0.95f);
+    check(governor.getTier() == QualityTier::Minimal && changes.size() == 3,
+          "95%: steps down to Minimal, one tier at a time");
+
+    bool dwelt = true;
+    for (size_t i = 1; i < changes.size(); ++i)
+        dwelt = dwelt && changes[i] - changes[i - 1] >= QualityGovernor::kDwellSeconds - 1e-4f;
+    check(dwelt, "at least kDwellSeconds between changes");
+
+    play(governor, 2.f, 0.95f);
+    check(governor.getTier() == QualityTier::Minimal && governor.getTierChangeCount() == 3,
+          "and no further than Minimal");
+}
+
+void testHysteresis() {
+    std::printf("Hysteresis\n");
+
+    QualityGovernor governor;
+    governor.prepare(kRate);
+    play(governor, 0.5f, 0.95f);
+    const auto tier = governor.getTier();
+    check(tier != QualityTier::Full, "stepped down");
+
+    play(governor, 10.f, 0.6f);
+    check(governor.getTier() == tier, "a load between the thresholds holds the tier");
+
+    // The smoothed load needs a few hundred ms to fall, then kHoldSeconds
+    const auto changes = play(governor, 10.f, 0.2f);
+    check(governor.getTier() == QualityTier::Full, "a low load climbs back to Full");
+    check(!changes.empty() && changes.front() >= QualityGovernor::kHoldSeconds,
+          "only after kHoldSeconds below kUpLoad");
+
+    // A single load spike resets the hold
+    QualityGovernor spiky;
+    spiky.prepare(kRate);
+    play(spiky, 0.5f, 0.95f);
+    play(spiky, 1.f, 0.2f);
+    const auto stepped = spiky.getTier();
+    play(spiky, 0.3f, 0.7f);        // Above kUpLoad, below kDownLoad
+    play(spiky, 1.5f, 0.2f);
+    check(spiky.getTier() == stepped, "a load bump restarts the hold");
+}
+
+void testMisses() {
+    std::printf("Missed deadlines\n");
+
+    auto missAfterQuietStart = [](int misses, float gapSeconds) {
+        QualityGovernor governor;
+        governor.prepare(kRate);
+        play(governor, 1.f, 0.1f);
+        for (int m = 0; m < misses; ++m) {
+            play(governor, kBlockSeconds, 3.f);     // One block at 300%
+            play(governor, gapSeconds, 0.1f);
+        }
+        return governor.getTier();
+    };
+
+    // One block at 300% barely moves the smoothed load; the miss count does
+    check(missAfterQuietStart(1, 0.2f) == QualityTier::Full, "one miss is let go");
+    check(missAfterQuietStart(2, 0.2f) == QualityTier::Reduced, "two within kMissWindowSeconds step down");
+    check(missAfterQuietStart(2, 1.5f) == QualityTier::Full, "two far apart do not");
+}
+
+void testDisabled() {
+    std::printf("Disabled\n");
+
+    QualityGovernor governor;
+    governor.prepare(kRate);
+    play(governor, 2.f, 0.95f);
+    check(governor.getTier() == QualityTier::Minimal, "enabled: stepped down");
+
+    governor.setEnabled(false);
+    play(governor, kBlockSeconds, 0.95f);
+    check(governor.getTier() == QualityTier::Full, "disabling returns to Full at the next block");
+    play(governor, 2.f, 0.95f);
+    check(governor.getTier() == QualityTier::Full, "and stays there under load");
+}
+
+// -----------------------------------------------------------------------------
+// What the tiers change in the synth
+// -----------------------------------------------------------------------------
+struct Synth {
+    DspArena arena;
+    std::unique_ptr<BreathLeadSynth> synth = std::make_unique<BreathLeadSynth>();
+    float left[kBlock], right[kBlock];
+
+    Synth() {
+        arena.reserve(BreathLeadSynth::arenaBytes(kRate));
+        synth->prepare(kRate, arena);
+    }
+
+    void midi(uint8_t status, uint8_t a, uint8_t b) {
+        const uint8_t m[] = { status, a, b };
+        synth->handleMidi(m, 3);
+    }
+
+    // Largest sample-to-sample step over `blocks` blocks
+    float render(int blocks, float& last) {
+        float step = 0.f;
+        for (int b = 0; b < blocks; ++b) {
+            synth->beginBlock();
+            synth->render(left, right, kBlock);
+            for (float x : left) {
+                step = std::max(step, std::abs(x - last));
+                last = x;
+            }
+        }
+        return step;
+    }
+};
+
+void testControlInterval() {
+    std::printf("Control interval\n");
+
+    // A held note under a moving bend and breath, with and without the
+    // interval switching through every tier's value
+    auto perform = [](bool switching) {
+        Synth s;
+        s.midi(0x90, 62, 100);
+        float last = 0.f, step = 0.f;
+        for (int b = 0; b < 100; ++b) {
+            s.midi(0xE0, 0, uint8_t(64 + (b % 20) - 10));
+            s.midi(0xB0, 2, uint8_t(60 + b % 40));
+            if (switching)
+                s.synth->setControlInterval(kQualitySettings[b / 5 % kNumQualityTiers].controlInterval);
+            step = std::max(step, s.render(1, last));
+        }
+        return step;
+    };
+
+    const float steady = perform(false), switching = perform(true);
+    char what[96];
+    std::snprintf(what, sizeof(what), "switching mid-note: largest step %.4f (steady %.4f)", switching, steady);
+    check(switching < steady * 1.25f, what);
+
+    Synth s;
+    s.synth->setControlInterval(kMaxControlInterval);
+    check(s.synth->getControlInterval() == kControlInterval, "a new interval waits for the next tick");
+    float last = 0.f;
+    s.render(1, last);
+    check(s.synth->getControlInterval() == kMaxControlInterval, "and applies there");
+}
+
+void testVoiceLimit() {
+    std::printf("Voice limit\n");
+
+    Synth s;
+    s.synth->setMpeEnabled(true);
+    for (int n = 0; n < 4; ++n)
+        s.midi(uint8_t(0x91 + n), uint8_t(60 + 3 * n), 100);
+    float last = 0.f;
+    s.render(10, last);
+    check(s.synth->getActiveVoiceCount() == 4, "four voices sounding");
+
+    s.synth->setVoiceLimit(2);
+    s.render(10, last);
+    check(s.synth->getActiveVoiceCount() == 4, "lowering the limit cuts none of them");
+
+    s.midi(0x95, 80, 100);
+    s.render(1, last);
+    bool withinLimit = false, othersKept = true;
+    for (int v = 0; v < kMaxVoices; ++v) {
+        const int note = s.synth->getVoiceSlot(v).note;
+        if (note == 80)
+            withinLimit = v < 2;
+        else if (v >= 2 && v < 4)
+            othersKept = othersKept && note == 60 + 3 * v;
+    }
+    check(withinLimit, "a new note takes a voice inside the limit");
+    check(othersKept, "voices above the limit keep their notes");
+}
+
+} // namespace
+
+int main() {
+    testStepDown();
+    testHysteresis();
+    testMisses();
+    testDisabled();
+    testControlInterval();
+    testVoiceLimit();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
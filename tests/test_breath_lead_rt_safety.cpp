@@ -0,0 +1,143 @@
+/*
+  test_breath_lead_rt_safety.cpp - No allocation, free or lock while rendering
+
+  Built with BREATHLEAD_RT_CHECKS and src/dsp/RealtimeChecks.cpp, so every
+  process() call runs inside a ScopedRealtimeSection with the hooks live.
+  Trapping is off: violations are counted, and the test fails if any
+  happened while BreathLeadDSP rendered notes, MPE, breath controllers,
+  engine switches, preset loads and odd block sizes, in both latency
+  modes.
+*/
+
+#include "dsp/BreathLeadDSP.h"
+
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+using namespace breath;
+using DSP::ScheduledEvent;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+struct Counts {
+    uint64_t values[realtime::kNumViolations] = {};
+
+    static Counts now() {
+        Counts c;
+        for (int i = 0; i < realtime::kNumViolations; ++i)
+            c.values[i] = realtime::get_violation_count(realtime::Violation(i));
+        return c;
+    }
+
+    bool same(const Counts& other) const {
+        for (int i = 0; i < realtime::kNumViolations; ++i)
+            if (values[i] != other.values[i])
+                return false;
+        return true;
+    }
+
+    void printSince(const Counts& before) const {
+        for (int i = 0; i < realtime::kNumViolations; ++i)
+            if (values[i] != before.values[i])
+                std::printf("    %s: %llu\n", realtime::violation_name(realtime::Violation(i)),
+                            (unsigned long long)(values[i] - before.values[i]));
+    }
+};
+
+// The hooks must see an allocation made inside a section, or the test
+// below proves nothing
+void testHooksAreLinked() {
+    std::printf("Hooks linked\n");
+
+    const Counts before = Counts::now();
+    {
+        const ScopedRealtimeSection section;
+        auto* volatile p = new int(1);
+        delete p;
+    }
+    const Counts after = Counts::now();
+    check(after.values[int(realtime::Violation::Allocation)] == before.values[int(realtime::Violation::Allocation)] + 1,
+          "allocation in a section is counted");
+    check(after.values[int(realtime::Violation::Deallocation)] == before.values[int(realtime::Violation::Deallocation)] + 1,
+          "free in a section is counted");
+}
+
+void event(BreathLeadDSP& dsp, ScheduledEvent::Type type, int note, float value, int channel, int offset, int cc = 0) {
+    ScheduledEvent e;
+    e.type = type;
+    e.noteNumber = note;
+    e.velocity = value;
+    e.value = value;
+    e.channel = channel;
+    e.sampleOffset = offset;
+    e.controllerNumber = cc;
+    dsp.handleEvent(e);
+}
+
+void testRender(BlockLatency latency, const char* name) {
+    std::printf("Render, %s latency\n", name);
+
+    constexpr int kMaxBlock = 4096;
+    BreathLeadDSP dsp;
+    dsp.setBlockLatency(latency);
+    dsp.setBreathSources(BreathControllerInput::kBreath | BreathControllerInput::kExpression
+                         | BreathControllerInput::kModWheel);
+    check(dsp.prepare(48000.0, kMaxBlock), "prepare");
+
+    std::vector<float> left(kMaxBlock), right(kMaxBlock);
+    float* outputs[2] = { left.data(), right.data() };
+    std::vector<char> json(4096);
+
+    const int blockSizes[] = { 1, 7, 17, 32, 33, 64, 256, 480, 512, 1024, 4096 };
+    const Counts before = Counts::now();
+
+    for (int b = 0; b < 3000; ++b) {
+        const int n = blockSizes[b % std::size(blockSizes)];
+
+        if (b % 40 == 0)  event(dsp, ScheduledEvent::NoteOn, 48 + b % 24, 0.8f, 1 + b % 3, b % 600);
+        if (b % 40 == 25) event(dsp, ScheduledEvent::NoteOff, 48 + (b - 25) % 24, 0.f, 1 + (b - 25) % 3, 5);
+        if (b % 3 == 0)   event(dsp, ScheduledEvent::CC, 0, float(b % 128) / 127.f, 0, b % n, 2);
+        if (b % 9 == 0)   event(dsp, ScheduledEvent::CC, 0, 0.4f, 0, 0, 11);
+        if (b % 5 == 0)   event(dsp, ScheduledEvent::PitchBend, 0, float(b % 40 - 20) / 20.f, 1 + b % 3, 3);
+        if (b % 11 == 0)  event(dsp, ScheduledEvent::CC, 0, 0.5f, 1 + b % 3, 0, 74);
+
+        if (b % 13 == 0)  dsp.setParameter("engine", float(b % 3));
+        if (b % 17 == 0)  dsp.setParameter("mpe", float((b / 17) % 2));
+        if (b % 19 == 0)  dsp.setParameter("room", float(b % 10) / 10.f);
+        if (b % 23 == 0)  dsp.setParameter("release", 10.f + float(b % 3000));
+        if (b % 97 == 0) {
+            dsp.savePreset(json.data(), int(json.size()));
+            dsp.setParameter("tone", 0.1f);
+            dsp.loadPreset(json.data());
+        }
+        if (b == 1500) dsp.panic();
+
+        dsp.process(outputs, 2, n);
+    }
+
+    const Counts after = Counts::now();
+    after.printSince(before);
+    check(after.same(before), "no allocation, free or lock in process()");
+}
+
+} // namespace
+
+int main() {
+    realtime::set_trapping(false);
+
+    testHooksAreLinked();
+    testRender(BlockLatency::Zero, "zero");
+    testRender(BlockLatency::Buffered, "buffered");
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
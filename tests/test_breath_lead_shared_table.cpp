@@ -0,0 +1,202 @@
+/*
+  test_breath_lead_shared_table.cpp - Process-wide read-only tables
+
+  SharedTable<T> hands every caller of one (sample rate, size) the same
+  table and builds it once, also when threads race for the first copy; a
+  table lives exactly as long as its holders. PureDSP::FFT takes its
+  twiddles from a shared FFTTables: FFTs of one size hold a single copy
+  and still transform correctly, and pitch followers share it too.
+*/
+
+#include "dsp/AudioBreathFollower.h"
+#include "dsp/PureDSPFFT.h"
+#include "dsp/SharedTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <memory>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+using breath::SharedTable;
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+        if (!condition)
+            ++failures;
+    }
+
+    // A table that counts its constructions and destructions
+    struct Counted
+    {
+        static inline std::atomic<int> built { 0 };
+        static inline std::atomic<int> destroyed { 0 };
+
+        Counted(double rate, int n) : sampleRate(rate), size(n), values(size_t(n), float(rate))
+        {
+            built.fetch_add(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));  // Widen the race
+        }
+
+        ~Counted() { destroyed.fetch_add(1); }
+
+        double sampleRate;
+        int size;
+        std::vector<float> values;
+    };
+
+    void testKeys()
+    {
+        std::printf("Keys and lifetime\n");
+
+        auto a = SharedTable<Counted>::get(48000.0, 256);
+        auto b = SharedTable<Counted>::get(48000.0, 256);
+        auto c = SharedTable<Counted>::get(96000.0, 256);
+        auto d = SharedTable<Counted>::get(48000.0, 512);
+
+        check(a == b && Counted::built == 3, "one key, one table, built once");
+        check(a != c && a != d && c->sampleRate == 96000.0 && d->size == 512,
+              "the sample rate and the size each make a new key");
+        check(SharedTable<Counted>::getNumLive() == 3, "three live tables");
+
+        a.reset();
+        check(Counted::destroyed == 0, "a table outlives one of its holders");
+        b.reset();
+        check(Counted::destroyed == 1 && SharedTable<Counted>::getNumLive() == 2, "and goes with the last");
+
+        auto again = SharedTable<Counted>::get(48000.0, 256);
+        check(Counted::built == 4 && SharedTable<Counted>::getNumLive() == 3, "a later get() builds it again");
+
+        again.reset();
+        c.reset();
+        d.reset();
+        check(SharedTable<Counted>::getNumLive() == 0 && Counted::destroyed == Counted::built,
+              "nothing is kept once every holder is gone");
+    }
+
+    void testRace()
+    {
+        std::printf("Concurrent first calls\n");
+
+        constexpr int kThreads = 8;
+        const int builtBefore = Counted::built;
+
+        std::atomic<int> ready { 0 };
+        std::vector<std::shared_ptr<const Counted>> tables(kThreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                ready.fetch_add(1);
+                while (ready.load() < kThreads)
+                    std::this_thread::yield();
+                tables[size_t(t)] = SharedTable<Counted>::get(44100.0, 1024);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        bool same = true;
+        for (const auto& table : tables)
+            same = same && table == tables[0];
+        check(Counted::built - builtBefore == 1, "built once");
+        check(same, "every thread holds that one table");
+    }
+
+    // Naive DFT bin k of x
+    std::complex<double> dft(const std::vector<float>& x, int k)
+    {
+        std::complex<double> sum;
+        const double n = double(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            sum += double(x[i]) * std::polar(1.0, -2.0 * std::numbers::pi * double(k) * double(i) / n);
+        return sum;
+    }
+
+    void testFFT()
+    {
+        std::printf("PureDSP::FFT\n");
+
+        const int liveBefore = SharedTable<PureDSP::FFTTables>::getNumLive();
+        {
+            std::vector<std::unique_ptr<PureDSP::FFT>> ffts;
+            for (int i = 0; i < 10; ++i)
+                ffts.push_back(std::make_unique<PureDSP::FFT>(1024));
+            PureDSP::FFT other(256);
+
+            check(SharedTable<PureDSP::FFTTables>::getNumLive() == liveBefore + 2,
+                  "ten 1024-point FFTs and a 256-point one hold two tables");
+
+            // Every instance transforms correctly from the shared tables
+            std::vector<float> x(1024);
+            for (size_t i = 0; i < x.size(); ++i)
+                x[i] = float(std::sin(0.3 * double(i)) + 0.25 * std::cos(1.7 * double(i)) + (i % 7 == 0 ? 0.5 : 0.0));
+
+            std::vector<PureDSP::FFT::Complex> spectrum(1024);
+            std::vector<float> back(1024);
+            double worstBin = 0.0, worstSample = 0.0;
+            for (auto& fft : ffts)
+            {
+                fft->forward(x.data(), spectrum.data());
+                for (const int k : { 0, 1, 49, 277, 512 })
+                    worstBin = std::max(worstBin, std::abs(std::complex<double>(spectrum[size_t(k)]) - dft(x, k)));
+
+                fft->inverse(spectrum.data(), back.data());
+                for (size_t i = 0; i < x.size(); ++i)
+                    worstSample = std::max(worstSample, double(std::abs(back[i] - x[i])));
+            }
+
+            char what[96];
+            std::snprintf(what, sizeof(what), "forward matches a DFT (worst bin error %.1e)", worstBin);
+            check(worstBin < 1e-2, what);
+            std::snprintf(what, sizeof(what), "inverse gives the input back (worst %.1e)", worstSample);
+            check(worstSample < 1e-4, what);
+        }
+        check(SharedTable<PureDSP::FFTTables>::getNumLive() == liveBefore, "freed with the last FFT");
+    }
+
+    void testFollowers()
+    {
+        std::printf("Pitch followers\n");
+
+        constexpr double kRate = 96000.0;
+        constexpr int kFollowers = 16;
+        const int liveBefore = SharedTable<PureDSP::FFTTables>::getNumLive();
+
+        std::vector<breath::DspArena> arenas(kFollowers);
+        std::vector<std::unique_ptr<breath::AudioBreathFollower>> followers;
+        for (auto& arena : arenas)
+        {
+            arena.reserve(breath::AudioBreathFollower::arenaBytes(kRate));
+            followers.push_back(std::make_unique<breath::AudioBreathFollower>());
+            followers.back()->prepare(kRate, arena);
+        }
+
+        check(SharedTable<PureDSP::FFTTables>::getNumLive() == liveBefore + 1,
+              "16 followers at 96 kHz share one table");
+
+        followers.clear();
+        check(SharedTable<PureDSP::FFTTables>::getNumLive() == liveBefore, "it goes with the last follower");
+    }
+}
+
+int main()
+{
+    testKeys();
+    testRace();
+    testFFT();
+    testFollowers();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
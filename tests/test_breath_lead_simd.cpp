@@ -0,0 +1,149 @@
+/*
+  test_breath_lead_simd.cpp - Every SIMD variant gives the scalar result
+
+  Each ISA this machine supports is bound with force_isa() in turn and its
+  kernels are run next to the scalar ones on the same input: noise fill,
+  filter bank, saturation and FFT butterflies must all be bit-identical,
+  including the scalar tails of odd lengths. The rational tanh they share
+  is also checked against std::tanh.
+*/
+
+#include "dsp/SimdDispatch.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+bool identical(const float* a, const float* b, int n) {
+    return std::memcmp(a, b, size_t(n) * sizeof(float)) == 0;
+}
+
+// Deterministic test input in [-scale, scale]
+void fill(std::vector<float>& v, uint64_t seed, float scale) {
+    for (auto& x : v)
+        x = simd::lcg_white(seed) * scale;
+}
+
+void testTanh() {
+    std::printf("Rational tanh\n");
+
+    double maxError = 0.0;
+    bool odd = true;
+    for (int i = -100000; i <= 100000; ++i) {
+        const float x = float(i) * 1e-4f;
+        maxError = std::max(maxError, std::abs(double(tanh_rational(x)) - std::tanh(double(x))));
+        odd = odd && tanh_rational(-x) == -tanh_rational(x);
+    }
+
+    char what[96];
+    std::snprintf(what, sizeof(what), "within 4e-7 of std::tanh on [-10, 10] (max %.2g)", maxError);
+    check(maxError < 4e-7, what);
+    check(odd, "odd symmetric");
+    check(std::abs(tanh_rational(1e6f)) <= 1.f, "bounded past the clamp");
+}
+
+void testKernels(simd::Isa isa) {
+    const auto& scalar = simd::kScalarKernels;
+    const auto& wide = simd::kernels();
+    char what[96];
+
+    // Noise: odd lengths run the scalar tail after the lanes
+    bool noiseSame = true;
+    for (int n : { 1, 3, 8, 17, 64, 255, 1024 }) {
+        uint64_t seedA = 0x1234u + uint64_t(n), seedB = seedA;
+        std::vector<float> a(n), b(n);
+        scalar.noiseFill(seedA, a.data(), n);
+        wide.noiseFill(seedB, b.data(), n);
+        noiseSame = noiseSame && seedA == seedB && identical(a.data(), b.data(), n);
+    }
+    std::snprintf(what, sizeof(what), "%s noise fill", simd::isa_name(isa));
+    check(noiseSame, what);
+
+    // Filter bank, state carried over many calls
+    bool bankSame = true;
+    {
+        std::vector<float> coef(8), gain(8), input(8 * 2000);
+        fill(coef, 1, 0.5f);
+        fill(gain, 2, 0.9f);
+        fill(input, 3, 1.f);
+        for (auto& c : coef) c = 0.5f + c;
+        float stateA[8] = {}, stateB[8] = {};
+        for (int t = 0; t < 2000 && bankSame; ++t) {
+            float a[8], b[8];
+            std::memcpy(a, input.data() + 8 * t, sizeof(a));
+            std::memcpy(b, a, sizeof(b));
+            scalar.filterBank8(a, stateA, coef.data(), gain.data());
+            wide.filterBank8(b, stateB, coef.data(), gain.data());
+            bankSame = identical(a, b, 8) && identical(stateA, stateB, 8);
+        }
+    }
+    std::snprintf(what, sizeof(what), "%s filter bank", simd::isa_name(isa));
+    check(bankSame, what);
+
+    // Saturation over the knee, the clamp and the tails
+    bool saturateSame = true;
+    for (int n : { 1, 5, 16, 31, 100, 4096 }) {
+        std::vector<float> a(n);
+        fill(a, 4 + uint64_t(n), 6.f);
+        std::vector<float> b = a;
+        scalar.saturate(a.data(), n);
+        wide.saturate(b.data(), n);
+        saturateSame = saturateSame && identical(a.data(), b.data(), n);
+    }
+    std::snprintf(what, sizeof(what), "%s saturation", simd::isa_name(isa));
+    check(saturateSame, what);
+
+    // FFT: every stage of a 1024-point transform
+    bool fftSame = true;
+    {
+        constexpr int kSize = 1024;
+        std::vector<float> a(2 * kSize), twiddles(kSize);
+        fill(a, 5, 1.f);
+        std::vector<float> b = a;
+        for (int half = 1; half < kSize; half *= 2) {
+            for (int j = 0; j < half; ++j) {
+                const double angle = -3.14159265358979323846 * double(j) / double(half);
+                twiddles[2 * j] = float(std::cos(angle));
+                twiddles[2 * j + 1] = float(std::sin(angle));
+            }
+            scalar.fftButterflies(a.data(), twiddles.data(), kSize, half);
+            wide.fftButterflies(b.data(), twiddles.data(), kSize, half);
+        }
+        fftSame = identical(a.data(), b.data(), 2 * kSize);
+    }
+    std::snprintf(what, sizeof(what), "%s FFT butterflies", simd::isa_name(isa));
+    check(fftSame, what);
+}
+
+} // namespace
+
+int main() {
+    testTanh();
+
+    const simd::Isa detected = simd::detect_isa();
+    std::printf("Kernels against scalar (detected: %s)\n", simd::isa_name(detected));
+
+    for (int i = 1; i <= int(simd::Isa::Avx512); ++i) {
+        const auto isa = simd::Isa(i);
+        if (!simd::is_supported(isa) || simd::force_isa(isa) != isa)
+            continue;
+        testKernels(isa);
+    }
+    simd::force_isa(detected);
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
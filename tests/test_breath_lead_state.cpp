@@ -0,0 +1,183 @@
+/*
+  test_breath_lead_state.cpp - Plugin state and preset values are validated
+
+  PluginState round-trips bit-exactly, skips records from newer writers and
+  rejects damaged data. Values that are NaN, infinite or out of range,
+  whether in a state with a valid checksum or in a preset, never come out
+  of decode() or sanitise().
+*/
+
+#include "dsp/PresetSnapshot.h"
+#include "plugin/PluginState.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+PluginState makeState() {
+    PluginState s;
+    s.air = 0.25f;
+    s.tone = 0.8f;
+    s.vibrato = 0.1f;
+    s.engine = 2;
+    s.program = 17;
+    s.inputMode = 1;
+    s.morphOn = 1;
+    s.morphA = 3;
+    s.morphB = 120;
+    s.attack = 12.5f;
+    s.release = 2900.f;
+    s.releaseCurve = -0.4f;
+    s.mpe = 1;
+    s.breathSources = 2;
+    return s;
+}
+
+bool equal(const PluginState& a, const PluginState& b) {
+    return std::memcmp(&a, &b, sizeof(PluginState)) == 0;
+}
+
+// Rewrites the value of `tag` in an encoded state and fixes up the CRC,
+// so only value validation stands between it and the decoded state
+void patch(std::vector<uint8_t>& data, uint16_t tag, uint32_t bits) {
+    for (size_t p = state::kHeaderSize; p + 8 <= data.size(); p += 4 + state::get_u16(&data[p + 2])) {
+        if (state::get_u16(&data[p]) == tag)
+            state::put_u32(&data[p + 4], bits);
+    }
+    const uint32_t payloadSize = state::get_u32(&data[8]);
+    state::put_u32(&data[12], state::crc32(&data[state::kHeaderSize], payloadSize));
+}
+
+std::vector<uint8_t> encoded(const PluginState& s) {
+    std::vector<uint8_t> data(state::kMaxEncodedSize);
+    data.resize(state::encode(s, data.data(), data.size()));
+    return data;
+}
+
+void testRoundTrip() {
+    std::printf("Round trip\n");
+
+    const PluginState original = makeState();
+    const auto data = encoded(original);
+    check(data.size() == state::kMaxEncodedSize, "encodes every field");
+
+    PluginState decoded;
+    check(state::decode(data.data(), data.size(), decoded) && equal(decoded, original), "decodes bit-exactly");
+
+    uint8_t small[16];
+    check(state::encode(original, small, sizeof(small)) == 0, "refuses a short buffer");
+}
+
+void testDamage() {
+    std::printf("Damaged data\n");
+
+    const auto data = encoded(makeState());
+    PluginState s;
+
+    auto flipped = data;
+    flipped[state::kHeaderSize + 5] ^= 0x10;
+    check(!state::decode(flipped.data(), flipped.size(), s), "checksum mismatch rejected");
+
+    check(!state::decode(data.data(), data.size() - 3, s), "truncated state rejected");
+
+    auto future = data;
+    state::put_u16(&future[6], state::kVersion + 1);
+    check(!state::decode(future.data(), future.size(), s), "newer minimum reader version rejected");
+
+    // A newer writer's record in the middle of the payload is skipped
+    std::vector<uint8_t> extended(data.begin(), data.begin() + state::kHeaderSize);
+    const uint8_t unknown[] = { 0xFF, 0x7F, 6, 0, 1, 2, 3, 4, 5, 6 };
+    extended.insert(extended.end(), std::begin(unknown), std::end(unknown));
+    extended.insert(extended.end(), data.begin() + state::kHeaderSize, data.end());
+    const uint32_t payloadSize = uint32_t(extended.size() - state::kHeaderSize);
+    state::put_u32(&extended[8], payloadSize);
+    state::put_u32(&extended[12], state::crc32(&extended[state::kHeaderSize], payloadSize));
+
+    PluginState decoded;
+    check(state::decode(extended.data(), extended.size(), decoded) && equal(decoded, makeState()),
+          "unknown tags skipped");
+}
+
+void testValidation() {
+    std::printf("Decoded values are validated\n");
+
+    const PluginState original = makeState();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // Non-finite floats leave the field as it was
+    auto data = encoded(original);
+    patch(data, state::kTagAir, state::float_bits(nan));
+    patch(data, state::kTagRelease, state::float_bits(-inf));
+    patch(data, state::kTagSwellCurve, state::float_bits(inf));
+    PluginState s;
+    const PluginState before = s;
+    check(state::decode(data.data(), data.size(), s), "state with bad values still decodes");
+    check(s.air == before.air && s.release == before.release && s.swellCurve == before.swellCurve,
+          "NaN and infinities dropped");
+    check(s.tone == original.tone, "valid fields next to them kept");
+
+    // Out-of-range numbers are clamped to the parameter ranges
+    data = encoded(original);
+    patch(data, state::kTagTone, state::float_bits(7.f));
+    patch(data, state::kTagAttack, state::float_bits(0.f));
+    patch(data, state::kTagSustain, state::float_bits(40.f));
+    patch(data, state::kTagReleaseCurve, state::float_bits(-3.f));
+    patch(data, state::kTagEngine, 9);
+    patch(data, state::kTagProgram, uint32_t(-5));
+    patch(data, state::kTagMorphA, 0);
+    patch(data, state::kTagMorphC, 500);
+    patch(data, state::kTagMpe, 42);
+    patch(data, state::kTagBreathSources, 7);
+    check(state::decode(data.data(), data.size(), s), "state with out-of-range values decodes");
+    check(s.tone == 1.f && s.attack == 1.f && s.sustain == 1.5f && s.releaseCurve == -1.f, "floats clamped");
+    check(s.engine == 2 && s.program == 0 && s.morphA == 1 && s.morphC == 128 && s.mpe == 1
+              && s.breathSources == 2,
+          "integers clamped");
+}
+
+void testPresetSnapshot() {
+    std::printf("Preset values are sanitised\n");
+
+    PresetSnapshot clean;
+    clean.air = 0.9f;
+    clean.engine = 1;
+    PresetSnapshot copy = clean;
+    check(sanitise(copy) && std::memcmp(&copy, &clean, sizeof(clean)) == 0, "valid preset untouched");
+
+    PresetSnapshot bad;
+    bad.air = std::numeric_limits<float>::quiet_NaN();
+    bad.tone = 3.f;
+    bad.masterGain = -std::numeric_limits<float>::infinity();
+    bad.engine = -4;
+    check(!sanitise(bad), "invalid preset reported");
+    check(bad.air == PresetSnapshot {}.air && bad.tone == 1.f && bad.masterGain == PresetSnapshot {}.masterGain
+              && bad.engine == 0,
+          "NaN and infinities take defaults, the rest is clamped");
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testDamage();
+    testValidation();
+    testPresetSnapshot();
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
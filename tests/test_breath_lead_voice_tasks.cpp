@@ -0,0 +1,189 @@
+/*
+  test_breath_lead_voice_tasks.cpp - Voices rendered on a thread pool
+
+  A small spinning pool stands in for a host's: run() hands the tasks to
+  its workers and waits until every one has finished. An MPE chord
+  rendered through it must come out bit-identical to the serial render,
+  with the tasks really spread over the workers. A runner that declines
+  falls back to serial, and a lone voice never reaches the runner.
+*/
+
+#include "dsp/BreathLeadSynth.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace breath;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr int kBlockSize = 480;
+constexpr int kBlocks = 200;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("  %s %s\n", condition ? "PASS" : "FAIL", what);
+    if (!condition)
+        ++failures;
+}
+
+// Workers spin on a generation counter and claim task indices from a
+// shared counter. run() returns once every worker is done with the
+// generation, so none still reads the last run's task when the next one
+// is set up.
+class SpinPool : public VoiceTaskRunner {
+public:
+    explicit SpinPool(int workers) {
+        finished_ = std::make_unique<std::atomic<uint64_t>[]>(size_t(workers));
+        for (int w = 0; w < workers; ++w) {
+            finished_[size_t(w)].store(0);
+            threads_.emplace_back([this, w] { work(w); });
+        }
+    }
+
+    ~SpinPool() override {
+        quit_.store(true, std::memory_order_release);
+        for (auto& t : threads_)
+            t.join();
+    }
+
+    bool run(Task task, void* context, int count) noexcept override {
+        tasks += count;
+        task_ = task;
+        context_ = context;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        const uint64_t generation = generation_.fetch_add(1, std::memory_order_release) + 1;
+
+        for (size_t w = 0; w < threads_.size(); ++w)
+            while (finished_[w].load(std::memory_order_acquire) != generation)
+                std::this_thread::yield();
+        ++runs;
+        return true;
+    }
+
+    int runs = 0;
+    int tasks = 0;                          // Handed over, all runs
+    std::atomic<int> tasksOn[8] = {};       // Tasks run per worker
+
+private:
+    void work(int w) {
+        uint64_t seen = 0;
+        while (!quit_.load(std::memory_order_acquire)) {
+            const uint64_t generation = generation_.load(std::memory_order_acquire);
+            if (generation == seen) {
+                std::this_thread::yield();
+                continue;
+            }
+            seen = generation;
+            drain(w);
+            finished_[size_t(w)].store(generation, std::memory_order_release);
+        }
+    }
+
+    void drain(int id) noexcept {
+        for (int i; (i = next_.fetch_add(1, std::memory_order_acq_rel)) < count_;) {
+            task_(context_, i);
+            tasksOn[id].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::atomic<uint64_t> generation_ { 0 };
+    std::unique_ptr<std::atomic<uint64_t>[]> finished_;  // Last generation per worker
+    std::atomic<int> next_ { 0 };
+    std::atomic<bool> quit_ { false };
+    Task task_ = nullptr;
+    void* context_ = nullptr;
+    int count_ = 0;
+};
+
+class Decliner : public VoiceTaskRunner {
+public:
+    bool run(Task, void*, int) noexcept override {
+        ++calls;
+        return false;
+    }
+
+    int calls = 0;
+};
+
+// Renders the same MPE performance (notes, bends, pressure) and returns
+// the left channel
+std::vector<float> perform(VoiceTaskRunner* runner, int numNotes) {
+    DspArena arena;
+    arena.reserve(BreathLeadSynth::arenaBytes(kRate));
+    auto synth = std::make_unique<BreathLeadSynth>();
+    synth->prepare(kRate, arena);
+    synth->setMpeEnabled(true);
+    synth->setTaskRunner(runner);
+
+    std::vector<float> out(size_t(kBlocks) * kBlockSize);
+    float right[kBlockSize];
+    for (int b = 0; b < kBlocks; ++b) {
+        if (b == 0) {
+            for (int n = 0; n < numNotes; ++n) {
+                const uint8_t on[] = { uint8_t(0x91 + n), uint8_t(55 + 4 * n), uint8_t(70 + 6 * n) };
+                synth->handleMidi(on, 3);
+            }
+        }
+        if (b % 20 == 10) {
+            const uint8_t bend[] = { 0xE2, 0, uint8_t(64 + b / 20) };
+            const uint8_t pressure[] = { 0xD1, uint8_t(40 + b / 4) };
+            synth->handleMidi(bend, 3);
+            synth->handleMidi(pressure, 2);
+        }
+        if (b == kBlocks / 2) {
+            const uint8_t off[] = { 0x81, 55, 0 };
+            synth->handleMidi(off, 3);
+        }
+        synth->beginBlock();
+        synth->render(out.data() + size_t(b) * kBlockSize, right, kBlockSize);
+    }
+    return out;
+}
+
+bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+} // namespace
+
+int main() {
+    const auto serial = perform(nullptr, 6);
+
+    std::printf("Spinning pool, 3 workers\n");
+    {
+        SpinPool pool(3);
+        const auto pooled = perform(&pool, 6);
+        check(pool.runs > 0, "the synth hands its voices to the pool");
+        check(identical(pooled, serial), "bit-identical to the serial render");
+
+        std::printf("  tasks per worker: %d %d %d\n", pool.tasksOn[0].load(), pool.tasksOn[1].load(),
+                    pool.tasksOn[2].load());
+        check(pool.tasksOn[0] + pool.tasksOn[1] + pool.tasksOn[2] == pool.tasks,
+              "every voice task ran on a worker");
+    }
+
+    std::printf("Runner that declines\n");
+    {
+        Decliner decliner;
+        check(identical(perform(&decliner, 6), serial) && decliner.calls > 0, "falls back to the serial render");
+    }
+
+    std::printf("One voice\n");
+    {
+        Decliner counter;
+        perform(&counter, 1);
+        check(counter.calls == 0, "a lone voice renders without the runner");
+    }
+
+    std::printf("%s (%d failed)\n", failures == 0 ? "All tests passed" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}